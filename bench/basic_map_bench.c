@@ -0,0 +1,152 @@
+// Microbenchmark: basic_hash_map.h against the linear scan map it replaced.
+//
+//  Build:  cmake --build . --target basic_map_bench
+//      or  cc -O2 -Isrc bench/basic_map_bench.c -o basic_map_bench
+//  Run:    ./basic_map_bench [max entries] [lookups per size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "basic_hash_map.h"
+
+// ------------------------------------------   OLD LINEAR MAP
+// The map from before the open addressing rewrite, kept for comparison.
+
+typedef struct _linear_key
+{
+    uint32_t id;
+    void *obj_ptr;
+} linear_key_t;
+
+typedef struct _linear_map
+{
+    linear_key_t *map;
+    size_t tracked_elements;
+    size_t max_elements;
+    uint32_t __last_id;
+} linear_map_t;
+
+static linear_map_t *create_linear_map(size_t max_elems)
+{
+    linear_map_t *_new_map = (linear_map_t *)calloc(1, sizeof(linear_map_t));
+    _new_map->map = (linear_key_t *)calloc(max_elems, sizeof(linear_key_t));
+    _new_map->max_elements = max_elems;
+    return _new_map;
+}
+
+static void free_linear_map(linear_map_t *map)
+{
+    free(map->map);
+    free(map);
+}
+
+static linear_key_t *put_linear_map(linear_map_t *map, void *objPtr)
+{
+    if(map->tracked_elements == map->max_elements) return NULL;
+
+    linear_key_t *key = &map->map[map->tracked_elements++];
+    key->obj_ptr = objPtr;
+    key->id = map->__last_id++;
+    return key;
+}
+
+static linear_key_t *get_by_id_linear_map(linear_map_t *map, uint32_t id)
+{
+    for(size_t i = 0; i < map->tracked_elements; i++)
+    {
+        if(map->map[i].id == id)
+            return &map->map[i];
+    }
+
+    return NULL;
+}
+
+// ------------------------------------------   END OLD LINEAR MAP
+
+static double _now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint32_t _rng_state = 0x12345678;
+static inline uint32_t _rng()
+{
+    _rng_state ^= _rng_state << 13;
+    _rng_state ^= _rng_state >> 17;
+    _rng_state ^= _rng_state << 5;
+    return _rng_state;
+}
+
+// Keeps lookups from being optimized away.
+static volatile uintptr_t _sink;
+
+static void bench_size(size_t count, size_t lookups)
+{
+    uint32_t *queries = (uint32_t *)malloc(sizeof(uint32_t) * lookups);
+    for(size_t i = 0; i < lookups; i++)
+        queries[i] = _rng() % count;
+
+    // Linear map.
+    linear_map_t *linear = create_linear_map(count);
+    double start = _now_ns();
+    for(size_t i = 0; i < count; i++)
+        put_linear_map(linear, (void *)(uintptr_t)(i + 1));
+    double linear_insert = (_now_ns() - start) / count;
+
+    start = _now_ns();
+    for(size_t i = 0; i < lookups; i++)
+        _sink += (uintptr_t)get_by_id_linear_map(linear, queries[i])->obj_ptr;
+    double linear_lookup = (_now_ns() - start) / lookups;
+    free_linear_map(linear);
+
+    // Hash map, starting small so growth is part of the insert cost.
+    bm_map_t *hashed = create_basic_map(16);
+    start = _now_ns();
+    for(size_t i = 0; i < count; i++)
+        put_basic_map(hashed, (void *)(uintptr_t)(i + 1));
+    double hashed_insert = (_now_ns() - start) / count;
+
+    start = _now_ns();
+    for(size_t i = 0; i < lookups; i++)
+        _sink += (uintptr_t)get_by_id_basic_map(hashed, queries[i])->obj_ptr;
+    double hashed_lookup = (_now_ns() - start) / lookups;
+
+    // Misses walk the whole linear map, so only the hash map is timed here.
+    start = _now_ns();
+    for(size_t i = 0; i < lookups; i++)
+        _sink += (uintptr_t)get_by_id_basic_map(hashed, (bm_id_t)count + queries[i]);
+    double hashed_miss = (_now_ns() - start) / lookups;
+
+    start = _now_ns();
+    for(size_t i = 0; i < count; i++)
+        remove_basic_map(hashed, i);
+    double hashed_remove = (_now_ns() - start) / count;
+    free_basic_map(hashed);
+
+    printf("%8zu | %10.1f %10.1f | %10.1f %10.1f %10.1f %10.1f | %7.1fx\n",
+        count,
+        linear_insert, linear_lookup,
+        hashed_insert, hashed_lookup, hashed_miss, hashed_remove,
+        linear_lookup / hashed_lookup);
+
+    free(queries);
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_count = argc > 1 ? strtoul(argv[1], NULL, 10) : 65536;
+    size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 200000;
+
+    printf("ns per operation\n");
+    printf("%8s | %10s %10s | %10s %10s %10s %10s | %8s\n",
+        "entries", "lin put", "lin get", "hash put", "hash get", "hash miss", "hash del", "speedup");
+
+    for(size_t count = 16; count <= max_count; count *= 4)
+        bench_size(count, lookups);
+
+    return 0;
+}
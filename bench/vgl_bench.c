@@ -0,0 +1,468 @@
+// Microbenchmarks: the renderer's per sprite hot paths, on the null GL backend.
+//
+//  Build:  cmake --build . --target vgl_bench
+//  Run:    ./vgl_bench [-n 1000,10000,100000] [-r reps] [-o results.json]
+//                      [-b baseline.json] [-t threshold %]
+//
+// Every benchmark runs at each scale in -n and reports the median of -r runs,
+// in ns per operation (a sprite, a map operation, a texel). Results are written
+// as JSON, to stdout unless -o is given. Keep one as a baseline; with -b, each
+// result is compared against it and any slower by more than -t percent
+// (default 10) is reported, and the exit code is 1.
+//
+// Sorting is turned on (Vita_SetSorting), so `sort` is measured and
+// `batch` sees its calls sorted by texture. Frames hold at most
+// MAX_VERTICES sprites, so larger scales are drawn over several frames.
+// Before any of it, every Vita_Draw* function is checked to drop the calls
+// past MAX_VERTICES in a frame, rather than write past the buffers.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "vgl_renderer.h"
+#include "vgl_texture_loader.h"
+#include "vgl_ex_data.h"
+#include "vgl_cull.h"
+#include "vgl_texture_compress.h"
+#include "basic_hash_map.h"
+
+#define MAX_SCALES 8
+#define MAX_REPS 64
+#define MAX_RESULTS 128
+
+// Distinct textures sprites are drawn with, so batching has work to do.
+#define TEXTURES 16
+
+typedef struct _bench_result
+{
+    char name[32];
+    size_t n;
+    double ns;
+} bench_result_t;
+
+static bench_result_t _results[MAX_RESULTS];
+static int _resultCount = 0;
+
+static int _reps = 5;
+
+// Keeps results from being optimized away.
+static volatile uintptr_t _sink;
+
+static uint32_t _rng_state = 0x12345678;
+static inline uint32_t _rng()
+{
+    _rng_state ^= _rng_state << 13;
+    _rng_state ^= _rng_state >> 17;
+    _rng_state ^= _rng_state << 5;
+    return _rng_state;
+}
+
+static inline float _rngf(float lo, float hi)
+{
+    return lo + (hi - lo) * ((_rng() & 0xFFFFFF) / (float)0xFFFFFF);
+}
+
+static void _quiet(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+static int _compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double _median(double *samples, int count)
+{
+    qsort(samples, count, sizeof(double), _compare_doubles);
+    return samples[count / 2];
+}
+
+static void _record(const char *name, size_t n, double *samples)
+{
+    if(_resultCount == MAX_RESULTS) return;
+
+    bench_result_t *result = &_results[_resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->n = n;
+    result->ns = _median(samples, _reps);
+
+    fprintf(stderr, "%-14s %8zu %10.2f ns\n", name, n, result->ns);
+}
+
+// ------------------------------------------   RENDERER
+
+static GLuint _textures[TEXTURES];
+static VitaExDataHandle *_exData;
+
+/**
+ * bench_frames():
+ *  Draws `n` textured sprites, MAX_VERTICES a frame, and
+ *  totals the time making the calls & each Vita_Repaint stage.
+ */
+static void bench_frames(size_t n, double *vertex_ns, double *sort_ns, double *submit_ns, double *batch_ns)
+{
+    VitaFrameTimings timings;
+    double vertex = 0., sort = 0., submit = 0., batch = 0.;
+
+    for(size_t drawn = 0; drawn < n; )
+    {
+        size_t frame = n - drawn < MAX_VERTICES ? n - drawn : MAX_VERTICES;
+
+        Vita_Clear();
+        uint64_t start = Vita_ProfilerNow();
+        for(size_t i = 0; i < frame; i++)
+        {
+            // A third of the sprites are off screen, for culling to drop.
+            float x = _rngf(-1.4f, 1.4f), y = _rngf(-1.4f, 1.4f);
+            Vita_DrawTextureAnimColorExData(x, y, .05f, -.05f,
+                _textures[_rng() % TEXTURES], 64.f, 64.f, 0.f, 0.f, 16.f, 16.f,
+                1.f, 1.f, 1.f, 1.f, _exData[i]);
+        }
+        vertex += (double)(Vita_ProfilerNow() - start);
+
+        Vita_Repaint();
+        Vita_GetFrameTimings(&timings);
+        sort += timings.cpu_ms[VGL_TIMING_SORT] * 1e6;
+        submit += timings.cpu_ms[VGL_TIMING_SUBMIT] * 1e6;
+        batch += timings.cpu_ms[VGL_TIMING_DRAW] * 1e6;
+
+        drawn += frame;
+    }
+
+    *vertex_ns = vertex / n;
+    *sort_ns = sort / n;
+    *submit_ns = submit / n;
+    *batch_ns = batch / n;
+}
+
+/**
+ * check_overflow():
+ *  Queues more than MAX_VERTICES calls with each Vita_Draw* function in
+ *  one frame: those past the limit have to be dropped, not written past
+ *  the buffers.
+ *
+ *  returns 0 if the frame kept exactly MAX_VERTICES of them.
+ */
+static int check_overflow()
+{
+    float white[4] = { 1.f, 1.f, 1.f, 1.f };
+    VitaFrameStats stats;
+    int failed = 0;
+
+    for(int f = 0; f < 5; f++)
+    {
+        Vita_Clear();
+        for(int i = 0; i < MAX_VERTICES + 64; i++)
+        {
+            switch(f)
+            {
+                case 0: Vita_Draw(0.f, 0.f, .05f, -.05f); break;
+                case 1: Vita_DrawRectColor(0.f, 0.f, .05f, -.05f, 1.f, 1.f, 1.f, 1.f); break;
+                case 2: Vita_DrawRect4xColor(0.f, 0.f, .05f, -.05f, white, white, white, white); break;
+                case 3: Vita_DrawRectColorExData(0.f, 0.f, .05f, -.05f, 1.f, 1.f, 1.f, 1.f, _exData[i % MAX_VERTICES]); break;
+                default:
+                    Vita_DrawTextureAnimColorExData(0.f, 0.f, .05f, -.05f, _textures[0], 64.f, 64.f,
+                        0.f, 0.f, 16.f, 16.f, 1.f, 1.f, 1.f, 1.f, _exData[i % MAX_VERTICES]);
+                    break;
+            }
+        }
+        Vita_Repaint();
+
+        if(!Vita_GetFrameStats(&stats) || stats.sprites_submitted != MAX_VERTICES)
+        {
+            fprintf(stderr, "Overflowing draw function %d queued %u calls, not %d.\n",
+                f, (unsigned)stats.sprites_submitted, MAX_VERTICES);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
+
+static void bench_renderer(size_t n)
+{
+    double vertex[MAX_REPS], sort[MAX_REPS], submit[MAX_REPS], batch[MAX_REPS];
+
+    for(int r = 0; r < _reps; r++)
+        bench_frames(n, &vertex[r], &sort[r], &submit[r], &batch[r]);
+
+    _record("vertex_gen", n, vertex);
+    _record("sort", n, sort);
+    _record("cull_submit", n, submit);
+    _record("batch", n, batch);
+}
+
+// ------------------------------------------   CULLING
+
+static void bench_cull(size_t n)
+{
+    DrawCall *source = (DrawCall *)calloc(n, sizeof(DrawCall));
+    DrawCall *calls = (DrawCall *)malloc(sizeof(DrawCall) * n);
+    uint32_t *kept_from = (uint32_t *)malloc(sizeof(uint32_t) * n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        float x = _rngf(-1.4f, 1.4f), y = _rngf(-1.4f, 1.4f);
+        for(int v = 0; v < 4; v++)
+        {
+            source[i].draw.verts_quad[v].x = x + ((v & 2) ? .05f : 0.f);
+            source[i].draw.verts_quad[v].y = y - ((v & 1) ? .05f : 0.f);
+            source[i].draw.verts_quad[v].z = .5f;
+        }
+    }
+
+    const float identity[16] = { 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+
+    double samples[MAX_REPS];
+    for(int r = 0; r < _reps; r++)
+    {
+        memcpy(calls, source, sizeof(DrawCall) * n);
+
+        uint64_t start = Vita_ProfilerNow();
+        _sink += Vita_CullQuads(calls, (uint32_t)n, identity, 0.f, 0.f, kept_from);
+        samples[r] = (double)(Vita_ProfilerNow() - start) / n;
+    }
+    _record("cull", n, samples);
+
+    free(kept_from);
+    free(calls);
+    free(source);
+}
+
+// ------------------------------------------   HASH MAP
+
+static void bench_map(size_t n)
+{
+    uint32_t *queries = (uint32_t *)malloc(sizeof(uint32_t) * n);
+    for(size_t i = 0; i < n; i++)
+        queries[i] = _rng() % n;
+
+    double put[MAX_REPS], get[MAX_REPS], del[MAX_REPS];
+    for(int r = 0; r < _reps; r++)
+    {
+        // Starting small, so growth is part of the insert cost.
+        bm_map_t *map = create_basic_map(16);
+
+        uint64_t start = Vita_ProfilerNow();
+        for(size_t i = 0; i < n; i++)
+            put_basic_map(map, (void *)(uintptr_t)(i + 1));
+        put[r] = (double)(Vita_ProfilerNow() - start) / n;
+
+        start = Vita_ProfilerNow();
+        for(size_t i = 0; i < n; i++)
+            _sink += (uintptr_t)get_by_id_basic_map(map, queries[i])->obj_ptr;
+        get[r] = (double)(Vita_ProfilerNow() - start) / n;
+
+        start = Vita_ProfilerNow();
+        for(size_t i = 0; i < n; i++)
+            remove_basic_map(map, i);
+        del[r] = (double)(Vita_ProfilerNow() - start) / n;
+
+        free_basic_map(map);
+    }
+
+    _record("map_put", n, put);
+    _record("map_get", n, get);
+    _record("map_remove", n, del);
+
+    free(queries);
+}
+
+// ------------------------------------------   TEXTURE DECODE
+
+/**
+ * bench_decode():
+ *  Decodes a texture of about `n` texels (square, whole blocks)
+ *  in `format`, which the loader does when the GPU can't sample it.
+ */
+static void bench_decode(const char *name, uint32_t format, size_t n)
+{
+    int side = ((int)ceil(sqrt((double)n)) + 3) & ~3;
+    size_t texels = (size_t)side * side;
+
+    unsigned char *rgba = (unsigned char *)malloc(texels * 4);
+    void *compressed = malloc(Vita_CompressedSize(format, side, side));
+
+    // Noisy gradients, so every block's endpoints & indices differ.
+    for(size_t i = 0; i < texels; i++)
+    {
+        rgba[i * 4 + 0] = (unsigned char)(i % side + (_rng() & 15));
+        rgba[i * 4 + 1] = (unsigned char)(i / side + (_rng() & 15));
+        rgba[i * 4 + 2] = (unsigned char)(_rng());
+        rgba[i * 4 + 3] = (unsigned char)(255 - (_rng() & 63));
+    }
+    Vita_EncodeCompressed(format, rgba, side, side, compressed);
+
+    double samples[MAX_REPS];
+    for(int r = 0; r < _reps; r++)
+    {
+        uint64_t start = Vita_ProfilerNow();
+        Vita_DecodeCompressed(format, compressed, side, side, rgba);
+        samples[r] = (double)(Vita_ProfilerNow() - start) / texels;
+        _sink += rgba[texels / 2];
+    }
+    _record(name, n, samples);
+
+    free(compressed);
+    free(rgba);
+}
+
+// ------------------------------------------   RESULTS
+
+static int _write_json(const char *path)
+{
+    FILE *file = path != NULL ? fopen(path, "w") : stdout;
+    if(file == NULL)
+    {
+        fprintf(stderr, "Could not write %s\n", path);
+        return -1;
+    }
+
+    // One result per line; _compare reads them back the same way.
+    fprintf(file, "{\n  \"unit\": \"ns_per_op\",\n  \"results\": [\n");
+    for(int i = 0; i < _resultCount; i++)
+    {
+        fprintf(file, "    {\"name\": \"%s\", \"n\": %zu, \"ns\": %.3f}%s\n",
+            _results[i].name, _results[i].n, _results[i].ns, i + 1 < _resultCount ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    if(file != stdout) fclose(file);
+    return 0;
+}
+
+/**
+ * _compare():
+ *  returns the number of results more than `threshold` percent
+ *  slower than in `path`, -1 if it couldn't be read.
+ */
+static int _compare(const char *path, double threshold)
+{
+    FILE *file = fopen(path, "r");
+    if(file == NULL)
+    {
+        fprintf(stderr, "Could not read baseline %s\n", path);
+        return -1;
+    }
+
+    int regressions = 0;
+    char line[256], name[32];
+    size_t n;
+    double ns;
+
+    fprintf(stderr, "\nAgainst %s (threshold %.1f%%):\n", path, threshold);
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        if(sscanf(line, " {\"name\": \"%31[^\"]\", \"n\": %zu, \"ns\": %lf}", name, &n, &ns) != 3)
+            continue;
+
+        for(int i = 0; i < _resultCount; i++)
+        {
+            if(strcmp(_results[i].name, name) != 0 || _results[i].n != n) continue;
+
+            double change = ns > 0. ? (_results[i].ns - ns) / ns * 100. : 0.;
+            int regressed = change > threshold;
+            regressions += regressed;
+
+            fprintf(stderr, "%-14s %8zu %10.2f -> %10.2f ns %+7.1f%%%s\n",
+                name, n, ns, _results[i].ns, change, regressed ? "  REGRESSION" : "");
+            break;
+        }
+    }
+
+    fclose(file);
+    return regressions;
+}
+
+// ------------------------------------------   END RESULTS
+
+int main(int argc, char **argv)
+{
+    size_t scales[MAX_SCALES] = { 1000, 10000, 100000 };
+    int scale_count = 3;
+    const char *output = NULL, *baseline = NULL;
+    double threshold = 10.;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(value != NULL && strcmp(argv[i], "-n") == 0)
+        {
+            scale_count = 0;
+            for(char *end = (char *)value; *end != '\0' && scale_count < MAX_SCALES; )
+            {
+                scales[scale_count] = strtoul(end, &end, 10);
+                if(scales[scale_count] > 0) scale_count++;
+                if(*end == ',') end++;
+                else break;
+            }
+        }
+        else if(value != NULL && strcmp(argv[i], "-r") == 0) _reps = atoi(value);
+        else if(value != NULL && strcmp(argv[i], "-o") == 0) output = value;
+        else if(value != NULL && strcmp(argv[i], "-b") == 0) baseline = value;
+        else if(value != NULL && strcmp(argv[i], "-t") == 0) threshold = atof(value);
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n 1000,10000,100000] [-r reps] [-o results.json] [-b baseline.json] [-t threshold %%]\n", argv[0]);
+            return 2;
+        }
+        i++;
+    }
+
+    if(_reps < 1) _reps = 1;
+    if(_reps > MAX_REPS) _reps = MAX_REPS;
+    if(scale_count == 0)
+    {
+        fprintf(stderr, "No scales to run.\n");
+        return 2;
+    }
+
+    if(initGL(_quiet) != 0 || initGLShading() != 0)
+    {
+        fprintf(stderr, "Could not start the renderer.\n");
+        return 1;
+    }
+    initGLAdv();
+    Vita_InitTextureLoader(1, _quiet);
+    Vita_SetCulling(1);
+    Vita_SetSorting(1);
+
+    glGenTextures(TEXTURES, _textures);
+    _exData = (VitaExDataHandle *)malloc(sizeof(VitaExDataHandle) * MAX_VERTICES);
+    for(int i = 0; i < MAX_VERTICES; i++)
+        _exData[i] = Vita_CreateExData();
+
+    if(check_overflow() != 0) return 1;
+
+    for(int s = 0; s < scale_count; s++)
+    {
+        size_t n = scales[s];
+        bench_renderer(n);
+        bench_cull(n);
+        bench_map(n);
+        bench_decode("decode_dxt1", VGL_COMPRESSED_RGB_S3TC_DXT1, n);
+        bench_decode("decode_dxt5", VGL_COMPRESSED_RGBA_S3TC_DXT5, n);
+        bench_decode("decode_etc1", VGL_ETC1_RGB8, n);
+    }
+
+    if(_write_json(output) != 0) return 1;
+
+    int regressions = 0;
+    if(baseline != NULL)
+    {
+        regressions = _compare(baseline, threshold);
+        if(regressions > 0)
+            fprintf(stderr, "%d regression(s).\n", regressions);
+    }
+
+    free(_exData);
+    Vita_ShutdownTextureLoader();
+    deInitGL();
+
+    return regressions != 0 ? 1 : 0;
+}
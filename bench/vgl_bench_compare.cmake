@@ -0,0 +1,25 @@
+# Runs vgl_bench against a stored baseline, for the vgl_bench_compare target.
+# Without one, the results are only written out and the comparison is skipped.
+#
+#   cmake -DVGL_BENCH=<vgl_bench> -DBASELINE=<baseline.json> -DOUTPUT=<results.json>
+#         -DTHRESHOLD=<percent> -P vgl_bench_compare.cmake
+
+if(EXISTS "${BASELINE}")
+  execute_process(
+    COMMAND "${VGL_BENCH}" -o "${OUTPUT}" -b "${BASELINE}" -t "${THRESHOLD}"
+    RESULT_VARIABLE result
+  )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "vgl_bench: regressions against ${BASELINE} (or it failed to run).")
+  endif()
+else()
+  message(STATUS "No vgl_bench baseline at ${BASELINE}, skipping the comparison. "
+    "Build the vgl_bench_baseline target to record one on this machine.")
+  execute_process(
+    COMMAND "${VGL_BENCH}" -o "${OUTPUT}"
+    RESULT_VARIABLE result
+  )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "vgl_bench failed.")
+  endif()
+endif()
@@ -1,18 +1,55 @@
 varying vec4 fragColor;
 varying vec2 texCoord;
 
+// Compiled once per feature set, see VGL_SHADER_* in vgl_renderer.h.
+#ifdef VGL_TEXTURED
 uniform sampler2D ourTexture;
-uniform bool useTexture;
+#ifdef VGL_PALETTE
+// Indexed texture: ourTexture holds palette indices, ourPalette a 256x1 row of colors.
+uniform sampler2D ourPalette;
+#ifdef VGL_PALETTE4
+uniform float ourIndexWidth; // In indices. Two per texel, low nibble first.
+#endif
+#endif
+
+vec4 sampleTexture(vec2 uv)
+{
+#ifdef VGL_PALETTE
+    float index = floor((texture2D(ourTexture, uv).r * 255.0) + 0.5);
+#ifdef VGL_PALETTE4
+    float high = floor(index / 16.0);
+    index = mod(floor(uv.x * ourIndexWidth), 2.0) < 0.5 ? index - (high * 16.0) : high;
+#endif
+    return texture2D(ourPalette, vec2((index + 0.5) / 256.0, 0.5));
+#else
+    return texture2D(ourTexture, uv);
+#endif
+}
+#endif
 
 void main()
 {
-    if(fragColor.a < .5) discard;
-    if(useTexture)
-    {
-        vec4 texel = texture2D(ourTexture, texCoord) * fragColor;
-        if(texel.a < .8) discard;
-        gl_FragColor = texel;
-    }
-    else
-        gl_FragColor = fragColor;
+#ifdef VGL_VERTEX_COLOR
+    vec4 tint = fragColor;
+#else
+    vec4 tint = vec4(1.0);
+#endif
+
+#ifdef VGL_ALPHA_TEST
+    if(tint.a < .5) discard;
+#endif
+
+#ifdef VGL_PREMULTIPLIED
+    tint.rgb *= tint.a;
+#endif
+
+#ifdef VGL_TEXTURED
+    vec4 texel = sampleTexture(texCoord) * tint;
+#ifdef VGL_ALPHA_TEST
+    if(texel.a < .8) discard;
+#endif
+    gl_FragColor = texel;
+#else
+    gl_FragColor = tint;
+#endif
 }
\ No newline at end of file
@@ -1,14 +1,39 @@
 varying vec4 fragColor;
 varying vec2 texCoord;
 
+#ifdef VGL_TEXTURED
 uniform sampler2D ourTexture;
-uniform bool useTexture;
+#ifdef VGL_PALETTE
+// Indexed texture: ourTexture holds palette indices, ourPalette a 256x1 row of colors.
+uniform sampler2D ourPalette;
+#ifdef VGL_PALETTE4
+uniform float ourIndexWidth; // In indices. Two per texel, low nibble first.
+#endif
+#endif
+
+vec4 sampleTexture(vec2 uv)
+{
+#ifdef VGL_PALETTE
+    float index = floor((texture2D(ourTexture, uv).r * 255.0) + 0.5);
+#ifdef VGL_PALETTE4
+    float high = floor(index / 16.0);
+    index = mod(floor(uv.x * ourIndexWidth), 2.0) < 0.5 ? index - (high * 16.0) : high;
+#endif
+    return texture2D(ourPalette, vec2((index + 0.5) / 256.0, 0.5));
+#else
+    return texture2D(ourTexture, uv);
+#endif
+}
+#endif
 
 void main()
 {
+    // Only shadow what the default pass will actually draw.
+    float alpha = fragColor.a;
+#ifdef VGL_TEXTURED
+    alpha *= sampleTexture(texCoord).a;
+#endif
+    if(alpha < .5) discard;
+
     gl_FragColor = vec4(.4, .4, .4, .58);
-    // if(useTexture)
-    //     gl_FragColor = texture2D(ourTexture, texCoord) * fragColor;
-    // else
-    //     gl_FragColor = fragColor;
 }
\ No newline at end of file
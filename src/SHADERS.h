@@ -2,9 +2,23 @@
 #define _SHADERS_H_
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_pack.h"
+#include "vgl_alloc.h"
 
 static inline int _Vita_ReadShaderFromFile(const char* path, size_t* fsize, char** buffer)
 {
+    // The mounted asset pack first, which saves opening a file.
+    const void *packed = Vita_FindPackedFile(path, fsize);
+    if(packed != NULL)
+    {
+        *buffer = (char*)VGL_REALLOC(*buffer, (*fsize) + 1);
+        memcpy(*buffer, packed, (*fsize) + 1); // Packed files are zero terminated.
+        return 0;
+    }
+
     FILE *_file = fopen(path, "r");
 
     if(_file == NULL)
@@ -16,7 +30,7 @@ static inline int _Vita_ReadShaderFromFile(const char* path, size_t* fsize, char
     *fsize = ftell(_file);
     fseek(_file, 0, SEEK_SET);
 
-    *buffer = (char*)realloc(*buffer, (*fsize) + 1);
+    *buffer = (char*)VGL_REALLOC(*buffer, (*fsize) + 1);
     fread(*buffer, *fsize, 1, _file);
 
     size_t offset = *fsize;
@@ -37,6 +51,7 @@ static const char vShaderString[] =
     " uniform float4x4 mvp,\n"
     " uniform float4x4 _rot,\n"
     " uniform float4x4 _scale,\n"
+    " uniform float2 _offset,\n"
     " float4 out vertPos : POSITION,\n"
     " float4 out fragColor : COLOR,\n"
     " float2 out texCoord : TEXCOORD0\n"
@@ -45,6 +60,7 @@ static const char vShaderString[] =
     "   float4x4 temp = mul(mvp, _rot);\n"
     "   temp = mul(temp, _scale);\n"
     "   vertPos = mul(temp, float4(aPosition, 0.f, 1.f));\n"
+    "   vertPos.xy += _offset;\n"
     // "   vertPos = float4(aPosition.xy, 0.f, 1.f);\n"
     "   fragColor = vColor;\n"
     "   texCoord = vTexCoord;\n"
@@ -58,7 +74,9 @@ static const char vFragmentString[] =
     //   "uniform sampler2D ourTexture\n"
     ") : COLOR\n"
     "{\n"
-    "   "
+    "#if defined(VGL_ALPHA_TEST) && defined(VGL_VERTEX_COLOR)\n"
+    "   if(fragColor.a < .5f) discard;\n"
+    "#endif\n"
     "   return float4(1.0f, 0.0f, 0.0f, 1.0f);\n"
     "}\n";
 #else
@@ -73,7 +91,11 @@ static const char vShaderString[] =
 
 static const char vFragmentString[] =   
     "float4 main(uniform float4 color) : COLOR\n"
-    "{return float4(1.0f, 0.0f, 0.0f, 1.0f);}\n";
+    "{\n"
+    "#ifdef VGL_ALPHA_TEST\n"
+    "if(color.a < .5f) discard;\n"
+    "#endif\n"
+    "return float4(1.0f, 0.0f, 0.0f, 1.0f);}\n";
 #endif
 #else
 
@@ -95,9 +117,11 @@ static const char vShaderString[] =
      "uniform mat4 mvp;\n"
      "uniform mat4 _rot;\n"
      "uniform mat4 _scale;\n"
+     "uniform vec2 _offset;\n"
       "void main()                  \n"
       "{                            \n"
       "   gl_Position = mvp * _rot * _scale * vec4(vPosition.xy, 0, 1);  \n"
+      "   gl_Position.xy += _offset;   \n"
       "   fragColor = vColor;          \n"
       "   texCoord = vTexCoord;         \n"
       "}                            \n";
@@ -105,14 +129,50 @@ static const char vShaderString[] =
 static const char vFragmentString[] =   
       "varying vec4 fragColor;\n"
       "varying vec2 texCoord;\n"
-      "uniform sampler2D ourTexture;"
-      "uniform bool useTexture;"
+      "#ifdef VGL_TEXTURED\n"
+      "uniform sampler2D ourTexture;\n"
+      "#ifdef VGL_PALETTE\n"
+      "uniform sampler2D ourPalette;\n"
+      "#ifdef VGL_PALETTE4\n"
+      "uniform float ourIndexWidth;\n"
+      "#endif\n"
+      "#endif\n"
+      "vec4 sampleTexture(vec2 uv)\n"
+      "{\n"
+      "#ifdef VGL_PALETTE\n"
+      "    float index = floor((texture2D(ourTexture, uv).r * 255.0) + 0.5);\n"
+      "#ifdef VGL_PALETTE4\n"
+      "    float high = floor(index / 16.0);\n"
+      "    index = mod(floor(uv.x * ourIndexWidth), 2.0) < 0.5 ? index - (high * 16.0) : high;\n"
+      "#endif\n"
+      "    return texture2D(ourPalette, vec2((index + 0.5) / 256.0, 0.5));\n"
+      "#else\n"
+      "    return texture2D(ourTexture, uv);\n"
+      "#endif\n"
+      "}\n"
+      "#endif\n"
       "void main()                                  \n"
       "{                                            \n"
-      " if(useTexture)\n"
-      "     gl_FragColor = texture2D(ourTexture, texCoord) * fragColor;\n"
-      " else\n"
-      "     gl_FragColor = fragColor;\n"
+      "#ifdef VGL_VERTEX_COLOR\n"
+      " vec4 tint = fragColor;\n"
+      "#else\n"
+      " vec4 tint = vec4(1.0);\n"
+      "#endif\n"
+      "#ifdef VGL_ALPHA_TEST\n"
+      " if(tint.a < .5) discard;\n"
+      "#endif\n"
+      "#ifdef VGL_PREMULTIPLIED\n"
+      " tint.rgb *= tint.a;\n"
+      "#endif\n"
+      "#ifdef VGL_TEXTURED\n"
+      " vec4 texel = sampleTexture(texCoord) * tint;\n"
+      "#ifdef VGL_ALPHA_TEST\n"
+      " if(texel.a < .8) discard;\n"
+      "#endif\n"
+      " gl_FragColor = texel;\n"
+      "#else\n"
+      " gl_FragColor = tint;\n"
+      "#endif\n"
       "}           ";
 
 #endif
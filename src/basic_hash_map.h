@@ -2,92 +2,305 @@
 #define __BASIC_MAP__
 
 
-#ifdef __cplusplus__
+#ifdef __cplusplus
 extern "C" {
 #endif
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <memory.h>
 
-#ifndef uint32_t
-typedef unsigned int uint32_t;
-#endif
+#include "vgl_alloc.h"
 
-#ifndef size_t
-#ifdef VITA
-typedef unsigned int size_t;
-#else
-typedef unsigned long size_t;
-#endif
-#endif
+/*
+    Open addressing hash map from a 64 bit id to a pointer.
+
+    Entries live in a dense array (`map`), so iterating with
+    get_at_basic_map touches packed memory. Lookups go through a
+    separate power of two slot table using Robin Hood probing:
+    every slot records its entry's hash, and inserts steal slots from
+    entries that are closer to their ideal slot. This keeps probe
+    lengths short even at high load, so lookups are O(1) expected.
+
+    Removal swaps the last dense entry into the hole and backshifts
+    the following slots, so there are no tombstones to clean up.
+
+    Pointers returned by put/insert/get are only valid until the next
+    put, insert or remove on the same map.
+*/
 
-typedef struct _bm_key 
+typedef uint64_t bm_id_t;
+
+typedef struct _bm_key
 {
-    uint32_t id;
+    bm_id_t id;
     void *obj_ptr;
 } bm_key_t;
 
-typedef struct _bm_map 
+// A slot of the lookup table. index is (dense index + 1), 0 is empty.
+typedef struct _bm_slot
+{
+    uint32_t hash;
+    uint32_t index;
+} bm_slot_t;
+
+typedef struct _bm_map
 {
-    struct _bm_key *map;
+    struct _bm_key *map; // Dense entries.
     size_t tracked_elements;
-    size_t max_elements;
-    uint32_t __last_id;
+    size_t max_elements; // Capacity of `map`. Doubles when full.
+    bm_id_t __last_id;
+
+    struct _bm_slot *slots;
+    size_t slot_mask; // Slot count - 1.
 } bm_map_t;
 
-bm_map_t *create_basic_map(size_t max_elems);
-void free_basic_map(bm_map_t *map);
+static inline bm_map_t *create_basic_map(size_t max_elems);
+static inline void free_basic_map(bm_map_t *map);
+
+static inline bm_key_t *put_basic_map(bm_map_t *map_to_put_in, void *objPtr);
+static inline bm_key_t *insert_basic_map(bm_map_t *map_to_put_in, bm_id_t id, void *objPtr);
+static inline int remove_basic_map(bm_map_t *map_to_remove_from, bm_id_t id);
+static inline bm_key_t *get_at_basic_map(bm_map_t *map_to_get_from, uint32_t INDEX);
+static inline bm_key_t *get_by_id_basic_map(bm_map_t *map_to_get_from, bm_id_t id);
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static inline uint32_t __bm_hash(bm_id_t id)
+{
+    // Murmur3's 64 bit finalizer.
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    id *= 0xc4ceb9fe1a85ec53ULL;
+    id ^= id >> 33;
+
+    return (uint32_t)id;
+}
+
+static inline size_t __bm_probe_distance(const bm_map_t *map, uint32_t hash, size_t slot)
+{
+    return (slot - (hash & map->slot_mask)) & map->slot_mask;
+}
+
+/**
+ * __bm_find_slot():
+ *  returns the slot index holding `id`, or -1.
+ */
+static inline long __bm_find_slot(const bm_map_t *map, bm_id_t id)
+{
+    uint32_t hash = __bm_hash(id);
+    size_t slot = hash & map->slot_mask;
+
+    for(size_t dist = 0; ; dist++, slot = (slot + 1) & map->slot_mask)
+    {
+        const bm_slot_t *s = &map->slots[slot];
+
+        // Robin Hood invariant: once we're further from home than the
+        // entry in this slot is from its own, `id` can't be further on.
+        if(s->index == 0 || __bm_probe_distance(map, s->hash, slot) < dist)
+            return -1;
+
+        if(s->hash == hash && map->map[s->index - 1].id == id)
+            return (long)slot;
+    }
+}
+
+static inline void __bm_place(bm_map_t *map, uint32_t hash, uint32_t index)
+{
+    bm_slot_t carry = { hash, index };
+    size_t slot = hash & map->slot_mask;
+
+    for(size_t dist = 0; ; dist++, slot = (slot + 1) & map->slot_mask)
+    {
+        bm_slot_t *s = &map->slots[slot];
+
+        if(s->index == 0)
+        {
+            *s = carry;
+            return;
+        }
+
+        // Take the slot from entries closer to home than we are.
+        size_t existing = __bm_probe_distance(map, s->hash, slot);
+        if(existing < dist)
+        {
+            bm_slot_t tmp = *s;
+            *s = carry;
+            carry = tmp;
+            dist = existing;
+        }
+    }
+}
+
+static inline int __bm_grow(bm_map_t *map, size_t new_max)
+{
+    // Keep the slot table at most half full.
+    size_t slot_count = 8;
+    while(slot_count < new_max * 2) slot_count <<= 1;
+
+    int rehash = map->slots == NULL || slot_count != map->slot_mask + 1;
+
+    // Both allocated before either is committed: a failed grow leaves the map as it was.
+    bm_slot_t *new_slots = NULL;
+    if(rehash)
+    {
+        new_slots = (bm_slot_t *)VGL_CALLOC(slot_count, sizeof(bm_slot_t));
+        if(new_slots == NULL) return -1;
+    }
+
+    bm_key_t *new_entries = (bm_key_t *)VGL_REALLOC(map->map, sizeof(bm_key_t) * new_max);
+    if(new_entries == NULL)
+    {
+        free(new_slots);
+        return -1;
+    }
 
-bm_key_t *put_basic_map(bm_map_t *map_to_put_in, void *objPtr);
-bm_key_t *get_at_basic_map(bm_map_t *map_to_get_from, uint32_t INDEX);
-bm_key_t *get_by_id_basic_map(bm_map_t *map_to_get_from, uint32_t id);
+    map->map = new_entries;
+    map->max_elements = new_max;
+    if(!rehash) return 0;
 
-#define __BASIC_MAP_IMPL_
-#ifdef __BASIC_MAP_IMPL_
+    free(map->slots);
+    map->slots = new_slots;
+    map->slot_mask = slot_count - 1;
 
+    for(size_t i = 0; i < map->tracked_elements; i++)
+        __bm_place(map, __bm_hash(map->map[i].id), (uint32_t)(i + 1));
 
-bm_map_t *create_basic_map(size_t max_elems)
+    return 0;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+static inline bm_map_t *create_basic_map(size_t max_elems)
 {
-    // Allocate just for the memory map.
-    bm_map_t *_new_map = malloc(sizeof(bm_map_t));
-    _new_map->map = (struct _bm_key *)malloc(sizeof(bm_key_t) * max_elems);
-    _new_map->__last_id = 0;
-
-    memset(_new_map->map, 0, (sizeof(bm_key_t) * max_elems));
-    _new_map->max_elements = max_elems;
-    _new_map->tracked_elements = 0;
+    if(max_elems == 0) max_elems = 1;
+
+    bm_map_t *_new_map = (bm_map_t *)VGL_CALLOC(1, sizeof(bm_map_t));
+    if(_new_map == NULL) return NULL;
+
+    if(__bm_grow(_new_map, max_elems) != 0)
+    {
+        free_basic_map(_new_map);
+        return NULL;
+    }
+
+    return _new_map;
 }
 
-void free_basic_map(bm_map_t *map)
+static inline void free_basic_map(bm_map_t *map)
 {
     if(map != 0)
     {
         if(map->map != 0)
             free(map->map);
-        
+        if(map->slots != 0)
+            free(map->slots);
+
         free(map);
     }
 }
 
-bm_key_t *put_basic_map(bm_map_t* map_to_put_in, void *objPtr)
+/**
+ * insert_basic_map():
+ *  Maps `id` to `objPtr`, replacing the pointer if `id` is already in the map.
+ *  returns the entry, or NULL if the map couldn't grow.
+ */
+static inline bm_key_t *insert_basic_map(bm_map_t *map_to_put_in, bm_id_t id, void *objPtr)
 {
-    if(map_to_put_in->tracked_elements + 1 == map_to_put_in->max_elements)
+    if(map_to_put_in == NULL) return NULL;
+
+    long slot = __bm_find_slot(map_to_put_in, id);
+    if(slot >= 0)
+    {
+        bm_key_t *existing = &map_to_put_in->map[map_to_put_in->slots[slot].index - 1];
+        existing->obj_ptr = objPtr;
+        return existing;
+    }
+
+    if(map_to_put_in->tracked_elements == map_to_put_in->max_elements
+        && __bm_grow(map_to_put_in, map_to_put_in->max_elements * 2) != 0)
     {
         return NULL; // No space
     }
 
-    ((map_to_put_in->map) + map_to_put_in->tracked_elements)->obj_ptr = objPtr;
-    ((map_to_put_in->map) + map_to_put_in->tracked_elements)->id = (map_to_put_in->__last_id) ++;
+    size_t index = map_to_put_in->tracked_elements++;
+    map_to_put_in->map[index].id = id;
+    map_to_put_in->map[index].obj_ptr = objPtr;
+
+    __bm_place(map_to_put_in, __bm_hash(id), (uint32_t)(index + 1));
 
-    map_to_put_in->tracked_elements++;
+    return &map_to_put_in->map[index];
+}
+
+/**
+ * put_basic_map():
+ *  Inserts `objPtr` under the next free auto-generated id.
+ */
+static inline bm_key_t *put_basic_map(bm_map_t* map_to_put_in, void *objPtr)
+{
+    if(map_to_put_in == NULL) return NULL;
 
-    return &(map_to_put_in->map[(map_to_put_in->tracked_elements - 1)]);
+    return insert_basic_map(map_to_put_in, (map_to_put_in->__last_id)++, objPtr);
 }
 
-bm_key_t *get_at_basic_map(bm_map_t* map_to_get_from, uint32_t INDEX)
+/**
+ * remove_basic_map():
+ *  Removes `id` from the map.
+ *  returns 0 if it was removed, -1 if it wasn't in the map.
+ */
+static inline int remove_basic_map(bm_map_t *map_to_remove_from, bm_id_t id)
 {
-    if(map_to_get_from != NULL 
+    if(map_to_remove_from == NULL) return -1;
+
+    bm_map_t *map = map_to_remove_from;
+    long found = __bm_find_slot(map, id);
+    if(found < 0) return -1;
+
+    size_t slot = (size_t)found;
+    uint32_t index = map->slots[slot].index - 1;
+
+    // Backshift: pull every following displaced slot one step closer to home.
+    for(;;)
+    {
+        size_t next = (slot + 1) & map->slot_mask;
+        bm_slot_t *n = &map->slots[next];
+
+        if(n->index == 0 || __bm_probe_distance(map, n->hash, next) == 0)
+        {
+            map->slots[slot].index = 0;
+            map->slots[slot].hash = 0;
+            break;
+        }
+
+        map->slots[slot] = *n;
+        slot = next;
+    }
+
+    // Keep the dense array packed by moving the last entry into the hole.
+    size_t last = map->tracked_elements - 1;
+    if(index != last)
+    {
+        map->map[index] = map->map[last];
+
+        long moved = __bm_find_slot(map, map->map[index].id);
+        map->slots[moved].index = index + 1;
+    }
+
+    map->tracked_elements--;
+    return 0;
+}
+
+/**
+ * get_at_basic_map():
+ *  returns the INDEX'th entry of the dense array.
+ *  Removals move the last entry into the removed one's place.
+ */
+static inline bm_key_t *get_at_basic_map(bm_map_t* map_to_get_from, uint32_t INDEX)
+{
+    if(map_to_get_from != NULL
         && INDEX < map_to_get_from->tracked_elements)
     {
         return &(map_to_get_from->map[INDEX]);
@@ -96,25 +309,22 @@ bm_key_t *get_at_basic_map(bm_map_t* map_to_get_from, uint32_t INDEX)
     return NULL;
 }
 
-bm_key_t *get_by_id_basic_map(bm_map_t* map_to_get_from, uint32_t id)
+static inline bm_key_t *get_by_id_basic_map(bm_map_t* map_to_get_from, bm_id_t id)
 {
     if(map_to_get_from != NULL
         && map_to_get_from->tracked_elements > 0)
     {
-        for(int i = 0; i < map_to_get_from->tracked_elements; i++)
-        {
-            if(map_to_get_from->map[i].id == id)
-                return &(map_to_get_from->map[i]);
-        }
+        long slot = __bm_find_slot(map_to_get_from, id);
+        if(slot >= 0)
+            return &(map_to_get_from->map[map_to_get_from->slots[slot].index - 1]);
     }
 
     return NULL;
 }
-#endif
 
 
-#ifdef __cplusplus__
+#ifdef __cplusplus
 }
 #endif
 
-#endif // __BASIC_MAP__
\ No newline at end of file
+#endif // __BASIC_MAP__
@@ -1,19 +1,15 @@
 
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_NO_HDR
-#define STBI_NO_PIC
-#define STBI_NO_PSD
-#define STBI_ONLY_BMP
-#define STBI_ONLY_GIF
-#define STBI_ONLY_JPEG
-#define STBI_ONLY_PNG
-#define STBI_ONLY_PNM
-#define STBI_ONLY_TGA
+#ifndef __LOAD_TEXTURE_H__
+#define __LOAD_TEXTURE_H__
+
+// The stb_image implementation lives in stb_image.c.
 #include "stb_image.h"
+#include "vgl_pack.h"
 
 
-#if defined(__APPLE__) || defined(PC_BUILD) 
+#if defined(VGL_NULL_BACKEND)
+#include "vgl_null_gl.h"
+#elif defined(__APPLE__) || defined(PC_BUILD) 
 #include <GL/glew.h>
 
 #ifndef __APPLE__
@@ -22,7 +18,9 @@
 #include <OpenGL/glu.h>
 #endif
 
+#ifndef VGL_OFFSCREEN
 #include <GLFW/glfw3.h>
+#endif
 #else
 #include <vitasdk.h>
 #include <vitaGL.h>
@@ -89,7 +87,14 @@ static inline int Vita_LoadTextureBuffer(const char* path,
     stbi_set_flip_vertically_on_load(0);
 
     stbi_uc* uc = NULL;
-    *buffer = stbi_load(path, w, h, channels, STBI_rgb_alpha);
+
+    // Decode straight out of the mounted asset pack if it has the file.
+    size_t packed_size = 0;
+    const void *packed = Vita_FindPackedFile(path, &packed_size);
+    if(packed != NULL)
+        *buffer = stbi_load_from_memory((const stbi_uc*)packed, (int)packed_size, w, h, channels, STBI_rgb_alpha);
+    else
+        *buffer = stbi_load(path, w, h, channels, STBI_rgb_alpha);
     
     size_t newSize = ((*w) * (*h) * (*channels));
     debugPrintf("[Vita_LoadTexture] src size:%d --- Reallocating buffer from size %d to %d (img size: %d x %d)\n", sizeof(uc), sizeof(void*), newSize, *w, *h);
@@ -1,13 +1,18 @@
 #include <stdio.h>
 #include <math.h>
+#include <stdarg.h>
 #include <assert.h>
 
-#define __BASIC_MAP_IMPL_
 #include "basic_hash_map.h"
 
 
 #include "vgl_renderer.h"
 #include "load_texture.h"
+#include "vgl_texture_loader.h"
+#include "vgl_ex_data.h"
+#include "vgl_pack.h"
+#include "vgl_mipmap.h"
+#include "vgl_pixel_format.h"
 #include "SHADERS.h"
 
 
@@ -86,10 +91,12 @@ typedef struct _e
     float speed;
     char enabled;
 
-    float tex_w, tex_h;
+    // Cached texture handle. Carries the GL texture & its size.
+    VitaTexture *texture;
     
     // Contains pivot, scale, and rot data along with texture ID.
-    obj_extra_data *ex_data;
+    // Resolve with Vita_GetExData.
+    VitaExDataHandle ex_data;
 } _entity;
 
 #ifndef ENTITY_COUNT
@@ -124,10 +131,8 @@ void init_entities()
         _test_entities[i].h = (rand() % 4) * 16.f;
         _test_entities[i].speed = min(((rand() % 2) / 2.f) * 2.f, 1.0f);
 
-        // Setup ex_data
-        _test_entities[i].ex_data = (obj_extra_data *)malloc(sizeof(obj_extra_data));
-        memset(_test_entities[i].ex_data, 0, sizeof(obj_extra_data));
-        _test_entities[i].ex_data->scale = 1.f;
+        // Setup ex_data (zeroed, scale of 1)
+        _test_entities[i].ex_data = Vita_CreateExData();
     }
 }
 
@@ -135,7 +140,7 @@ void free_entities()
 {
     for(int i = 0; i < ENTITY_COUNT; i++)
     {
-        free(_test_entities[i].ex_data);
+        Vita_DestroyExData(_test_entities[i].ex_data);
     }
 }
 
@@ -146,9 +151,10 @@ void update_entities(float _ticks)
         _test_entities[i].x += (_test_entities[i].speed * ((rand() % 2) == 1 ? -1 : 1) * _ticks) / _ticks;
         _test_entities[i].y += (_test_entities[i].speed * ((rand() % 2) == 1 ? -1 : 1) * _ticks) / _ticks;
         
-        _test_entities[i].ex_data->piv_x = _test_entities[i].x + (_test_entities[i].w * .5f);
-        _test_entities[i].ex_data->piv_y = _test_entities[i].y + (_test_entities[i].h * .5f);
-        _test_entities[i].ex_data->scale = sinf(_ticks * .1f) * 4.f;
+        obj_extra_data *ex_data = Vita_GetExData(_test_entities[i].ex_data);
+        ex_data->piv_x = _test_entities[i].x + (_test_entities[i].w * .5f);
+        ex_data->piv_y = _test_entities[i].y + (_test_entities[i].h * .5f);
+        ex_data->scale = sinf(_ticks * .1f) * 4.f;
         
 
         if(_test_entities[i].x > DISPLAY_WIDTH_DEF)
@@ -189,6 +195,11 @@ static const char *_vertex_shader = "app0:vert.cgv";
 static const char *_frag_shader = "app0:frag.cgf";
 
 static const char *_path_prefix = "app0:";
+static const char *_program_cache_dir = "ux0:data/BOMB00420";
+static const char *_asset_pack = "app0:assets.vpak";
+#ifdef VGL_PROFILER
+static const char *_trace_path = "ux0:data/BOMB00420/trace.json";
+#endif
 #else
 static const char *_texture_1_path = "../bobomb_red.png";
 static const char *_vertex_shader = "../vert.glsl";
@@ -198,6 +209,11 @@ static const char *_frag2_shader = "../frag_mm_shadow.glsl";
 
 
 static const char *_path_prefix = "../";
+static const char *_program_cache_dir = "./shader_cache";
+static const char *_asset_pack = "./assets.vpak"; // Built next to the executable by the vgl_assets target.
+#ifdef VGL_PROFILER
+static const char *_trace_path = "./trace.json";
+#endif
 #endif
 
 #define _textures_size 11
@@ -216,7 +232,6 @@ static const char *_textures[_textures_size] =
     "npc-24.png" // 10
 };
 
-static GLuint _textures_gl[_textures_size];
 
 
 int test_print_texture_path()
@@ -231,53 +246,59 @@ int test_print_texture_path()
     return 0;
 }
 
+/**
+ * test_load_test_textures():
+ *  Acquires every test texture from the texture cache.
+ *  They're decoded in the background and uploaded a bit per frame
+ *  by Vita_Repaint, drawing as a placeholder until then.
+ */
 int test_load_test_textures()
 {
     char buffer[2048];
     const int buffer_size = 2048;
-    void* tex_buffer;
-    int channels = 0, w = 0, h = 0;
-
-    // Vita_LoadTextureBuffer(_texture_1_path, &tex_buffer, &_tex_1_w, &_tex_1_h, &channels, (void*)debugPrintf);
 
     for(int i = 0; i < _textures_size; i++)
     {
-        // glGenTextures(1, &(_textures_gl[i]));
         snprintf(buffer, buffer_size, "%s%s", _path_prefix, _textures[i]);
-        Vita_LoadTextureBuffer(buffer, &tex_buffer, &w, &h, &channels, (void *)debugPrintf);
 
-        _textures_gl[i] = Vita_LoadTextureGL(tex_buffer, w, h, (void*)debugPrintf);
+        // The bob-ombs are small palette pixel art: 8 bit indices, a quarter of RGBA8.
+        // Everything else is 16 bit wherever it's lossless enough.
+        Vita_SetTexturePixelFormat(i <= 1 ? VGL_PIXEL_INDEX8 : VGL_PIXEL_AUTO, 0);
+        _test_texture_entities[i].texture = Vita_AcquireTexture(buffer);
 
-        if(_test_texture_entities[i].ex_data != NULL)
+        if(_test_texture_entities[i].texture == NULL)
         {
-            _test_texture_entities[i].tex_w = (float)w;
-            _test_texture_entities[i].tex_h = (float)h;
-            _test_texture_entities[i].ex_data->textureID = _textures_gl[i];
-#ifdef DEBUG_BUILD
-            debugPrintf(
-                "Setting tex data to: ID: %u; size: (%.1f x %.1f). size returned: (%d x %d)\n\n\n", 
-                _test_texture_entities[i].ex_data->textureID,
-                _test_texture_entities[i].tex_w,
-                _test_texture_entities[i].tex_h,
-                w, h
-            );
-#endif
+            debugPrintf("ERROR: Could not queue %s\n", buffer);
+            return -1;
         }
-#ifdef DEBUG_BUILD
-        else debugPrintf("WARNING: _test_texture_entities at %d dosn't have ex_data.\n");
-#endif
-        memset(buffer, 0, buffer_size);
-        
     }
 
-    if(tex_buffer != NULL)
-        free(tex_buffer);
-    
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // The backgrounds (2 & 3) are drawn at 256x256, far below their size.
+    // Mips keep them from aliasing; the pixel art stays nearest.
+    Vita_SetTextureFilter(_test_texture_entities[2].texture, VGL_TEXTURE_FILTER_TRILINEAR);
+    Vita_SetTextureFilter(_test_texture_entities[3].texture, VGL_TEXTURE_FILTER_TRILINEAR);
 
     return 0;
 }
 
+/**
+ * free_test_textures():
+ *  Releases what test_load_test_textures acquired, and Texture_1.
+ *  Shut the loader down first, so no worker is still decoding into them.
+ */
+void free_test_textures()
+{
+    for(int i = 0; i < _textures_size; i++)
+    {
+        Vita_ReleaseTexture(_test_texture_entities[i].texture);
+        _test_texture_entities[i].texture = NULL;
+        Vita_DestroyExData(_test_texture_entities[i].ex_data);
+    }
+
+    if(Texture_1 != 0) glDeleteTextures(1, &Texture_1);
+    Texture_1 = 0;
+}
+
 int init_texture_test_entities()
 {
     for(int i = 0; i < _textures_size; i++)
@@ -288,24 +309,21 @@ int init_texture_test_entities()
 
         _test_texture_entities[i].w = 256;
         _test_texture_entities[i].h = 256;
-        _test_texture_entities[i].ex_data = malloc(sizeof(obj_extra_data));
-        
-        _test_texture_entities[i].ex_data->piv_x = 0;
-        _test_texture_entities[i].ex_data->piv_y = 0;
-        _test_texture_entities[i].ex_data->rot_x = 0;
-        _test_texture_entities[i].ex_data->rot_y = 0;
-        _test_texture_entities[i].ex_data->rot_z = 0;
-        _test_texture_entities[i].ex_data->scale = 1.f;
+        _test_texture_entities[i].ex_data = Vita_CreateExData(); // No pivot or rotation, scale of 1.
     }
 
     return 0;
 }
 
+// Textures change from the placeholder to the real image once they're
+// uploaded, so this is done every frame rather than once after loading.
 int assign_texIDs_texture_test_entities()
 {
     for(int i = 0; i < _textures_size; i++)
     {
-        _test_texture_entities[i].ex_data->textureID = _textures_gl[i];
+        VitaTexture *texture = _test_texture_entities[i].texture;
+        Vita_GetExData(_test_texture_entities[i].ex_data)->textureID = texture->textureID;
+        Vita_SetExDataPalette(_test_texture_entities[i].ex_data, texture, texture->paletteID);
     }
     return 0;
 }
@@ -313,10 +331,10 @@ int assign_texIDs_texture_test_entities()
 static obj_extra_data test_sprite_3 = 
 (obj_extra_data)
 {
-    0,
-    (DISPLAY_WIDTH_DEF / 2) + 100, (DISPLAY_HEIGHT_DEF / 2) + 100,
-    0.f, 0.f, 0.f,
-    1.f
+    .textureID = 0,
+    .piv_x = (DISPLAY_WIDTH_DEF / 2) + 100, .piv_y = (DISPLAY_HEIGHT_DEF / 2) + 100,
+    .rot_x = 0.f, .rot_y = 0.f, .rot_z = 0.f,
+    .scale = 1.f
 };
 
 
@@ -329,16 +347,16 @@ int draw_texture_test_entities()
     {
         _entity e = _test_texture_entities[i];
 
-        // debugPrintf("Draw Test Entity: %.1f, %.1f (%.1f x %.1f) Tex ID: %d; Tex Size: (%.2f x %.2f)\n", e.x, e.y, e.w, e.h, e.ex_data->textureID, e.tex_w, e.tex_h);
+        // debugPrintf("Draw Test Entity: %.1f, %.1f (%.1f x %.1f) Tex ID: %d; Tex Size: (%.2f x %.2f)\n", e.x, e.y, e.w, e.h, e.ex_data->textureID, (float)e.texture->width, (float)e.texture->height);
         
-        // debugPrintf("Tex ID: %d Tex Size: %.2f x %.2f\n", e_d.textureID, e.tex_w, e.tex_h);
+        // debugPrintf("Tex ID: %d Tex Size: %.2f x %.2f\n", e_d.textureID, (float)e.texture->width, (float)e.texture->height);
 
         // if(i == 4)
         // {
         //     for(int x = 0; x < 300; x++)
         //     {
         //         Vita_DrawTextureAnimColorExData(x * 32.f, (x % 600) + (sinf(_ticks) * 64.f), 32.f, 32.f, e.ex_data->textureID,
-        //             e.tex_w, e.tex_h, 0, 0, 32.f, 32.f, 1.f, 1.f, 1.f, 1.f, e.ex_data);
+        //             e.texture->width, e.texture->height, 0, 0, 32.f, 32.f, 1.f, 1.f, 1.f, 1.f, e.ex_data);
         //     }
         //     continue;   
         // }
@@ -351,7 +369,10 @@ int draw_texture_test_entities()
                 normalized_coords.top, 
                 normalized_coords.right - normalized_coords.left, 
                 normalized_coords.bottom - normalized_coords.top, 
-                e.ex_data->textureID, 1008.f, 500.f, 0.f, 0.f, 1008.f, 500.f, 1.f, 1.f, 1.f, 1.f, e.ex_data
+                e.texture->textureID, 
+                e.texture->width, e.texture->height, 
+                0.f, 0.f, e.texture->width, e.texture->height, 
+                1.f, 1.f, 1.f, 1.f, e.ex_data
             );
         }
     }
@@ -371,7 +392,7 @@ int bm_test()
     
     bm_key_t *test_key = put_basic_map(new_map, (void *)_frag_shader);
     assert(test_key != NULL);
-    debugPrintf("[bm_test] test_key->id is %u\n", test_key->id);
+    debugPrintf("[bm_test] test_key->id is %llu\n", (unsigned long long)test_key->id);
     // assert(test_key->id > -1);
     assert(test_key->obj_ptr != NULL);
     assert(((const char*)test_key->obj_ptr) == _frag_shader);
@@ -390,34 +411,47 @@ int bm_test()
     assert(test_key_3->id == test_key->id);
     assert(test_key_3->obj_ptr == test_key->obj_ptr);
 
+    // Grow past the initial size, then remove from the middle.
+    for(int i = 0; i < map_size * 4; i++)
+        assert(insert_basic_map(new_map, 1000 + i, (void *)_frag_shader) != NULL);
+    assert(new_map->max_elements > (size_t)map_size);
+    assert(new_map->tracked_elements == (size_t)(map_size * 4) + 1);
+
+    assert(remove_basic_map(new_map, 1000 + 3) == 0);
+    assert(remove_basic_map(new_map, 1000 + 3) == -1);
+    assert(get_by_id_basic_map(new_map, 1000 + 3) == NULL);
+    assert(get_by_id_basic_map(new_map, 1000 + 4) != NULL);
+    assert(get_by_id_basic_map(new_map, 0) != NULL); // The first put_basic_map id.
+
+    free_basic_map(new_map);
     return 0;
 }
 
 static obj_extra_data test_data_1 = 
 (obj_extra_data)
 {
-    0,
-    256 + 128.f, 256 + 128.f,
-    0.f, 0.f, 0.f,
-    1.f
+    .textureID = 0,
+    .piv_x = 256 + 128.f, .piv_y = 256 + 128.f,
+    .rot_x = 0.f, .rot_y = 0.f, .rot_z = 0.f,
+    .scale = 1.f
 };
 
 static obj_extra_data test_sprite_1 = 
 (obj_extra_data)
 {
-    0,
-    (DISPLAY_WIDTH_DEF / 2) + 100, (DISPLAY_HEIGHT_DEF / 2) + 100,
-    0.f, 0.f, 0.f,
-    1.f
+    .textureID = 0,
+    .piv_x = (DISPLAY_WIDTH_DEF / 2) + 100, .piv_y = (DISPLAY_HEIGHT_DEF / 2) + 100,
+    .rot_x = 0.f, .rot_y = 0.f, .rot_z = 0.f,
+    .scale = 1.f
 };
 
 static obj_extra_data test_sprite_2 = 
 (obj_extra_data)
 {
-    0,
-    (DISPLAY_WIDTH_DEF / 2) + 100, (DISPLAY_HEIGHT_DEF / 2) + 100,
-    0.f, 0.f, 0.f,
-    1.f
+    .textureID = 0,
+    .piv_x = (DISPLAY_WIDTH_DEF / 2) + 100, .piv_y = (DISPLAY_HEIGHT_DEF / 2) + 100,
+    .rot_x = 0.f, .rot_y = 0.f, .rot_z = 0.f,
+    .scale = 1.f
 };
 
 short should_render_overlay = 1;
@@ -461,7 +495,279 @@ void render_overlay()
     );
 }
 
-int main()
+// ------------------------------------------   STRESS SCENE
+// Bunnymark: bouncing sprites, ramped up until a frame takes longer than
+// the target, for every renderer configuration below. Run with `--stress
+// [target ms]` (or build with VGL_STRESS_SCENE), windowed or headless
+// (VGL_OFFSCREEN / VGL_NULL_BACKEND), to compare builds & platforms
+// on the most sprites each one sustains.
+
+#ifndef VGL_STRESS_TARGET_MS
+#define VGL_STRESS_TARGET_MS 16.6f
+#endif
+
+#define STRESS_START_SPRITES 128
+#define STRESS_WARMUP_FRAMES 20
+#define STRESS_MEASURE_FRAMES 60
+#define STRESS_SEARCH_STEPS 6
+
+// How long to wait for the test textures to finish loading. In time rather
+// than frames: headless frames take next to nothing, decoding doesn't.
+#define STRESS_LOAD_SECONDS 10
+
+typedef struct _stress_config
+{
+    const char *name;
+    char batching;
+    char sorting;
+    char atlas; // Every sprite from Texture_1, else spread over the test textures.
+} stress_config;
+
+// The renderer has no instanced path, so there's no instancing configuration.
+static const stress_config _stress_configs[] =
+{
+    { "atlas",                1, 0, 1 },
+    { "atlas, unbatched",     0, 0, 1 },
+    { "textures",             1, 0, 0 },
+    { "textures, sorted",     1, 1, 0 },
+    { "textures, unbatched",  0, 0, 0 },
+};
+#define STRESS_CONFIG_COUNT (int)(sizeof(_stress_configs) / sizeof(_stress_configs[0]))
+
+typedef struct _stress_sprite
+{
+    float x, y;
+    float vx, vy;
+    int texture; // Into _test_texture_entities.
+} stress_sprite;
+
+static stress_sprite _stress_sprites[MAX_VERTICES];
+static VitaExDataHandle _stress_ex_data[MAX_VERTICES];
+
+void init_stress_sprites()
+{
+    for(int i = 0; i < MAX_VERTICES; i++)
+    {
+        _stress_sprites[i].x = rand() % (int)DISPLAY_WIDTH_DEF;
+        _stress_sprites[i].y = rand() % (int)DISPLAY_HEIGHT_DEF;
+        _stress_sprites[i].vx = ((rand() % 1000) / 1000.f - .5f) * 8.f;
+        _stress_sprites[i].vy = ((rand() % 1000) / 1000.f - .5f) * 8.f;
+        _stress_sprites[i].texture = i % _textures_size;
+        _stress_ex_data[i] = Vita_CreateExData();
+    }
+}
+
+void free_stress_sprites()
+{
+    for(int i = 0; i < MAX_VERTICES; i++)
+        Vita_DestroyExData(_stress_ex_data[i]);
+}
+
+void render_stress_sprites(int count, char atlas)
+{
+    const float w = 32.f, h = 32.f;
+
+    for(int i = 0; i < count; i++)
+    {
+        stress_sprite *s = &_stress_sprites[i];
+        obj_extra_data *ex_data = Vita_GetExData(_stress_ex_data[i]);
+        VitaTexture *texture = _test_texture_entities[s->texture].texture;
+
+        // Out of ex data slots, or a texture that didn't load: nothing to draw with.
+        if(ex_data == NULL || (!atlas && texture == NULL)) continue;
+
+        // Bounce off the screen's edges.
+        s->x += s->vx;
+        s->y += s->vy;
+        if(s->x < 0.f || s->x > DISPLAY_WIDTH_DEF - w) s->vx = -s->vx;
+        if(s->y < 0.f || s->y > DISPLAY_HEIGHT_DEF - h) s->vy = -s->vy;
+
+        RectF r = PixelSpaceToGLSpace(s->x, s->y, w, h, DISPLAY_WIDTH_DEF, DISPLAY_HEIGHT_DEF);
+
+        if(atlas)
+        {
+            // Texture_1 is a strip of 16x16 frames.
+            float frame = (float)(i % (_tex_1_h / 16 > 0 ? _tex_1_h / 16 : 1)) * 16.f;
+            ex_data->textureID = Texture_1;
+            Vita_DrawTextureAnimColorExData(r.left, r.top, r.right - r.left, r.bottom - r.top,
+                Texture_1, _tex_1_w, _tex_1_h, 0.f, frame, 16.f, 16.f,
+                1.f, 1.f, 1.f, 1.f, _stress_ex_data[i]);
+        }
+        else
+        {
+            ex_data->textureID = texture->textureID;
+            Vita_SetExDataPalette(_stress_ex_data[i], texture, texture->paletteID);
+            Vita_DrawTextureAnimColorExData(r.left, r.top, r.right - r.left, r.bottom - r.top,
+                texture->textureID, texture->width, texture->height, 0.f, 0.f, texture->width, texture->height,
+                1.f, 1.f, 1.f, 1.f, _stress_ex_data[i]);
+        }
+    }
+}
+
+/**
+ * stress_measure():
+ *  Draws `count` sprites for a while & returns the average frame time, in ms:
+ *  the CPU's, less presenting (a vsync wait isn't work), or the GPU's if longer.
+ *  `batches` receives the average batches a frame.
+ */
+float stress_measure(const stress_config *config, int count, float *batches)
+{
+    VitaFrameTimings timings;
+    double total_ms = 0.;
+
+    for(int frame = 0; frame < STRESS_WARMUP_FRAMES + STRESS_MEASURE_FRAMES; frame++)
+    {
+        if(frame == STRESS_WARMUP_FRAMES)
+            Vita_SetFrameStatsWindow(STRESS_MEASURE_FRAMES);
+
+        Vita_Clear();
+        render_stress_sprites(count, config->atlas);
+        Vita_Repaint();
+
+        if(frame < STRESS_WARMUP_FRAMES) continue;
+
+        Vita_GetFrameTimings(&timings);
+        float ms = timings.cpu_ms[VGL_TIMING_FRAME] - timings.cpu_ms[VGL_TIMING_SWAP];
+        if(timings.gpu_ms[VGL_TIMING_FRAME] > ms) ms = timings.gpu_ms[VGL_TIMING_FRAME];
+        total_ms += ms;
+    }
+
+    VitaFrameStatsSummary summary;
+    *batches = Vita_GetFrameStatsSummary(&summary) > 0 ? summary.avg.batches : 0.f;
+
+    return (float)(total_ms / STRESS_MEASURE_FRAMES);
+}
+
+/**
+ * stress_ramp():
+ *  Doubles the sprites until a frame takes longer than `target_ms`, then
+ *  narrows down on the most that don't. MAX_VERTICES is as far as it goes.
+ *
+ *  returns that many sprites, with their frame time in `ms_out`.
+ */
+int stress_ramp(const stress_config *config, float target_ms, float *ms_out, float *batches_out)
+{
+    int good = 0, bad = 0;
+    float ms, batches;
+    *ms_out = 0.f;
+    *batches_out = 0.f;
+
+    for(int count = STRESS_START_SPRITES; ; count *= 2)
+    {
+        if(count > MAX_VERTICES) count = MAX_VERTICES;
+
+        ms = stress_measure(config, count, &batches);
+        if(ms > target_ms)
+        {
+            bad = count;
+            break;
+        }
+
+        good = count;
+        *ms_out = ms;
+        *batches_out = batches;
+        if(count == MAX_VERTICES) return good;
+    }
+
+    for(int step = 0; step < STRESS_SEARCH_STEPS && bad - good > 16; step++)
+    {
+        int count = good + (bad - good) / 2;
+        ms = stress_measure(config, count, &batches);
+        if(ms > target_ms)
+        {
+            bad = count;
+        }
+        else
+        {
+            good = count;
+            *ms_out = ms;
+            *batches_out = batches;
+        }
+    }
+
+    return good;
+}
+
+int run_stress_scene(float target_ms)
+{
+    init_stress_sprites();
+
+    // The "textures" configurations need every test texture up.
+    uint64_t load_start = Vita_ProfilerNow();
+    while(Vita_ProfilerNow() - load_start < STRESS_LOAD_SECONDS * 1000000000ull)
+    {
+        int loading = 0;
+        for(int i = 0; i < _textures_size; i++)
+        {
+            VitaTexture *texture = _test_texture_entities[i].texture;
+            loading += texture != NULL && texture->state == VGL_TEXTURE_LOADING;
+        }
+        if(loading == 0) break;
+
+        Vita_Clear();
+        Vita_Repaint();
+    }
+
+#if defined(VGL_NULL_BACKEND)
+    const char *backend = "null GL";
+#elif defined(VGL_OFFSCREEN)
+    const char *backend = "offscreen";
+#elif defined(VITA)
+    const char *backend = "vita";
+#else
+    const char *backend = "windowed";
+#endif
+
+    debugPrintf("[stress] %s, target %.2f ms a frame, at most %d sprites.\n", backend, target_ms, MAX_VERTICES);
+
+    for(int c = 0; c < STRESS_CONFIG_COUNT; c++)
+    {
+        const stress_config *config = &_stress_configs[c];
+        Vita_SetBatching(config->batching);
+        Vita_SetSorting(config->sorting);
+
+        float ms, batches;
+        int sprites = stress_ramp(config, target_ms, &ms, &batches);
+
+        debugPrintf("[stress] %-20s %6d sprites (%.2f ms, %.0f batches)%s\n",
+            config->name, sprites, ms, batches, sprites == MAX_VERTICES ? " at the MAX_VERTICES limit, raise it with VGL_MAX_VERTICES" : "");
+    }
+    debugPrintf("[stress] %-20s    n/a (the renderer has no instanced path)\n", "instancing");
+
+    Vita_SetBatching(1);
+    Vita_SetSorting(0);
+    free_stress_sprites();
+    return 0;
+}
+
+/**
+ * stress_requested():
+ *  returns 1 if the stress scene should run instead of the demo,
+ *  with the frame time to ramp up to in `target_ms`.
+ */
+int stress_requested(int argc, char **argv, float *target_ms)
+{
+    *target_ms = VGL_STRESS_TARGET_MS;
+    int requested = 0;
+#ifdef VGL_STRESS_SCENE
+    requested = 1;
+#endif
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--stress") != 0) continue;
+
+        requested = 1;
+        if(i + 1 < argc && atof(argv[i + 1]) > 0.f)
+            *target_ms = atof(argv[++i]);
+    }
+
+    return requested;
+}
+
+// ------------------------------------------   END STRESS SCENE
+
+int main(int argc, char **argv)
 {
 
 
@@ -469,6 +775,12 @@ int main()
     test_print_texture_path();
 
     initGL(debugPrintf);
+    Vita_SetProgramCacheDir(_program_cache_dir);
+
+    // Every asset path below starts with _path_prefix, which the pack strips.
+    // Without a pack, everything is read from loose files.
+    if(Vita_MountPack(_asset_pack, _path_prefix) != 0)
+        debugPrintf("No asset pack at %s, using loose files.\n", _asset_pack);
 
     int retVal = 0;
     char *vert_shader = malloc(2), *frag_shader = malloc(2);
@@ -492,6 +804,10 @@ int main()
 
     int shadingErrorCode = 0;
 
+    // frag.glsl/frag.cgf discard mostly transparent fragments
+    // on top of tinting everything by the vertex color.
+    Vita_SetShaderFeatures(VGL_SHADER_ALPHA_TEST | VGL_SHADER_VERTEX_COLOR);
+
     if((shadingErrorCode = initGLShading2(vert_shader, frag_shader)) != 0)
     {
         debugPrintf("ERROR INIT GL SHADING! %d\n", shadingErrorCode);
@@ -503,9 +819,15 @@ int main()
     
     initGLAdv();
 
+    if(Vita_InitTextureLoader(2, debugPrintf) != 0)
+    {
+        debugPrintf("ERROR: Could not start the texture loader.\n");
+        return -1;
+    }
+
     init_texture_test_entities();
+    Vita_SetTextureMipmaps(VGL_MIPMAP_BOX);
     test_load_test_textures();
-    assign_texIDs_texture_test_entities();
     
 
 
@@ -539,6 +861,9 @@ int main()
     if(Texture_1 == 0)
     {
         debugPrintf("Texture_1 failed to load: Returned %d for ID.\n", Texture_1);
+        free(tex_buffer);
+        Vita_ShutdownTextureLoader();
+        free_test_textures();
         deInitGL();
         return -1;
     }
@@ -547,6 +872,17 @@ int main()
     init_entities();
 
     Vita_SetClearColor(.3f, .8f, .1f, 1.f);
+
+    float stress_target_ms;
+    if(stress_requested(argc, argv, &stress_target_ms))
+    {
+        int result = run_stress_scene(stress_target_ms);
+        free_entities();
+        Vita_ShutdownTextureLoader();
+        free_test_textures();
+        deInitGL();
+        return result;
+    }
     
 
     int run = 1;
@@ -650,6 +986,7 @@ int main()
 
         render_overlay();
 
+        assign_texIDs_texture_test_entities();
         draw_texture_test_entities();
 
         
@@ -660,6 +997,12 @@ int main()
 
         // Draw from vbo, swap to next vbo
         Vita_Repaint();
+
+#ifdef VGL_PROFILER
+        // Once loading has settled, a trace of one second's worth of frames.
+        if(Vita_ProfilerFrame() == 300)
+            debugPrintf("[main] Wrote %d profiler events to %s.\n", Vita_ProfilerExportTrace(_trace_path, 240, 299), _trace_path);
+#endif
 #ifdef VITA
         _ticks += .077f;
 #else
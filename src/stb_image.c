@@ -0,0 +1,20 @@
+// The one translation unit the stb_image implementation is compiled into.
+// Everything else includes stb_image.h (or load_texture.h) for the declarations.
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_HDR
+#define STBI_NO_PIC
+#define STBI_NO_PSD
+#define STBI_ONLY_BMP
+#define STBI_ONLY_GIF
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_PNG
+#define STBI_ONLY_PNM
+#define STBI_ONLY_TGA
+
+// Decoding allocates, and is counted like the rest of the renderer (vgl_alloc.h).
+#include "vgl_alloc.h"
+#define STBI_MALLOC(size) VGL_MALLOC(size)
+#define STBI_REALLOC(ptr, size) VGL_REALLOC(ptr, size)
+#define STBI_FREE(ptr) free(ptr)
+#include "stb_image.h"
@@ -0,0 +1,32 @@
+#ifndef __VGL_ALLOC_H__
+#define __VGL_ALLOC_H__
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    Heap allocations.
+
+    Every malloc, calloc, realloc & strdup the renderer makes (its
+    containers & stb_image included) goes through these macros, so debug
+    builds count all of them, on any thread, and a steady state frame
+    can be checked for making none: see Vita_GetFrameHeapAllocations.
+    Don't call the allocator directly, or "0" stops meaning zero.
+
+    Not counted: free, the app's own allocations (main.c), and the null
+    GL backend's, which stand in for the driver's.
+*/
+
+#ifdef DEBUG_BUILD
+extern unsigned long _vgl_heap_allocations;
+#define VGL_COUNT_HEAP_ALLOC() ((void)__atomic_fetch_add(&_vgl_heap_allocations, 1, __ATOMIC_RELAXED))
+#else
+#define VGL_COUNT_HEAP_ALLOC() ((void)0)
+#endif
+
+#define VGL_MALLOC(size) (VGL_COUNT_HEAP_ALLOC(), malloc(size))
+#define VGL_CALLOC(count, size) (VGL_COUNT_HEAP_ALLOC(), calloc((count), (size)))
+#define VGL_REALLOC(ptr, size) (VGL_COUNT_HEAP_ALLOC(), realloc((ptr), (size)))
+#define VGL_STRDUP(str) (VGL_COUNT_HEAP_ALLOC(), strdup(str))
+
+#endif // __VGL_ALLOC_H__
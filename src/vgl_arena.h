@@ -0,0 +1,100 @@
+#ifndef __VGL_ARENA_H__
+#define __VGL_ARENA_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_alloc.h"
+
+/*
+    Linear (bump) arena.
+
+    One block is allocated up front. Vita_ArenaAlloc just moves an offset
+    forward, and everything is released at once with Vita_ArenaReset or
+    back to a mark with Vita_ArenaRewind. Nothing is freed individually.
+
+    The renderer keeps two of these (see vgl_renderer.h):
+        frame arena:   reset at the end of every Vita_Repaint.
+        scratch arena: used between Vita_ScratchBegin / Vita_ScratchEnd.
+
+    Not thread safe.
+*/
+
+// Default alignment of arena allocations. Enough for any scalar or SIMD type we use.
+#define VGL_ARENA_ALIGNMENT 16
+
+typedef struct _vita_arena
+{
+    unsigned char *base;
+    size_t size;
+    size_t offset;
+
+    size_t high_water; // Largest offset ever reached, for sizing the arena.
+    size_t failed; // Allocations that didn't fit.
+} VitaArena;
+
+/**
+ * Vita_ArenaInit():
+ *  Allocates `size` bytes for `arena`.
+ *  returns 0 on success.
+ */
+static inline int Vita_ArenaInit(VitaArena *arena, size_t size)
+{
+    memset(arena, 0, sizeof(VitaArena));
+
+    arena->base = (unsigned char *)VGL_MALLOC(size);
+    if(arena->base == NULL) return -1;
+
+    arena->size = size;
+    return 0;
+}
+
+static inline void Vita_ArenaDestroy(VitaArena *arena)
+{
+    free(arena->base);
+    memset(arena, 0, sizeof(VitaArena));
+}
+
+/**
+ * Vita_ArenaAlloc():
+ *  returns `size` bytes aligned to `alignment` (a power of two),
+ *  or NULL if the arena is out of space.
+ */
+static inline void *Vita_ArenaAlloc(VitaArena *arena, size_t size, size_t alignment)
+{
+    uintptr_t start = ((uintptr_t)arena->base + arena->offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t offset = (size_t)(start - (uintptr_t)arena->base);
+
+    if(arena->base == NULL || offset + size > arena->size)
+    {
+        arena->failed++;
+        return NULL;
+    }
+
+    arena->offset = offset + size;
+    if(arena->offset > arena->high_water) arena->high_water = arena->offset;
+
+    return (void *)start;
+}
+
+static inline size_t Vita_ArenaMark(const VitaArena *arena)
+{
+    return arena->offset;
+}
+
+/**
+ * Vita_ArenaRewind():
+ *  Frees everything allocated since `mark` was taken.
+ */
+static inline void Vita_ArenaRewind(VitaArena *arena, size_t mark)
+{
+    if(mark <= arena->offset) arena->offset = mark;
+}
+
+static inline void Vita_ArenaReset(VitaArena *arena)
+{
+    arena->offset = 0;
+}
+
+#endif // __VGL_ARENA_H__
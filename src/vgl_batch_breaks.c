@@ -0,0 +1,195 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_arena.h"
+#include "vgl_batch_breaks.h"
+#include "basic_hash_map.h"
+
+// Tracked textures & call sites start out with room for this many.
+#define BREAKERS_INITIAL_SIZE 64
+
+static char _enabled = 0;
+
+// The frame being recorded & the last one. Allocated the first time
+// diagnostics are turned on.
+static VitaBatchBreak *_curBreaks, *_lastBreaks;
+static int _curCount = 0, _lastCount = 0;
+
+static VitaBatchBreakTotals _totals;
+
+// Texture name / call site -> avoidable breaks, stored as the pointer.
+static bm_map_t *_byTexture;
+static bm_map_t *_bySite;
+
+static const char *_reasonNames[VGL_BREAK_REASON_COUNT] = {
+    "pass", "texture", "palette", "untextured"
+};
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static inline void _Vita_CountBreaker(bm_map_t *map, uint64_t key)
+{
+    bm_key_t *entry = get_by_id_basic_map(map, key);
+    uintptr_t count = entry != NULL ? (uintptr_t)entry->obj_ptr : 0;
+
+    if(entry != NULL) entry->obj_ptr = (void *)(count + 1);
+    else insert_basic_map(map, key, (void *)(uintptr_t)1);
+}
+
+/**
+ * _Vita_TopBreakers():
+ *  Copies the `max` entries of `map` with the most breaks to `top`, most first.
+ *  returns how many were copied.
+ */
+static int _Vita_TopBreakers(bm_map_t *map, VitaBatchBreaker *top, int max)
+{
+    if(map == NULL || top == NULL || max <= 0) return 0;
+
+    int count = 0;
+    for(uint32_t i = 0; i < map->tracked_elements; i++)
+    {
+        const bm_key_t *entry = get_at_basic_map(map, i);
+        VitaBatchBreaker breaker = { entry->id, (unsigned int)(uintptr_t)entry->obj_ptr };
+
+        // Insertion into the sorted `top`, dropping whatever falls off the end.
+        int at = count < max ? count++ : max;
+        while(at > 0 && top[at - 1].breaks < breaker.breaks)
+        {
+            if(at < max) top[at] = top[at - 1];
+            at--;
+        }
+        if(at < max) top[at] = breaker;
+    }
+
+    return count;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+void Vita_SetBatchDiagnostics(int enabled)
+{
+    enabled = enabled != 0;
+    if(enabled == _enabled) return;
+
+    if(enabled)
+    {
+        if(_curBreaks == NULL)
+        {
+            _curBreaks = (VitaBatchBreak *)VGL_MALLOC(sizeof(VitaBatchBreak) * VGL_BATCH_BREAKS_MAX);
+            _lastBreaks = (VitaBatchBreak *)VGL_MALLOC(sizeof(VitaBatchBreak) * VGL_BATCH_BREAKS_MAX);
+        }
+
+        // Totals start over.
+        free_basic_map(_byTexture);
+        free_basic_map(_bySite);
+        _byTexture = create_basic_map(BREAKERS_INITIAL_SIZE);
+        _bySite = create_basic_map(BREAKERS_INITIAL_SIZE);
+
+        if(_curBreaks == NULL || _lastBreaks == NULL || _byTexture == NULL || _bySite == NULL)
+            return;
+
+        memset(&_totals, 0, sizeof(_totals));
+        _curCount = _lastCount = 0;
+    }
+
+    _enabled = enabled;
+}
+
+int Vita_BatchDiagnosticsEnabled()
+{
+    return _enabled;
+}
+
+void Vita_RecordBatchBreak(int reason, int pass, uint32_t draw_index,
+    unsigned int texture, unsigned int previous_texture, const void *call_site)
+{
+    if(!_enabled || reason < 0 || reason >= VGL_BREAK_REASON_COUNT) return;
+
+    if(_curCount < VGL_BATCH_BREAKS_MAX)
+    {
+        VitaBatchBreak *entry = &_curBreaks[_curCount];
+        entry->reason = (uint8_t)reason;
+        entry->pass = (uint8_t)pass;
+        entry->draw_index = draw_index;
+        entry->texture = texture;
+        entry->previous_texture = previous_texture;
+        entry->call_site = call_site;
+    }
+    _curCount++;
+
+    _totals.batches++;
+    _totals.breaks[reason]++;
+
+    if(reason == VGL_BREAK_PASS) return;
+
+    _Vita_CountBreaker(_byTexture, texture);
+    if(call_site != NULL) _Vita_CountBreaker(_bySite, (uintptr_t)call_site);
+}
+
+void Vita_EndBatchBreakFrame()
+{
+    if(!_enabled) return;
+
+    VitaBatchBreak *swap = _lastBreaks;
+    _lastBreaks = _curBreaks;
+    _curBreaks = swap;
+
+    _lastCount = _curCount;
+    _curCount = 0;
+    _totals.frames++;
+}
+
+int Vita_GetBatchBreaks(VitaBatchBreak *breaks, int max)
+{
+    if(_lastBreaks == NULL) return 0;
+
+    int copy = _lastCount < VGL_BATCH_BREAKS_MAX ? _lastCount : VGL_BATCH_BREAKS_MAX;
+    if(copy > max) copy = max;
+    if(breaks != NULL && copy > 0) memcpy(breaks, _lastBreaks, sizeof(VitaBatchBreak) * copy);
+
+    return _lastCount;
+}
+
+void Vita_GetBatchBreakTotals(VitaBatchBreakTotals *totals)
+{
+    if(totals != NULL) *totals = _totals;
+}
+
+int Vita_GetTopBreakTextures(VitaBatchBreaker *top, int max)
+{
+    return _Vita_TopBreakers(_byTexture, top, max);
+}
+
+int Vita_GetTopBreakSites(VitaBatchBreaker *top, int max)
+{
+    return _Vita_TopBreakers(_bySite, top, max);
+}
+
+void Vita_PrintBatchDiagnostics(void (*printFn)(const char*, ...), int top)
+{
+    if(printFn == NULL) return;
+
+    unsigned int frames = _totals.frames > 0 ? _totals.frames : 1;
+    printFn("[batch_breaks] %u frames, %.1f batches per frame.\n", _totals.frames, (double)_totals.batches / frames);
+    for(int r = 0; r < VGL_BREAK_REASON_COUNT; r++)
+        printFn("[batch_breaks]   %-10s %.1f per frame\n", _reasonNames[r], (double)_totals.breaks[r] / frames);
+
+    VitaBatchBreaker breakers[16];
+    if(top > 16) top = 16;
+
+    int count = Vita_GetTopBreakTextures(breakers, top);
+    for(int i = 0; i < count; i++)
+        printFn("[batch_breaks] texture %llu: %.1f breaks per frame\n", (unsigned long long)breakers[i].key, (double)breakers[i].breaks / frames);
+
+    count = Vita_GetTopBreakSites(breakers, top);
+    for(int i = 0; i < count; i++)
+        printFn("[batch_breaks] call site %p: %.1f breaks per frame\n", (void *)(uintptr_t)breakers[i].key, (double)breakers[i].breaks / frames);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_BATCH_BREAKS_H__
+#define __VGL_BATCH_BREAKS_H__
+
+#include <stdint.h>
+
+/*
+    Batch break diagnostics.
+
+    With Vita_SetBatchDiagnostics on, Vita_Repaint records every batch it
+    starts: why it couldn't continue the one before it, the pass, the draw
+    call starting it (its index in the frame, in the order the Vita_Draw*
+    functions were called) and where that draw call was made from.
+
+    Breaks are also totalled by reason, and the avoidable ones (everything
+    but VGL_BREAK_PASS) by the texture the new batch drew & by call site,
+    from when diagnostics were turned on. The top textures are the ones
+    worth atlasing together; the top call sites are the code worth sorting.
+
+    Call sites are return addresses into the game. Resolve them with
+    `addr2line -f -e <binary> <address>` (minus the load address for PIE
+    builds). With sorting on (Vita_SetSorting) they aren't known and are NULL.
+*/
+
+// Why a batch started. Blending is set once per frame & there's no
+// scissor, and a frame always fits the vertex buffer, so only these split.
+#define VGL_BREAK_PASS 0 // The first batch of a pass. Every pass redraws everything.
+#define VGL_BREAK_TEXTURE 1 // Another texture.
+#define VGL_BREAK_PALETTE 2 // The same indexed texture, another palette.
+#define VGL_BREAK_UNTEXTURED 3 // From textured sprites to untextured rects or back (another shader variant).
+#define VGL_BREAK_REASON_COUNT 4
+
+// Breaks listed per frame. Past it they're still totalled.
+#define VGL_BATCH_BREAKS_MAX 4096
+
+typedef struct _vita_batch_break
+{
+    uint8_t reason; // VGL_BREAK_*
+    uint8_t pass; // Pass slot.
+    uint32_t draw_index; // The draw call starting the batch.
+    unsigned int texture; // What the batch draws with, 0 for untextured rects.
+    unsigned int previous_texture; // What the batch before it drew with.
+    const void *call_site; // Where its draw call was made, NULL if unknown.
+} VitaBatchBreak;
+
+// A texture or call site & the avoidable breaks it caused.
+typedef struct _vita_batch_breaker
+{
+    uint64_t key; // GL texture name, or call site address.
+    unsigned int breaks;
+} VitaBatchBreaker;
+
+typedef struct _vita_batch_break_totals
+{
+    unsigned int frames; // Frames recorded.
+    unsigned long long batches; // Every batch, i.e. every break.
+    unsigned long long breaks[VGL_BREAK_REASON_COUNT]; // By VGL_BREAK_*.
+} VitaBatchBreakTotals;
+
+/**
+ * Vita_SetBatchDiagnostics():
+ *  Turns recording batch breaks on or off (default). Turning it on
+ *  clears the totals. Call sites are tracked from the next frame drawn.
+ */
+void Vita_SetBatchDiagnostics(int enabled);
+int Vita_BatchDiagnosticsEnabled();
+
+/**
+ * Vita_RecordBatchBreak():
+ *  Records a batch starting, see VitaBatchBreak. Called by Vita_Repaint.
+ */
+void Vita_RecordBatchBreak(int reason, int pass, uint32_t draw_index,
+    unsigned int texture, unsigned int previous_texture, const void *call_site);
+
+/**
+ * Vita_EndBatchBreakFrame():
+ *  Makes the breaks recorded so far the last frame's. Called by Vita_Repaint.
+ */
+void Vita_EndBatchBreakFrame();
+
+/**
+ * Vita_GetBatchBreaks():
+ *  Copies up to `max` of the last frame's breaks, in the order
+ *  they happened, to `breaks`.
+ *
+ *  returns the number of breaks the last frame had (all of them,
+ *  even past `max` or VGL_BATCH_BREAKS_MAX).
+ */
+int Vita_GetBatchBreaks(VitaBatchBreak *breaks, int max);
+
+/**
+ * Vita_GetBatchBreakTotals():
+ *  Fills `totals` in with every break since diagnostics were turned on.
+ */
+void Vita_GetBatchBreakTotals(VitaBatchBreakTotals *totals);
+
+/**
+ * Vita_GetTopBreakTextures() / Vita_GetTopBreakSites():
+ *  Copies the `max` textures / call sites that started the most avoidable
+ *  batches since diagnostics were turned on to `top`, most first.
+ *
+ *  returns how many were copied.
+ */
+int Vita_GetTopBreakTextures(VitaBatchBreaker *top, int max);
+int Vita_GetTopBreakSites(VitaBatchBreaker *top, int max);
+
+/**
+ * Vita_PrintBatchDiagnostics():
+ *  Prints the totals & the `top` worst textures & call sites with `printFn`.
+ */
+void Vita_PrintBatchDiagnostics(void (*printFn)(const char*, ...), int top);
+
+#endif // __VGL_BATCH_BREAKS_H__
+
+#ifdef __cplusplus
+}
+#endif
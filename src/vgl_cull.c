@@ -0,0 +1,54 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "vgl_cull.h"
+
+// Vita_CullQuads outcodes, one bit per clip plane a vertex is outside of.
+#define OUT_LEFT 1
+#define OUT_RIGHT 2
+#define OUT_BOTTOM 4
+#define OUT_TOP 8
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static inline unsigned int _Vita_Outcode(const vert *v, const float *m, float margin_x, float margin_y)
+{
+    float x = m[0] * v->x + m[4] * v->y + m[8] * v->z + m[12];
+    float y = m[1] * v->x + m[5] * v->y + m[9] * v->z + m[13];
+    float w = m[3] * v->x + m[7] * v->y + m[11] * v->z + m[15];
+
+    return (x + margin_x < -w ? OUT_LEFT : 0)
+        | (x - margin_x > w ? OUT_RIGHT : 0)
+        | (y + margin_y < -w ? OUT_BOTTOM : 0)
+        | (y - margin_y > w ? OUT_TOP : 0);
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+uint32_t Vita_CullQuads(DrawCall *calls, uint32_t count, const float *mvp, float margin_x, float margin_y, uint32_t *kept_from)
+{
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const vert *quad = calls[i].draw.verts_quad;
+
+        // Culled only if every vertex is past the same edge. Quads straddling
+        // a corner are kept, which is cheaper than being exact.
+        unsigned int outside = _Vita_Outcode(&quad[0], mvp, margin_x, margin_y)
+            & _Vita_Outcode(&quad[1], mvp, margin_x, margin_y)
+            & _Vita_Outcode(&quad[2], mvp, margin_x, margin_y)
+            & _Vita_Outcode(&quad[3], mvp, margin_x, margin_y);
+        if(outside != 0) continue;
+
+        if(kept != i) calls[kept] = calls[i];
+        if(kept_from != NULL) kept_from[kept] = i;
+        kept++;
+    }
+
+    return kept;
+}
+
+#ifdef __cplusplus
+}
+#endif
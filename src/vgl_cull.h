@@ -0,0 +1,30 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_CULL_H__
+#define __VGL_CULL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vgl_renderer_types.h"
+
+/**
+ * Vita_CullQuads():
+ *  Drops every quad of `calls` that `mvp` (a column major 4x4 matrix,
+ *  like cglm's mat4) puts entirely outside clip space, keeping the rest
+ *  in order at the front of `calls`. Quads within `margin_x`/`margin_y`
+ *  (in clip space units) of the edges are kept, for passes drawn offset.
+ *
+ *  If `kept_from` isn't NULL, it receives the index each kept quad had.
+ *
+ *  returns the number of quads kept.
+ */
+uint32_t Vita_CullQuads(DrawCall *calls, uint32_t count, const float *mvp, float margin_x, float margin_y, uint32_t *kept_from);
+
+#endif // __VGL_CULL_H__
+
+#ifdef __cplusplus
+}
+#endif
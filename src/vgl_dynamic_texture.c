@@ -0,0 +1,242 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "vgl_renderer.h"
+#include "vgl_dynamic_texture.h"
+
+// Unpack buffers & fences need the GL headers to know them, and the
+// driver to have them (checked once, see _Vita_UsePixelBuffers).
+#if (defined(__APPLE__) || defined(PC_BUILD)) && defined(GL_PIXEL_UNPACK_BUFFER) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+#define VGL_DYNAMIC_TEXTURE_PBO 1
+#endif
+
+// How long a single wait on a fence may block before it's retried, in ns.
+#define FENCE_WAIT_TIMEOUT 1000000
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_UsePixelBuffers():
+ *  returns 1 if updates go through unpack buffers.
+ */
+static int _Vita_UsePixelBuffers()
+{
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    static int supported = -1;
+    if(supported < 0)
+        supported = GLEW_ARB_pixel_buffer_object && GLEW_ARB_sync && GLEW_ARB_map_buffer_range;
+
+    return supported;
+#else
+    return 0;
+#endif
+}
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+/**
+ * _Vita_WaitFence():
+ *  Blocks until the update that used `buffer` has been read by the GPU.
+ */
+static void _Vita_WaitFence(VitaDynamicTexture *texture, int buffer)
+{
+    GLsync fence = (GLsync)texture->fences[buffer];
+    if(fence == NULL) return;
+
+    GLenum result;
+    do
+    {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+    } while(result == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fence);
+    texture->fences[buffer] = NULL;
+}
+#endif
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+VitaDynamicTexture *Vita_CreateDynamicTexture(int width, int height)
+{
+    if(width <= 0 || height <= 0) return NULL;
+
+    size_t size = (size_t)width * height * 4;
+    VitaDynamicTexture *texture = (VitaDynamicTexture *)VGL_CALLOC(1, sizeof(VitaDynamicTexture));
+    unsigned char *clear = (unsigned char *)VGL_CALLOC(1, size);
+
+    if(texture == NULL || clear == NULL)
+    {
+        free(texture);
+        free(clear);
+        return NULL;
+    }
+
+    VitaTexture *tex = &texture->texture;
+    tex->width = width;
+    tex->height = height;
+    tex->inv_width = 1.f / width;
+    tex->inv_height = 1.f / height;
+    tex->levels = 1;
+    tex->state = VGL_TEXTURE_READY;
+
+    glGenTextures(1, &tex->textureID);
+    glBindTexture(GL_TEXTURE_2D, tex->textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    if(_Vita_UsePixelBuffers())
+    {
+        // Each buffer fits a whole texture's worth, so any rect fits.
+        free(clear);
+        glGenBuffers(VGL_DYNAMIC_TEXTURE_BUFFERS, texture->buffers);
+        for(int i = 0; i < VGL_DYNAMIC_TEXTURE_BUFFERS; i++)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->buffers[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return texture;
+    }
+#endif
+
+    // The cleared buffer becomes the staging buffer.
+    texture->staging = clear;
+    return texture;
+}
+
+void Vita_DestroyDynamicTexture(VitaDynamicTexture *texture)
+{
+    if(texture == NULL) return;
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    if(texture->updating && texture->buffers[0] != 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->buffers[texture->next_buffer]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    for(int i = 0; i < VGL_DYNAMIC_TEXTURE_BUFFERS; i++)
+    {
+        if(texture->fences[i] != NULL) glDeleteSync((GLsync)texture->fences[i]);
+    }
+
+    if(texture->buffers[0] != 0)
+        glDeleteBuffers(VGL_DYNAMIC_TEXTURE_BUFFERS, texture->buffers);
+#endif
+
+    glDeleteTextures(1, &texture->texture.textureID);
+    free(texture->staging);
+    free(texture);
+}
+
+unsigned char *Vita_BeginTextureUpdate(VitaDynamicTexture *texture, int x, int y, int width, int height)
+{
+    if(texture == NULL || texture->updating) return NULL;
+    if(x < 0 || y < 0 || width <= 0 || height <= 0
+        || x + width > texture->texture.width || y + height > texture->texture.height)
+        return NULL;
+
+    unsigned char *texels = texture->staging;
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    if(texture->buffers[0] != 0)
+    {
+        int buffer = texture->next_buffer;
+        _Vita_WaitFence(texture, buffer);
+
+        // The fence says the GPU is done with it: no need for the driver to sync again.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->buffers[buffer]);
+        texels = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)width * height * 4,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+#endif
+
+    if(texels == NULL) return NULL;
+
+    texture->update_x = x;
+    texture->update_y = y;
+    texture->update_width = width;
+    texture->update_height = height;
+    texture->updating = 1;
+    return texels;
+}
+
+void Vita_EndTextureUpdate(VitaDynamicTexture *texture)
+{
+    if(texture == NULL || !texture->updating) return;
+    texture->updating = 0;
+
+    const void *texels = texture->staging;
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    int buffer = texture->next_buffer;
+    if(texture->buffers[0] != 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->buffers[buffer]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        texels = NULL; // An offset into the bound unpack buffer.
+    }
+#endif
+
+    glBindTexture(GL_TEXTURE_2D, texture->texture.textureID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0,
+        texture->update_x, texture->update_y,
+        texture->update_width, texture->update_height,
+        GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    if(texture->buffers[0] != 0)
+    {
+        // Any other glTexImage2D would read from the buffer too.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        texture->fences[buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        texture->next_buffer = (buffer + 1) % VGL_DYNAMIC_TEXTURE_BUFFERS;
+    }
+#endif
+}
+
+int Vita_UpdateDynamicTexture(VitaDynamicTexture *texture, int x, int y, int width, int height, const void *pixels, size_t stride)
+{
+    unsigned char *texels = Vita_BeginTextureUpdate(texture, x, y, width, height);
+    if(texels == NULL) return -1;
+
+    size_t row_bytes = (size_t)width * 4;
+    for(int row = 0; row < height; row++)
+        memcpy(texels + (row_bytes * row), (const unsigned char *)pixels + (stride * row), row_bytes);
+
+    Vita_EndTextureUpdate(texture);
+    return 0;
+}
+
+int Vita_DynamicTextureBusy(VitaDynamicTexture *texture)
+{
+#ifdef VGL_DYNAMIC_TEXTURE_PBO
+    if(texture == NULL || texture->buffers[0] == 0) return 0;
+
+    GLsync fence = (GLsync)texture->fences[texture->next_buffer];
+    if(fence == NULL) return 0;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if(result == GL_TIMEOUT_EXPIRED) return 1;
+
+    glDeleteSync(fence);
+    texture->fences[texture->next_buffer] = NULL;
+    return 0;
+#else
+    (void)texture;
+    return 0;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
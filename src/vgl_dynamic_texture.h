@@ -0,0 +1,110 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_DYNAMIC_TEXTURE_H__
+#define __VGL_DYNAMIC_TEXTURE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vgl_renderer_types.h"
+
+/*
+    Dynamic textures: fixed size RGBA8 textures whose contents are
+    rewritten at runtime (video frames, software drawn canvases, atlas
+    pages being filled in).
+
+    Updates are written straight into a staging buffer:
+
+        unsigned char *texels = Vita_BeginTextureUpdate(tex, x, y, w, h);
+        ... write w * h RGBA8 texels, rows tightly packed ...
+        Vita_EndTextureUpdate(tex);
+
+    On PC the staging buffers are VGL_DYNAMIC_TEXTURE_BUFFERS pixel unpack
+    buffers used in turn, so the copy into the texture happens on the GPU's
+    time instead of stalling the frame. Each gets a fence when its update is
+    issued, and Vita_DynamicTextureBusy checks it: while it's 1, beginning
+    another update would wait for the GPU to finish with the buffer.
+
+    vitaGL has neither unpack buffers nor fences (textures already live in
+    memory the GPU reads directly), so there the staging buffer is plain
+    memory copied in by Vita_EndTextureUpdate, and it's never busy.
+*/
+
+// Staging buffers a dynamic texture cycles through.
+#define VGL_DYNAMIC_TEXTURE_BUFFERS 2
+
+typedef struct _vita_dynamic_texture
+{
+    // Draw with this like any other texture. Always VGL_TEXTURE_READY.
+    VitaTexture texture;
+
+    // Unpack buffers & the fence of their last update (GLsync), PC only.
+    unsigned int buffers[VGL_DYNAMIC_TEXTURE_BUFFERS];
+    void *fences[VGL_DYNAMIC_TEXTURE_BUFFERS];
+    int next_buffer;
+
+    // Without unpack buffers: one plain staging buffer.
+    unsigned char *staging;
+
+    // The update between Vita_BeginTextureUpdate and Vita_EndTextureUpdate.
+    int update_x, update_y, update_width, update_height;
+    char updating;
+} VitaDynamicTexture;
+
+/**
+ * Vita_CreateDynamicTexture():
+ *  Creates a `width` x `height` dynamic texture, cleared to transparent.
+ *  GL thread only, like every function here.
+ *
+ *  returns NULL if it couldn't be allocated.
+ */
+VitaDynamicTexture *Vita_CreateDynamicTexture(int width, int height);
+
+/**
+ * Vita_DestroyDynamicTexture():
+ *  Deletes the texture, its staging buffers, and the handle.
+ */
+void Vita_DestroyDynamicTexture(VitaDynamicTexture *texture);
+
+/**
+ * Vita_BeginTextureUpdate():
+ *  Starts replacing the `width` x `height` rect at (x, y).
+ *  Waits if the staging buffer is still busy (see Vita_DynamicTextureBusy).
+ *
+ *  returns where to write the rect's RGBA8 texels, rows tightly packed,
+ *  valid until Vita_EndTextureUpdate. NULL if the rect is out of bounds,
+ *  an update is already open, or the buffer couldn't be mapped.
+ */
+unsigned char *Vita_BeginTextureUpdate(VitaDynamicTexture *texture, int x, int y, int width, int height);
+
+/**
+ * Vita_EndTextureUpdate():
+ *  Issues the copy of the written texels into the texture.
+ *  Draws from then on see the new contents.
+ */
+void Vita_EndTextureUpdate(VitaDynamicTexture *texture);
+
+/**
+ * Vita_UpdateDynamicTexture():
+ *  Begin, copy `pixels` (rows `stride` bytes apart) in, End.
+ *  `pixels` can be reused as soon as this returns.
+ *
+ *  returns 0 on success, -1 if Vita_BeginTextureUpdate failed.
+ */
+int Vita_UpdateDynamicTexture(VitaDynamicTexture *texture, int x, int y, int width, int height, const void *pixels, size_t stride);
+
+/**
+ * Vita_DynamicTextureBusy():
+ *  returns 1 while the GPU still reads the staging buffer the next
+ *  update would use, i.e. beginning one now would wait. Streaming code
+ *  can skip or defer the update instead.
+ */
+int Vita_DynamicTextureBusy(VitaDynamicTexture *texture);
+
+#endif // __VGL_DYNAMIC_TEXTURE_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_ex_data.h"
+#include "vgl_arena.h"
+
+ExDataSlots _vgl_ex_data = { NULL, NULL, NULL, 0, 0, 0, VGL_EX_DATA_MAX_SLOTS };
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static int _Vita_GrowExData()
+{
+    uint32_t capacity = _vgl_ex_data.capacity ? _vgl_ex_data.capacity * 2 : VGL_EX_DATA_INITIAL_SLOTS;
+    if(capacity > VGL_EX_DATA_MAX_SLOTS) capacity = VGL_EX_DATA_MAX_SLOTS;
+    if(capacity <= _vgl_ex_data.capacity) return -1;
+
+    obj_extra_data *data = (obj_extra_data *)VGL_REALLOC(_vgl_ex_data.data, sizeof(obj_extra_data) * capacity);
+    if(data == NULL) return -1;
+    _vgl_ex_data.data = data;
+
+    uint16_t *generation = (uint16_t *)VGL_REALLOC(_vgl_ex_data.generation, sizeof(uint16_t) * capacity);
+    if(generation == NULL) return -1;
+    _vgl_ex_data.generation = generation;
+
+    uint32_t *next_free = (uint32_t *)VGL_REALLOC(_vgl_ex_data.next_free, sizeof(uint32_t) * capacity);
+    if(next_free == NULL) return -1;
+    _vgl_ex_data.next_free = next_free;
+
+    _vgl_ex_data.capacity = capacity;
+    return 0;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+VitaExDataHandle Vita_CreateExData()
+{
+    uint32_t index;
+
+    if(_vgl_ex_data.free_head != VGL_EX_DATA_MAX_SLOTS)
+    {
+        index = _vgl_ex_data.free_head;
+        _vgl_ex_data.free_head = _vgl_ex_data.next_free[index];
+    }
+    else
+    {
+        if(_vgl_ex_data.used == _vgl_ex_data.capacity && _Vita_GrowExData() != 0)
+            return VGL_EX_DATA_NONE;
+
+        index = _vgl_ex_data.used++;
+        _vgl_ex_data.generation[index] = 1; // Generation 0 is never used, so no handle is VGL_EX_DATA_NONE.
+    }
+
+    obj_extra_data *ex_data = &_vgl_ex_data.data[index];
+    memset(ex_data, 0, sizeof(obj_extra_data));
+    ex_data->scale = 1.f;
+
+    _vgl_ex_data.generation[index] |= VGL_EX_DATA_LIVE;
+    _vgl_ex_data.live++;
+
+    uint32_t gen = _vgl_ex_data.generation[index] & VGL_EX_DATA_GEN_MASK;
+    return (gen << VGL_EX_DATA_INDEX_BITS) | index;
+}
+
+void Vita_DestroyExData(VitaExDataHandle handle)
+{
+    if(Vita_GetExData(handle) == NULL) return;
+
+    uint32_t index = handle & VGL_EX_DATA_INDEX_MASK;
+
+    // Bump the generation so every copy of `handle` goes stale.
+    uint16_t gen = ((_vgl_ex_data.generation[index] & VGL_EX_DATA_GEN_MASK) + 1) & VGL_EX_DATA_GEN_MASK;
+    _vgl_ex_data.generation[index] = gen == 0 ? 1 : gen;
+
+    _vgl_ex_data.next_free[index] = _vgl_ex_data.free_head;
+    _vgl_ex_data.free_head = index;
+    _vgl_ex_data.live--;
+}
+
+void Vita_FreeAllExData()
+{
+    free(_vgl_ex_data.data);
+    free(_vgl_ex_data.generation);
+    free(_vgl_ex_data.next_free);
+
+    memset(&_vgl_ex_data, 0, sizeof(_vgl_ex_data));
+    _vgl_ex_data.free_head = VGL_EX_DATA_MAX_SLOTS;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_EX_DATA_H__
+#define __VGL_EX_DATA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vgl_renderer_types.h"
+#include "vgl_pixel_format.h"
+
+// Handle layout: [generation : 12][slot index : 20]
+#define VGL_EX_DATA_INDEX_BITS 20
+#define VGL_EX_DATA_INDEX_MASK ((1u << VGL_EX_DATA_INDEX_BITS) - 1)
+#define VGL_EX_DATA_GEN_MASK ((1u << (32 - VGL_EX_DATA_INDEX_BITS)) - 1)
+
+// Most extra data slots the renderer will hand out.
+#define VGL_EX_DATA_MAX_SLOTS (1u << VGL_EX_DATA_INDEX_BITS)
+
+// Slots allocated up front. The slot map doubles when it runs out.
+#define VGL_EX_DATA_INITIAL_SLOTS 1024
+
+// Set in ExDataSlots.generation while a slot is in use.
+#define VGL_EX_DATA_LIVE 0x8000
+
+// The renderer's slot map of obj_extra_data.
+// Everything is stored in parallel arrays indexed by slot, so the
+// repaint loop reads packed memory instead of chasing game pointers.
+typedef struct _ex_data_slots
+{
+    obj_extra_data *data;
+    uint16_t *generation; // Slot generation, | VGL_EX_DATA_LIVE while in use.
+    uint32_t *next_free; // Free list links.
+
+    uint32_t capacity;
+    uint32_t used; // Slots ever handed out. Slots past this were never touched.
+    uint32_t live;
+    uint32_t free_head; // VGL_EX_DATA_MAX_SLOTS when empty.
+} ExDataSlots;
+
+extern ExDataSlots _vgl_ex_data;
+
+/**
+ * Vita_CreateExData():
+ *  Allocates extra data for a sprite: no rotation, scale of 1.
+ *  GL thread only.
+ *
+ *  returns the handle to pass to the *ExData draw functions,
+ *  or VGL_EX_DATA_NONE if every slot is taken.
+ */
+VitaExDataHandle Vita_CreateExData();
+
+/**
+ * Vita_DestroyExData():
+ *  Frees the extra data behind `handle`. Any copies of the
+ *  handle stop resolving, so the slot can be safely reused.
+ */
+void Vita_DestroyExData(VitaExDataHandle handle);
+
+/**
+ * Vita_FreeAllExData():
+ *  Releases the slot map. Every outstanding handle goes stale.
+ *  Called from deInitGL.
+ */
+void Vita_FreeAllExData();
+
+/**
+ * Vita_GetExData():
+ *  returns the extra data behind `handle`, or NULL if it is
+ *  VGL_EX_DATA_NONE or stale (its data was destroyed).
+ *
+ *  The pointer is only valid until the next Vita_CreateExData,
+ *  which may move the slot map. Keep the handle, not the pointer.
+ */
+static inline obj_extra_data *Vita_GetExData(VitaExDataHandle handle)
+{
+    uint32_t index = handle & VGL_EX_DATA_INDEX_MASK;
+    uint32_t gen = handle >> VGL_EX_DATA_INDEX_BITS;
+
+    if(handle == VGL_EX_DATA_NONE || index >= _vgl_ex_data.used
+        || _vgl_ex_data.generation[index] != (gen | VGL_EX_DATA_LIVE))
+        return NULL;
+
+    return &_vgl_ex_data.data[index];
+}
+
+/**
+ * Vita_SetExDataPalette():
+ *  Draws with `handle` look indexed `texture`'s texels up in `paletteID`:
+ *  texture->paletteID for its own colors, or one from Vita_CreatePalette
+ *  to recolor it. Textures that aren't indexed (or are still loading)
+ *  clear it, so like textureID, set it every frame until they're ready.
+ */
+static inline void Vita_SetExDataPalette(VitaExDataHandle handle, const VitaTexture *texture, unsigned int paletteID)
+{
+    obj_extra_data *data = Vita_GetExData(handle);
+    if(data == NULL) return;
+
+    int indexed = texture != NULL && Vita_IsIndexedPixelFormat(texture->pixel_format);
+    data->paletteID = indexed ? paletteID : 0;
+    data->index_width = (indexed && texture->pixel_format == VGL_PIXEL_INDEX4) ? (unsigned short)texture->width : 0;
+}
+
+#endif // __VGL_EX_DATA_H__
+
+#ifdef __cplusplus
+}
+#endif
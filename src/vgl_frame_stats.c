@@ -0,0 +1,140 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_frame_stats.h"
+
+// The window's frames, oldest overwritten first.
+static VitaFrameStats _history[VGL_FRAME_STATS_MAX_WINDOW];
+static int _window = VGL_FRAME_STATS_DEFAULT_WINDOW;
+static int _recorded = 0; // Frames in _history, up to _window.
+static int _next = 0; // Where the next frame goes.
+
+// One field's values over the window, sorted while summarizing.
+static double _values[VGL_FRAME_STATS_MAX_WINDOW];
+
+// Every field summarized, & whether it's a float or a uint32_t.
+static const struct
+{
+    size_t offset;
+    char is_float;
+} _fields[] = {
+    { offsetof(VitaFrameStats, sprites_submitted), 0 },
+    { offsetof(VitaFrameStats, sprites_culled), 0 },
+    { offsetof(VitaFrameStats, batches), 0 },
+    { offsetof(VitaFrameStats, draw_calls), 0 },
+    { offsetof(VitaFrameStats, texture_changes), 0 },
+    { offsetof(VitaFrameStats, shader_changes), 0 },
+    { offsetof(VitaFrameStats, uniform_changes), 0 },
+    { offsetof(VitaFrameStats, vertices), 0 },
+    { offsetof(VitaFrameStats, vertex_bytes), 0 },
+    { offsetof(VitaFrameStats, texture_bytes), 0 },
+    { offsetof(VitaFrameStats, cpu_ms), 1 },
+    { offsetof(VitaFrameStats, gpu_ms), 1 },
+};
+
+#define FIELD_COUNT (sizeof(_fields) / sizeof(_fields[0]))
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static int _Vita_CompareValues(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static inline double _Vita_GetField(const VitaFrameStats *stats, int field)
+{
+    const char *at = (const char *)stats + _fields[field].offset;
+    return _fields[field].is_float ? *(const float *)at : *(const uint32_t *)at;
+}
+
+static inline void _Vita_SetField(VitaFrameStats *stats, int field, double value)
+{
+    char *at = (char *)stats + _fields[field].offset;
+    if(_fields[field].is_float) *(float *)at = (float)value;
+    else *(uint32_t *)at = (uint32_t)(value + .5);
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+void Vita_RecordFrameStats(const VitaFrameStats *stats)
+{
+    if(stats == NULL) return;
+
+    _history[_next] = *stats;
+    _next = (_next + 1) % _window;
+    if(_recorded < _window) _recorded++;
+}
+
+int Vita_GetFrameStats(VitaFrameStats *stats)
+{
+    if(_recorded == 0) return 0;
+
+    if(stats != NULL) *stats = _history[(_next + _window - 1) % _window];
+    return 1;
+}
+
+void Vita_SetFrameStatsWindow(int frames)
+{
+    if(frames < 1) frames = 1;
+    if(frames > VGL_FRAME_STATS_MAX_WINDOW) frames = VGL_FRAME_STATS_MAX_WINDOW;
+
+    _window = frames;
+    _recorded = 0;
+    _next = 0;
+}
+
+int Vita_GetFrameStatsSummary(VitaFrameStatsSummary *summary)
+{
+    if(summary == NULL || _recorded == 0) return 0;
+
+    memset(summary, 0, sizeof(VitaFrameStatsSummary));
+    summary->frames = _recorded;
+
+    VitaFrameStats latest;
+    Vita_GetFrameStats(&latest);
+    summary->min.frame = summary->avg.frame = summary->p99.frame = latest.frame;
+
+    for(int f = 0; f < (int)FIELD_COUNT; f++)
+    {
+        // Only GPU times can be missing (-1), everything else is counted every frame.
+        int count = 0;
+        double sum = 0;
+        for(int i = 0; i < _recorded; i++)
+        {
+            double value = _Vita_GetField(&_history[i], f);
+            if(value < 0) continue;
+
+            _values[count++] = value;
+            sum += value;
+        }
+
+        if(count == 0)
+        {
+            _Vita_SetField(&summary->min, f, -1);
+            _Vita_SetField(&summary->avg, f, -1);
+            _Vita_SetField(&summary->p99, f, -1);
+            continue;
+        }
+
+        qsort(_values, count, sizeof(double), _Vita_CompareValues);
+
+        // Nearest rank: the smallest value at least 99% of frames are at or under.
+        int rank = (count * 99 + 99) / 100;
+
+        _Vita_SetField(&summary->min, f, _values[0]);
+        _Vita_SetField(&summary->avg, f, sum / count);
+        _Vita_SetField(&summary->p99, f, _values[rank - 1]);
+    }
+
+    return summary->frames;
+}
+
+#ifdef __cplusplus
+}
+#endif
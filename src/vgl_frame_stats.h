@@ -0,0 +1,89 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_FRAME_STATS_H__
+#define __VGL_FRAME_STATS_H__
+
+#include <stdint.h>
+
+/*
+    Per frame render statistics.
+
+    Vita_Repaint counts what it did into a VitaFrameStats every frame and
+    records it here. The last VGL_FRAME_STATS_DEFAULT_WINDOW frames (see
+    Vita_SetFrameStatsWindow) are kept, so games & benchmarks can read
+    the min, average & 99th percentile of every field over them.
+*/
+
+// Frames summarized by default, and at most.
+#define VGL_FRAME_STATS_DEFAULT_WINDOW 120
+#define VGL_FRAME_STATS_MAX_WINDOW 600
+
+typedef struct _vita_frame_stats
+{
+    uint32_t frame; // Vita_ProfilerFrame when it was recorded.
+
+    uint32_t sprites_submitted; // Queued with the Vita_Draw* functions.
+    uint32_t sprites_culled; // Entirely off screen, dropped before uploading.
+    uint32_t batches; // Runs of sprites sharing state, drawn together. Every pass.
+    uint32_t draw_calls; // Draw calls made to the driver.
+    uint32_t texture_changes; // Textures & palettes bound.
+    uint32_t shader_changes; // Programs made current.
+    uint32_t uniform_changes; // glUniform* calls.
+    uint32_t vertices; // Vertices drawn, every pass.
+    uint32_t vertex_bytes; // Uploaded to the vertex buffer.
+    uint32_t texture_bytes; // Uploaded by the texture loader.
+
+    float cpu_ms; // The whole frame, as VGL_TIMING_FRAME.
+    float gpu_ms; // The latest frame the GPU timer read back, -1 without timer queries.
+} VitaFrameStats;
+
+typedef struct _vita_frame_stats_summary
+{
+    int frames; // Frames summarized, up to the window.
+
+    // Field by field over those frames. `frame` is the latest frame in all three.
+    // gpu_ms only counts frames that have it, -1 if none did.
+    VitaFrameStats min;
+    VitaFrameStats avg;
+    VitaFrameStats p99;
+} VitaFrameStatsSummary;
+
+/**
+ * Vita_RecordFrameStats():
+ *  Adds a finished frame's `stats`, dropping the oldest one past the window.
+ *  Called by Vita_Repaint.
+ */
+void Vita_RecordFrameStats(const VitaFrameStats *stats);
+
+/**
+ * Vita_GetFrameStats():
+ *  Copies the last frame recorded to `stats`.
+ *
+ *  returns 1 if there is one.
+ */
+int Vita_GetFrameStats(VitaFrameStats *stats);
+
+/**
+ * Vita_SetFrameStatsWindow():
+ *  Summarizes the last `frames` frames (up to VGL_FRAME_STATS_MAX_WINDOW)
+ *  from now on. The frames recorded so far are forgotten.
+ */
+void Vita_SetFrameStatsWindow(int frames);
+
+/**
+ * Vita_GetFrameStatsSummary():
+ *  Fills `summary` in with the min, average & 99th percentile of every
+ *  field over the frames in the window. Sorts the window, so it's meant
+ *  to be called now and then rather than every frame.
+ *
+ *  returns the number of frames summarized, 0 if none were recorded yet.
+ */
+int Vita_GetFrameStatsSummary(VitaFrameStatsSummary *summary);
+
+#endif // __VGL_FRAME_STATS_H__
+
+#ifdef __cplusplus
+}
+#endif
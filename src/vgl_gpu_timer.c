@@ -0,0 +1,207 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "vgl_renderer.h"
+#include "vgl_gpu_timer.h"
+
+// Timestamp queries need the GL headers to know them, and the
+// driver to have them (checked once, see _Vita_GPUTimerInit).
+#if (defined(__APPLE__) || defined(PC_BUILD)) && defined(GL_TIMESTAMP)
+#define VGL_GPU_TIMER_QUERIES 1
+#endif
+
+// Batch timestamps stop this many queries short of the end,
+// so the pass timestamps after them always fit.
+#define PASS_QUERY_RESERVE 32
+
+static int _mode = VGL_GPU_TIMERS_PASSES;
+
+// The latest frame read back.
+static VitaGPUTimings _latest;
+static char _haveLatest = 0;
+
+#ifdef VGL_GPU_TIMER_QUERIES
+
+// One frame's timestamps.
+typedef struct _gpu_timer_set
+{
+    GLuint queries[VGL_GPU_TIMER_MAX_QUERIES];
+    unsigned char mark[VGL_GPU_TIMER_MAX_QUERIES]; // VGL_GPU_MARK_*
+    unsigned char pass[VGL_GPU_TIMER_MAX_QUERIES];
+    int used; // Timestamps written & not read back yet.
+    uint32_t frame;
+} GPUTimerSet;
+
+static GPUTimerSet _sets[VGL_GPU_TIMER_FRAMES];
+static int _current = VGL_GPU_TIMER_FRAMES - 1; // The set being written.
+static char _frameOpen = 0; // The current set got its VGL_GPU_MARK_FRAME.
+
+static char _initialized = 0;
+static char _supported = 0;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_GPUTimerInit():
+ *  Checks for timer queries & creates every set's queries, the first time.
+ *
+ *  returns 1 if the GPU can be timed.
+ */
+static int _Vita_GPUTimerInit()
+{
+    if(_initialized) return _supported;
+    _initialized = 1;
+
+    _supported = GLEW_ARB_timer_query != 0;
+    if(_supported)
+    {
+        for(int i = 0; i < VGL_GPU_TIMER_FRAMES; i++)
+            glGenQueries(VGL_GPU_TIMER_MAX_QUERIES, _sets[i].queries);
+    }
+
+    return _supported;
+}
+
+static inline float _Vita_NsToMs(GLuint64 ns)
+{
+    return (float)ns / 1000000.f;
+}
+
+/**
+ * _Vita_ReadSet():
+ *  Turns `set`'s timestamps into _latest, if the GPU has written them all.
+ *
+ *  returns 1 if it did, 0 if they aren't ready yet.
+ */
+static int _Vita_ReadSet(GPUTimerSet *set)
+{
+    // Timestamps complete in order, so the last one being in means they all are.
+    GLint available = 0;
+    glGetQueryObjectiv(set->queries[set->used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) return 0;
+
+    VitaGPUTimings *out = &_latest;
+    out->frame = set->frame;
+    out->frame_ms = out->upload_ms = out->draw_ms = 0.f;
+    out->batch_count = 0;
+    for(int p = 0; p < VGL_TIMING_MAX_PASSES; p++)
+        out->pass_ms[p] = -1.f;
+
+    GLuint64 first = 0, previous = 0, pass_start = 0, timestamp = 0;
+    for(int i = 0; i < set->used; i++)
+    {
+        glGetQueryObjectui64v(set->queries[i], GL_QUERY_RESULT, &timestamp);
+
+        switch(set->mark[i])
+        {
+            case VGL_GPU_MARK_FRAME:
+                first = timestamp;
+                break;
+            case VGL_GPU_MARK_UPLOADED:
+                out->upload_ms = _Vita_NsToMs(timestamp - first);
+                break;
+            case VGL_GPU_MARK_PASS:
+                pass_start = timestamp;
+                break;
+            case VGL_GPU_MARK_BATCH:
+                // Since the previous batch (or the pass start): its state changes & draw.
+                if(out->batch_count < VGL_GPU_TIMER_MAX_BATCHES)
+                    out->batch_ms[out->batch_count++] = _Vita_NsToMs(timestamp - previous);
+                break;
+            case VGL_GPU_MARK_PASS_END:
+                out->pass_ms[set->pass[i]] = _Vita_NsToMs(timestamp - pass_start);
+                out->draw_ms += out->pass_ms[set->pass[i]];
+                break;
+        }
+
+        previous = timestamp;
+    }
+
+    out->frame_ms = _Vita_NsToMs(timestamp - first);
+    _haveLatest = 1;
+
+    set->used = 0;
+    return 1;
+}
+
+/**
+ * _Vita_BeginSet():
+ *  Reads back every set that's ready, oldest first, and starts
+ *  writing the next one. Its previous frame is dropped if it still
+ *  isn't ready after VGL_GPU_TIMER_FRAMES frames.
+ */
+static void _Vita_BeginSet()
+{
+    for(int k = 1; k <= VGL_GPU_TIMER_FRAMES; k++)
+    {
+        GPUTimerSet *pending = &_sets[(_current + k) % VGL_GPU_TIMER_FRAMES];
+        if(pending->used == 0) continue;
+        if(!_Vita_ReadSet(pending)) break;
+    }
+
+    _current = (_current + 1) % VGL_GPU_TIMER_FRAMES;
+
+    GPUTimerSet *set = &_sets[_current];
+    set->used = 0;
+    set->frame = Vita_ProfilerFrame();
+    _frameOpen = 1;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+#endif // VGL_GPU_TIMER_QUERIES
+
+int Vita_GPUTimersSupported()
+{
+#ifdef VGL_GPU_TIMER_QUERIES
+    return _Vita_GPUTimerInit();
+#else
+    return 0;
+#endif
+}
+
+void Vita_SetGPUTimers(int mode)
+{
+    _mode = mode;
+}
+
+void Vita_GPUTimerMark(int mark, int pass)
+{
+#ifdef VGL_GPU_TIMER_QUERIES
+    if(mark == VGL_GPU_MARK_FRAME)
+    {
+        _frameOpen = 0;
+        if(_mode == VGL_GPU_TIMERS_OFF || !_Vita_GPUTimerInit()) return;
+        _Vita_BeginSet();
+    }
+
+    if(!_frameOpen || _mode == VGL_GPU_TIMERS_OFF) return;
+
+    GPUTimerSet *set = &_sets[_current];
+    if(mark == VGL_GPU_MARK_BATCH
+        && (_mode != VGL_GPU_TIMERS_BATCHES || set->used >= VGL_GPU_TIMER_MAX_QUERIES - PASS_QUERY_RESERVE))
+        return;
+    if(set->used >= VGL_GPU_TIMER_MAX_QUERIES) return;
+
+    glQueryCounter(set->queries[set->used], GL_TIMESTAMP);
+    set->mark[set->used] = (unsigned char)mark;
+    set->pass[set->used] = (unsigned char)pass;
+    set->used++;
+#else
+    (void)mark;
+    (void)pass;
+#endif
+}
+
+int Vita_GetGPUTimings(VitaGPUTimings *timings)
+{
+    if(!_haveLatest) return 0;
+
+    if(timings != NULL) *timings = _latest;
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
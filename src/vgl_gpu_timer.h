@@ -0,0 +1,95 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_GPU_TIMER_H__
+#define __VGL_GPU_TIMER_H__
+
+#include <stdint.h>
+
+#include "vgl_profiler.h"
+
+/*
+    GPU timings from timestamp queries (ARB_timer_query).
+
+    Vita_Repaint writes a timestamp at the start of the frame, after the
+    texture uploads, around every pass and, with VGL_GPU_TIMERS_BATCHES,
+    after every batch. Each frame's timestamps use their own set of query
+    objects, one of VGL_GPU_TIMER_FRAMES, read back once the GPU has
+    reached the frame's last one. Results are only ever read when they're
+    ready, so measuring never stalls the CPU; they arrive a frame or more
+    after the frame they measure, and a set still not ready when its turn
+    comes around again is dropped.
+
+    Without timer queries (vitaGL, or a driver without the extension)
+    every call here does nothing and timings read as -1.
+*/
+
+// Vita_SetGPUTimers modes.
+#define VGL_GPU_TIMERS_OFF 0
+#define VGL_GPU_TIMERS_PASSES 1  // The frame, texture uploads & every pass. Default.
+#define VGL_GPU_TIMERS_BATCHES 2 // ...and every batch too.
+
+// Frames of query sets in flight.
+#define VGL_GPU_TIMER_FRAMES 4
+
+// Timestamps one frame can write. Batches past it aren't timed.
+#define VGL_GPU_TIMER_MAX_QUERIES 512
+
+// Batches one frame can report.
+#define VGL_GPU_TIMER_MAX_BATCHES (VGL_GPU_TIMER_MAX_QUERIES - 32)
+
+// Vita_GPUTimerMark points in a frame.
+#define VGL_GPU_MARK_FRAME 0    // Vita_Repaint starts. Also reads back finished frames.
+#define VGL_GPU_MARK_UPLOADED 1 // Texture uploads are done.
+#define VGL_GPU_MARK_PASS 2     // A pass starts.
+#define VGL_GPU_MARK_BATCH 3    // A batch was drawn. Only kept with VGL_GPU_TIMERS_BATCHES.
+#define VGL_GPU_MARK_PASS_END 4 // A pass is done.
+
+typedef struct _vita_gpu_timings
+{
+    uint32_t frame; // Vita_ProfilerFrame of the frame measured.
+    float frame_ms; // From the frame's start to its last pass's end.
+    float upload_ms;
+    float draw_ms; // Every pass.
+    float pass_ms[VGL_TIMING_MAX_PASSES]; // By pass slot, -1 for passes not drawn.
+
+    // In draw order, with VGL_GPU_TIMERS_BATCHES.
+    int batch_count;
+    float batch_ms[VGL_GPU_TIMER_MAX_BATCHES];
+} VitaGPUTimings;
+
+/**
+ * Vita_GPUTimersSupported():
+ *  returns 1 if the GPU can be timed. Valid once GL is initialized.
+ */
+int Vita_GPUTimersSupported();
+
+/**
+ * Vita_SetGPUTimers():
+ *  Picks what's timed on the GPU: VGL_GPU_TIMERS_OFF, _PASSES (default)
+ *  or _BATCHES. Batch timestamps cost a little GPU time each.
+ */
+void Vita_SetGPUTimers(int mode);
+
+/**
+ * Vita_GPUTimerMark():
+ *  Writes a VGL_GPU_MARK_* timestamp for pass slot `pass`.
+ *  Called by Vita_Repaint, GL thread only.
+ */
+void Vita_GPUTimerMark(int mark, int pass);
+
+/**
+ * Vita_GetGPUTimings():
+ *  Copies the latest frame read back to `timings`.
+ *
+ *  returns 1 if there is one, 0 if nothing was measured yet
+ *  (or timer queries aren't available).
+ */
+int Vita_GetGPUTimings(VitaGPUTimings *timings);
+
+#endif // __VGL_GPU_TIMER_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,216 @@
+#ifndef __VGL_KTX_H__
+#define __VGL_KTX_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+    KTX (version 1) texture container.
+
+    Used for textures that are already in GPU layout: block compressed
+    (see vgl_texture_compress.h) or plain RGBA8. Parsing never copies,
+    the parsed image points straight into the caller's buffer.
+
+    File layout (all little endian here, we don't write big endian files):
+        12 byte identifier
+        KTXHeader
+        key/value data (header.bytes_of_kv_data)
+            for every pair:
+                uint32 pair size
+                key\0value, padded to 4 bytes
+        for every mip level:
+            uint32 image size
+            image data, padded to 4 bytes
+*/
+
+#define VGL_KTX_MAX_LEVELS 16
+
+// Largest width or height accepted. Keeps every level's size, RGBA8
+// included (1 GB at most), in a 32 bit size_t like the Vita's.
+#define VGL_KTX_MAX_SIZE 16384
+
+// Key/value pair marking pixels as already premultiplied by alpha (value "1").
+#define VGL_KTX_KEY_PREMULTIPLIED "vgl.premultiplied"
+
+// The GL enums KTX files store for uncompressed RGBA8.
+#define VGL_KTX_UNSIGNED_BYTE 0x1401
+#define VGL_KTX_RGBA 0x1908
+#define VGL_KTX_RGBA8 0x8058
+
+static const unsigned char _vgl_ktx_identifier[12] =
+{
+    0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+typedef struct _ktx_header
+{
+    uint32_t endianness; // 0x04030201
+    uint32_t gl_type; // 0 for compressed formats.
+    uint32_t gl_type_size;
+    uint32_t gl_format; // 0 for compressed formats.
+    uint32_t gl_internal_format;
+    uint32_t gl_base_internal_format;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t array_elements;
+    uint32_t faces;
+    uint32_t mip_levels;
+    uint32_t bytes_of_kv_data;
+} __attribute__ ((packed)) KTXHeader;
+
+typedef struct _ktx_image
+{
+    uint32_t internal_format; // A VGL_COMPRESSED_* / VGL_ETC1_RGB8 format, or VGL_KTX_RGBA8.
+    int width;
+    int height;
+    int levels;
+    int premultiplied; // Colors are premultiplied by alpha. See VGL_KTX_KEY_PREMULTIPLIED.
+
+    const unsigned char *level_data[VGL_KTX_MAX_LEVELS];
+    uint32_t level_size[VGL_KTX_MAX_LEVELS];
+} KTXImage;
+
+/**
+ * Vita_IsKTX():
+ *  returns 1 if `data` starts with the KTX identifier.
+ */
+static inline int Vita_IsKTX(const void *data, size_t size)
+{
+    return size >= sizeof(_vgl_ktx_identifier)
+        && memcmp(data, _vgl_ktx_identifier, sizeof(_vgl_ktx_identifier)) == 0;
+}
+
+/**
+ * Vita_ParseKTX():
+ *  Parses a 2D KTX file held in `data`. The image's level pointers
+ *  point into `data`, which must outlive it.
+ *
+ *  returns 0 on success, -1 if the file is malformed, larger than
+ *  VGL_KTX_MAX_SIZE or isn't a single 2D image (arrays, cube maps
+ *  and 3D textures are rejected).
+ */
+static inline int Vita_ParseKTX(const void *data, size_t size, KTXImage *out)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    KTXHeader header;
+
+    if(!Vita_IsKTX(data, size) || size < sizeof(_vgl_ktx_identifier) + sizeof(KTXHeader))
+        return -1;
+
+    memcpy(&header, bytes + sizeof(_vgl_ktx_identifier), sizeof(KTXHeader));
+
+    if(header.endianness != 0x04030201
+        || header.pixel_width == 0 || header.pixel_height == 0
+        || header.pixel_width > VGL_KTX_MAX_SIZE || header.pixel_height > VGL_KTX_MAX_SIZE
+        || header.pixel_depth > 1 || header.array_elements > 0 || header.faces != 1)
+        return -1;
+
+    memset(out, 0, sizeof(KTXImage));
+    out->internal_format = header.gl_internal_format;
+    out->width = header.pixel_width;
+    out->height = header.pixel_height;
+    out->levels = header.mip_levels == 0 ? 1 : header.mip_levels;
+    if(out->levels > VGL_KTX_MAX_LEVELS) return -1;
+
+    size_t offset = sizeof(_vgl_ktx_identifier) + sizeof(KTXHeader);
+    if(header.bytes_of_kv_data > size - offset) return -1;
+
+    // Key/value pairs. The only one we care about is VGL_KTX_KEY_PREMULTIPLIED.
+    size_t kv_end = offset + header.bytes_of_kv_data;
+    while(offset + sizeof(uint32_t) <= kv_end)
+    {
+        uint32_t pair_size;
+        memcpy(&pair_size, bytes + offset, sizeof(pair_size));
+        offset += sizeof(pair_size);
+        if(pair_size > kv_end - offset) return -1;
+
+        const char *key = (const char *)bytes + offset;
+        size_t key_length = strnlen(key, pair_size);
+        if(key_length + 2 <= pair_size
+            && strcmp(key, VGL_KTX_KEY_PREMULTIPLIED) == 0)
+            out->premultiplied = key[key_length + 1] == '1';
+
+        offset += (pair_size + 3) & ~3u;
+    }
+    offset = kv_end;
+
+    for(int level = 0; level < out->levels; level++)
+    {
+        uint32_t image_size;
+        // Padding can take offset past the end.
+        if(offset > size || size - offset < sizeof(image_size)) return -1;
+
+        memcpy(&image_size, bytes + offset, sizeof(image_size));
+        offset += sizeof(image_size);
+
+        if(image_size > size - offset) return -1;
+
+        out->level_data[level] = bytes + offset;
+        out->level_size[level] = image_size;
+        offset += (image_size + 3) & ~3u;
+    }
+
+    return 0;
+}
+
+/**
+ * Vita_WriteKTX():
+ *  Writes `image` (levels from image->level_data) to `file`.
+ *  Compressed formats get gl_type/gl_format 0, VGL_KTX_RGBA8 gets RGBA/UNSIGNED_BYTE.
+ *  image->premultiplied is stored as a VGL_KTX_KEY_PREMULTIPLIED pair.
+ *
+ *  returns 0 on success.
+ */
+static inline int Vita_WriteKTX(FILE *file, const KTXImage *image)
+{
+    int rgba = image->internal_format == VGL_KTX_RGBA8;
+
+    KTXHeader header;
+    memset(&header, 0, sizeof(header));
+    header.endianness = 0x04030201;
+    header.gl_type = rgba ? VGL_KTX_UNSIGNED_BYTE : 0;
+    header.gl_type_size = 1;
+    header.gl_format = rgba ? VGL_KTX_RGBA : 0;
+    header.gl_internal_format = image->internal_format;
+    header.gl_base_internal_format = VGL_KTX_RGBA;
+    header.pixel_width = image->width;
+    header.pixel_height = image->height;
+    header.faces = 1;
+    header.mip_levels = image->levels;
+
+    // key\0value\0, the pair size counts both terminators.
+    const char kv_pair[] = VGL_KTX_KEY_PREMULTIPLIED "\0" "1";
+    uint32_t pair_size = sizeof(kv_pair);
+    size_t pair_pad = ((pair_size + 3) & ~3u) - pair_size;
+    if(image->premultiplied)
+        header.bytes_of_kv_data = sizeof(pair_size) + pair_size + pair_pad;
+
+    const unsigned char padding[3] = { 0, 0, 0 };
+
+    if(fwrite(_vgl_ktx_identifier, sizeof(_vgl_ktx_identifier), 1, file) != 1
+        || fwrite(&header, sizeof(header), 1, file) != 1)
+        return -1;
+
+    if(image->premultiplied
+        && (fwrite(&pair_size, sizeof(pair_size), 1, file) != 1
+            || fwrite(kv_pair, pair_size, 1, file) != 1
+            || (pair_pad > 0 && fwrite(padding, pair_pad, 1, file) != 1)))
+        return -1;
+
+    for(int level = 0; level < image->levels; level++)
+    {
+        uint32_t image_size = image->level_size[level];
+        size_t pad = ((image_size + 3) & ~3u) - image_size;
+
+        if(fwrite(&image_size, sizeof(image_size), 1, file) != 1
+            || fwrite(image->level_data[level], image_size, 1, file) != 1
+            || (pad > 0 && fwrite(padding, pad, 1, file) != 1))
+            return -1;
+    }
+
+    return 0;
+}
+
+#endif // __VGL_KTX_H__
@@ -0,0 +1,313 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VGL_MIPMAP_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VGL_MIPMAP_SSE2 1
+#endif
+
+#include "vgl_mipmap.h"
+#include "vgl_alloc.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Kaiser filter: 8 taps at source pixel offsets -3.5 .. 3.5 from the
+// destination pixel's center, a sinc for the 2x reduction windowed
+// over +-4 source pixels. Alpha (beta) 4 trades ringing for sharpness.
+#define KAISER_TAPS 8
+#define KAISER_RADIUS 4.0
+#define KAISER_BETA 4.0
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+// Modified Bessel function of the first kind, order 0. The series converges fast for our range.
+static double _Vita_BesselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for(int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if(term < sum * 1e-12) break;
+    }
+
+    return sum;
+}
+
+/**
+ * _Vita_KaiserWeights():
+ *  Normalized filter weights. Cheap enough to compute per level,
+ *  which keeps workers from sharing any state.
+ */
+static void _Vita_KaiserWeights(float weights[KAISER_TAPS])
+{
+    double raw[KAISER_TAPS];
+    double total = 0;
+
+    for(int i = 0; i < KAISER_TAPS; i++)
+    {
+        double t = (i - (KAISER_TAPS / 2)) + 0.5; // -3.5 .. 3.5 source pixels.
+        double x = t / 2.0; // In destination pixels.
+        double sinc = x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double r = t / KAISER_RADIUS;
+        double window = _Vita_BesselI0(KAISER_BETA * sqrt(1.0 - (r * r))) / _Vita_BesselI0(KAISER_BETA);
+
+        raw[i] = sinc * window;
+        total += raw[i];
+    }
+
+    for(int i = 0; i < KAISER_TAPS; i++)
+        weights[i] = (float)(raw[i] / total);
+}
+
+static inline int _Vita_ClampIndex(int i, int size)
+{
+    return i < 0 ? 0 : (i >= size ? size - 1 : i);
+}
+
+/**
+ * _Vita_BoxRow():
+ *  Averages two full source rows into one destination row of `dst_width`
+ *  pixels. Every destination pixel has its 2x2 footprint in bounds.
+ */
+static void _Vita_BoxRow(const unsigned char *row0, const unsigned char *row1, unsigned char *dst, int dst_width)
+{
+    int x = 0;
+
+#if defined(VGL_MIPMAP_NEON)
+    // 2 destination pixels (4 source pixels per row) per iteration.
+    for(; x + 2 <= dst_width; x += 2)
+    {
+        uint8x16_t r0 = vld1q_u8(row0 + (x * 8));
+        uint8x16_t r1 = vld1q_u8(row1 + (x * 8));
+
+        uint16x8_t lo = vaddl_u8(vget_low_u8(r0), vget_low_u8(r1)); // Source pixels 0 & 1, both rows.
+        uint16x8_t hi = vaddl_u8(vget_high_u8(r0), vget_high_u8(r1)); // Source pixels 2 & 3.
+
+        uint16x4_t a = vadd_u16(vget_low_u16(lo), vget_high_u16(lo));
+        uint16x4_t b = vadd_u16(vget_low_u16(hi), vget_high_u16(hi));
+
+        vst1_u8(dst + (x * 4), vrshrn_n_u16(vcombine_u16(a, b), 2)); // (sum + 2) >> 2
+    }
+#elif defined(VGL_MIPMAP_SSE2)
+    // 4 destination pixels (8 source pixels per row) per iteration.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+
+    for(; x + 4 <= dst_width; x += 4)
+    {
+        __m128i out[2];
+        for(int half = 0; half < 2; half++)
+        {
+            __m128i r0 = _mm_loadu_si128((const __m128i *)(row0 + (x * 8) + (half * 16)));
+            __m128i r1 = _mm_loadu_si128((const __m128i *)(row1 + (x * 8) + (half * 16)));
+
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero)); // Source pixels 0 & 1.
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero)); // Source pixels 2 & 3.
+
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+            out[half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), two), 2);
+        }
+
+        _mm_storeu_si128((__m128i *)(dst + (x * 4)), _mm_packus_epi16(out[0], out[1]));
+    }
+#endif
+
+    for(; x < dst_width; x++)
+    {
+        const unsigned char *a = row0 + (x * 8), *b = row1 + (x * 8);
+        for(int c = 0; c < 4; c++)
+            dst[(x * 4) + c] = (unsigned char)((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+    }
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_MipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while(width > 1 || height > 1)
+    {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        levels++;
+    }
+
+    return levels;
+}
+
+void Vita_MipLevelDimensions(int width, int height, int level, int *level_width, int *level_height)
+{
+    *level_width = width >> level;
+    *level_height = height >> level;
+    if(*level_width < 1) *level_width = 1;
+    if(*level_height < 1) *level_height = 1;
+}
+
+size_t Vita_MipChainSize(int width, int height, int levels)
+{
+    size_t size = 0;
+    for(int level = 1; level < levels; level++)
+    {
+        int w, h;
+        Vita_MipLevelDimensions(width, height, level, &w, &h);
+        size += (size_t)w * h * 4;
+    }
+
+    return size;
+}
+
+void Vita_DownsampleBox(const unsigned char *src, int width, int height, unsigned char *dst)
+{
+    int dst_width = width > 1 ? width / 2 : 1;
+    int dst_height = height > 1 ? height / 2 : 1;
+    size_t src_stride = (size_t)width * 4;
+
+    if(width >= 2 && height >= 2)
+    {
+        for(int y = 0; y < dst_height; y++)
+        {
+            const unsigned char *row0 = src + (src_stride * (y * 2));
+            _Vita_BoxRow(row0, row0 + src_stride, dst + ((size_t)y * dst_width * 4), dst_width);
+        }
+        return;
+    }
+
+    // A 1 pixel wide or tall image only halves along the other axis.
+    for(int y = 0; y < dst_height; y++)
+    {
+        int y0 = _Vita_ClampIndex(y * 2, height), y1 = _Vita_ClampIndex((y * 2) + 1, height);
+        for(int x = 0; x < dst_width; x++)
+        {
+            int x0 = _Vita_ClampIndex(x * 2, width), x1 = _Vita_ClampIndex((x * 2) + 1, width);
+            for(int c = 0; c < 4; c++)
+            {
+                int sum = src[(src_stride * y0) + (x0 * 4) + c] + src[(src_stride * y0) + (x1 * 4) + c]
+                        + src[(src_stride * y1) + (x0 * 4) + c] + src[(src_stride * y1) + (x1 * 4) + c];
+                dst[(((size_t)y * dst_width) + x) * 4 + c] = (unsigned char)((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+int Vita_DownsampleKaiser(const unsigned char *src, int width, int height, unsigned char *dst)
+{
+    float weights[KAISER_TAPS];
+    _Vita_KaiserWeights(weights);
+
+    int dst_width = width > 1 ? width / 2 : 1;
+    int dst_height = height > 1 ? height / 2 : 1;
+    size_t dst_row = (size_t)dst_width * 4;
+
+    // Horizontal pass into floats, then vertical straight into `dst`.
+    // An axis that's already 1 pixel is passed through.
+    float *temp = (float *)VGL_MALLOC(sizeof(float) * ((size_t)height + 1) * dst_row);
+    if(temp == NULL) return -1;
+    float *accum = temp + ((size_t)height * dst_row); // One row for the vertical pass.
+
+    for(int y = 0; y < height; y++)
+    {
+        const unsigned char *row = src + ((size_t)y * width * 4);
+        float *out = temp + ((size_t)y * dst_row);
+
+        for(int x = 0; x < dst_width; x++)
+        {
+            float sum[4] = { 0, 0, 0, 0 };
+            int first = (x * 2) - 3;
+
+            if(width == 1)
+            {
+                for(int c = 0; c < 4; c++) sum[c] = row[c];
+            }
+            else if(first >= 0 && first + KAISER_TAPS <= width)
+            {
+                const unsigned char *p = row + (first * 4);
+                for(int t = 0; t < KAISER_TAPS; t++, p += 4)
+                {
+                    for(int c = 0; c < 4; c++) sum[c] += p[c] * weights[t];
+                }
+            }
+            else
+            {
+                // Near the edges the last pixel is repeated.
+                for(int t = 0; t < KAISER_TAPS; t++)
+                {
+                    const unsigned char *p = row + (_Vita_ClampIndex(first + t, width) * 4);
+                    for(int c = 0; c < 4; c++) sum[c] += p[c] * weights[t];
+                }
+            }
+
+            memcpy(out + (x * 4), sum, sizeof(sum));
+        }
+    }
+
+    for(int y = 0; y < dst_height; y++)
+    {
+        if(height == 1) memcpy(accum, temp, sizeof(float) * dst_row);
+        else
+        {
+            // Whole rows at a time: the inner loop runs over contiguous floats.
+            memset(accum, 0, sizeof(float) * dst_row);
+            for(int t = 0; t < KAISER_TAPS; t++)
+            {
+                const float *in = temp + ((size_t)_Vita_ClampIndex((y * 2) + t - 3, height) * dst_row);
+                float weight = weights[t];
+                for(size_t x = 0; x < dst_row; x++) accum[x] += in[x] * weight;
+            }
+        }
+
+        // The sinc's negative lobes can overshoot.
+        unsigned char *out = dst + ((size_t)y * dst_row);
+        for(size_t x = 0; x < dst_row; x++)
+        {
+            int v = (int)(accum[x] + 0.5f);
+            out[x] = (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+
+    free(temp);
+    return 0;
+}
+
+int Vita_GenerateMipChain(int filter, const unsigned char *rgba, int width, int height, unsigned char *out, int max_levels)
+{
+    if(filter != VGL_MIPMAP_BOX && filter != VGL_MIPMAP_KAISER) return 0;
+
+    int levels = Vita_MipLevelCount(width, height);
+    if(levels > max_levels) levels = max_levels;
+
+    const unsigned char *src = rgba;
+    unsigned char *dst = out;
+
+    for(int level = 1; level < levels; level++)
+    {
+        int src_width, src_height, dst_width, dst_height;
+        Vita_MipLevelDimensions(width, height, level - 1, &src_width, &src_height);
+        Vita_MipLevelDimensions(width, height, level, &dst_width, &dst_height);
+
+        // Box is also the fallback when Kaiser can't get its buffer.
+        if(filter != VGL_MIPMAP_KAISER || Vita_DownsampleKaiser(src, src_width, src_height, dst) != 0)
+            Vita_DownsampleBox(src, src_width, src_height, dst);
+
+        src = dst;
+        dst += (size_t)dst_width * dst_height * 4;
+    }
+
+    return levels;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_MIPMAP_H__
+#define __VGL_MIPMAP_H__
+
+#include <stddef.h>
+
+/*
+    CPU mip chain generation for RGBA8 images.
+
+    Done on the CPU so every backend gets the same chain, including
+    ones without glGenerateMipmap. Each level halves the previous one
+    (rounding down, never below 1) until 1x1.
+
+        VGL_MIPMAP_BOX:    2x2 average. SSE2 / NEON where available.
+        VGL_MIPMAP_KAISER: 8 tap Kaiser windowed sinc. Sharper, keeps
+                           small details from smearing, but an order of
+                           magnitude slower: meant for loader workers.
+
+    Filtering is done on the stored values: premultiplied images
+    (VGL_SHADER_PREMULTIPLIED) filter correctly, straight alpha images
+    can pick up a dark fringe around transparent edges.
+*/
+
+#define VGL_MIPMAP_NONE 0
+#define VGL_MIPMAP_BOX 1
+#define VGL_MIPMAP_KAISER 2
+
+/**
+ * Vita_MipLevelCount():
+ *  returns the number of levels in a full chain, base level included.
+ */
+int Vita_MipLevelCount(int width, int height);
+
+/**
+ * Vita_MipLevelDimensions():
+ *  Size of `level` of a `width` x `height` image.
+ */
+void Vita_MipLevelDimensions(int width, int height, int level, int *level_width, int *level_height);
+
+/**
+ * Vita_MipChainSize():
+ *  returns the bytes levels 1 to `levels` - 1 take as RGBA8,
+ *  i.e. what Vita_GenerateMipChain writes.
+ */
+size_t Vita_MipChainSize(int width, int height, int levels);
+
+/**
+ * Vita_DownsampleBox():
+ *  Writes the next level of `src` to `dst`.
+ */
+void Vita_DownsampleBox(const unsigned char *src, int width, int height, unsigned char *dst);
+
+/**
+ * Vita_DownsampleKaiser():
+ *  Same as Vita_DownsampleBox, with the Kaiser filter.
+ *  returns -1 if it couldn't allocate its temporary buffer.
+ */
+int Vita_DownsampleKaiser(const unsigned char *src, int width, int height, unsigned char *dst);
+
+/**
+ * Vita_GenerateMipChain():
+ *  Writes levels 1 and up of `rgba` back to back into `out`, which must
+ *  hold Vita_MipChainSize(width, height, levels) bytes. Stops after
+ *  `max_levels` levels (base level included) or at 1x1.
+ *
+ *  returns the number of levels, base level included,
+ *  or 0 if `filter` isn't a VGL_MIPMAP_* filter.
+ */
+int Vita_GenerateMipChain(int filter, const unsigned char *rgba, int width, int height, unsigned char *out, int max_levels);
+
+#endif // __VGL_MIPMAP_H__
+
+#ifdef __cplusplus
+}
+#endif
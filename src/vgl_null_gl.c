@@ -0,0 +1,780 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_null_gl.h"
+#include "vgl_profiler.h"
+
+// Texture units & mip levels tracked.
+#define MAX_TEXTURE_UNITS 8
+#define MAX_LEVELS 16
+
+// Distinct attribute / uniform names handed locations. Attributes stay
+// under 32, the renderer keeps them in a bitmask.
+#define MAX_ATTRIBS 16
+#define MAX_UNIFORMS 64
+
+// Recorded calls are allocated this many at a time.
+#define COMMANDS_GROW 4096
+
+typedef struct _null_texture
+{
+    char live;
+    size_t level_bytes[MAX_LEVELS];
+} NullTexture;
+
+typedef struct _null_buffer
+{
+    char live;
+    size_t size;
+    unsigned char *storage; // Only once it's been mapped.
+    size_t map_length;
+} NullBuffer;
+
+// Buffer binding points tracked, see _Vita_NullTarget.
+#define TARGET_ARRAY 0
+#define TARGET_ELEMENT_ARRAY 1
+#define TARGET_PIXEL_UNPACK 2
+#define TARGET_OTHER 3
+#define TARGET_COUNT 4
+
+unsigned int _vgl_null_extensions = VGL_NULL_EXT_ALL;
+
+static VitaNullGLStats _stats;
+
+static const char *_callNames[VGL_NULL_GL_CALL_COUNT] = {
+#define _VGL_NULL_GL_CALL_NAME(name) "gl" #name,
+    VGL_NULL_GL_CALLS(_VGL_NULL_GL_CALL_NAME)
+#undef _VGL_NULL_GL_CALL_NAME
+};
+
+static char _recording = 0;
+static VitaNullGLCommand *_commands;
+static size_t _commandCount = 0, _commandCapacity = 0;
+
+// Objects, indexed by name. Names are never reused.
+static NullTexture *_textures;
+static GLuint _textureCapacity = 0, _nextTexture = 1;
+
+static NullBuffer *_buffers;
+static GLuint _bufferCapacity = 0, _nextBuffer = 1;
+
+static GLuint64 *_queries;
+static GLuint _queryCapacity = 0, _nextQuery = 1;
+
+// Shaders & programs share a namespace, as in GL.
+static GLuint _nextObject = 1;
+static uintptr_t _nextSync = 1;
+static char _fencesHeld = 0; // See Vita_NullGLHoldFences.
+
+static GLuint _boundTextures[MAX_TEXTURE_UNITS];
+static GLuint _activeUnit = 0;
+static GLuint _boundBuffers[TARGET_COUNT];
+
+static const char *_attribNames[MAX_ATTRIBS];
+static const char *_uniformNames[MAX_UNIFORMS];
+static int _attribCount = 0, _uniformCount = 0;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_NullCall():
+ *  Counts a call & records it if recording.
+ */
+static void _Vita_NullCall(int call, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, size_t bytes)
+{
+    _stats.calls[call]++;
+    _stats.total_calls++;
+
+    if(!_recording) return;
+
+    if(_commandCount == _commandCapacity)
+    {
+        VitaNullGLCommand *grown = (VitaNullGLCommand *)realloc(_commands, sizeof(VitaNullGLCommand) * (_commandCapacity + COMMANDS_GROW));
+        if(grown == NULL) return;
+
+        _commands = grown;
+        _commandCapacity += COMMANDS_GROW;
+    }
+
+    VitaNullGLCommand *command = &_commands[_commandCount++];
+    command->call = (uint16_t)call;
+    command->args[0] = a0;
+    command->args[1] = a1;
+    command->args[2] = a2;
+    command->args[3] = a3;
+    command->bytes = (uint32_t)bytes;
+}
+
+#define NULL_CALL(name, a0, a1, a2, a3, bytes) \
+    _Vita_NullCall(VGL_NULL_GL_##name, (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3), (bytes))
+
+/**
+ * _Vita_NullGrow():
+ *  Makes room for index `name` in a table of `size` byte entries,
+ *  zeroing the new ones. returns 0 on success.
+ */
+static int _Vita_NullGrow(void **table, GLuint *capacity, GLuint name, size_t size)
+{
+    if(name < *capacity) return 0;
+
+    GLuint grown = *capacity > 0 ? *capacity : 64;
+    while(grown <= name) grown *= 2;
+
+    void *entries = realloc(*table, size * grown);
+    if(entries == NULL) return -1;
+
+    memset((char *)entries + size * (*capacity), 0, size * (grown - *capacity));
+    *table = entries;
+    *capacity = grown;
+    return 0;
+}
+
+static inline void _Vita_NullTrack(size_t *bytes, size_t *peak, size_t old_size, size_t new_size)
+{
+    *bytes = *bytes - old_size + new_size;
+    if(*bytes > *peak) *peak = *bytes;
+}
+
+static inline int _Vita_NullTarget(GLenum target)
+{
+    switch(target)
+    {
+        case GL_ARRAY_BUFFER: return TARGET_ARRAY;
+        case GL_ELEMENT_ARRAY_BUFFER: return TARGET_ELEMENT_ARRAY;
+        case GL_PIXEL_UNPACK_BUFFER: return TARGET_PIXEL_UNPACK;
+        default: return TARGET_OTHER;
+    }
+}
+
+static inline NullBuffer *_Vita_NullBoundBuffer(GLenum target)
+{
+    GLuint name = _boundBuffers[_Vita_NullTarget(target)];
+    return (name != 0 && name < _bufferCapacity && _buffers[name].live) ? &_buffers[name] : NULL;
+}
+
+static inline NullTexture *_Vita_NullBoundTexture()
+{
+    GLuint name = _boundTextures[_activeUnit];
+    return (name != 0 && name < _textureCapacity && _textures[name].live) ? &_textures[name] : NULL;
+}
+
+/**
+ * _Vita_NullPixelBytes():
+ *  returns the size of `width` x `height` texels of `format` & `type`.
+ */
+static size_t _Vita_NullPixelBytes(GLenum format, GLenum type, GLsizei width, GLsizei height)
+{
+    if(width <= 0 || height <= 0) return 0;
+
+    size_t texel;
+    switch(type)
+    {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            texel = 2;
+            break;
+        default:
+            switch(format)
+            {
+                case GL_RGBA: texel = 4; break;
+                case GL_RGB: texel = 3; break;
+                case GL_LUMINANCE_ALPHA: texel = 2; break;
+                default: texel = 1; break; // GL_LUMINANCE, GL_ALPHA, GL_RED
+            }
+            break;
+    }
+
+    return texel * (size_t)width * (size_t)height;
+}
+
+static void _Vita_NullSetLevel(GLint level, size_t bytes)
+{
+    NullTexture *texture = _Vita_NullBoundTexture();
+    if(texture == NULL || level < 0 || level >= MAX_LEVELS) return;
+
+    _Vita_NullTrack(&_stats.texture_bytes, &_stats.texture_bytes_peak, texture->level_bytes[level], bytes);
+    texture->level_bytes[level] = bytes;
+}
+
+/**
+ * _Vita_NullLocation():
+ *  returns the location `name` gets in every program, handing out
+ *  the next one the first time it's asked for. -1 once `names` is full.
+ */
+static GLint _Vita_NullLocation(const char **names, int *count, int max, const GLchar *name)
+{
+    for(int i = 0; i < *count; i++)
+    {
+        if(strcmp(names[i], name) == 0) return i;
+    }
+
+    if(*count == max) return -1;
+
+    char *copy = strdup(name);
+    if(copy == NULL) return -1;
+
+    names[*count] = copy;
+    return (*count)++;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+void Vita_NullGLSetExtensions(unsigned int extensions)
+{
+    _vgl_null_extensions = extensions;
+}
+
+void Vita_NullGLGetStats(VitaNullGLStats *stats)
+{
+    if(stats != NULL) *stats = _stats;
+}
+
+void Vita_NullGLResetCounters()
+{
+    memset(_stats.calls, 0, sizeof(_stats.calls));
+    _stats.total_calls = 0;
+    _stats.indices_drawn = 0;
+    _stats.buffer_upload_bytes = 0;
+    _stats.texture_upload_bytes = 0;
+    _stats.swaps = 0;
+
+    _stats.buffer_bytes_peak = _stats.buffer_bytes;
+    _stats.texture_bytes_peak = _stats.texture_bytes;
+}
+
+void Vita_NullGLSetRecording(int enabled)
+{
+    _recording = enabled != 0;
+}
+
+void Vita_NullGLHoldFences(int held)
+{
+    _fencesHeld = held != 0;
+}
+
+const VitaNullGLCommand *Vita_NullGLCommands(size_t *count)
+{
+    if(count != NULL) *count = _commandCount;
+    return _commands;
+}
+
+void Vita_NullGLClearCommands()
+{
+    _commandCount = 0;
+}
+
+const char *Vita_NullGLCallName(int call)
+{
+    return (call >= 0 && call < VGL_NULL_GL_CALL_COUNT) ? _callNames[call] : "?";
+}
+
+void Vita_NullGLSwapBuffers()
+{
+    _stats.swaps++;
+}
+
+// ------------------------------------------   GL
+
+void glActiveTexture(GLenum texture)
+{
+    NULL_CALL(ActiveTexture, texture, 0, 0, 0, 0);
+
+    GLuint unit = texture - GL_TEXTURE0;
+    if(unit < MAX_TEXTURE_UNITS) _activeUnit = unit;
+}
+
+void glAttachShader(GLuint program, GLuint shader)
+{
+    NULL_CALL(AttachShader, program, shader, 0, 0, 0);
+}
+
+void glBindBuffer(GLenum target, GLuint buffer)
+{
+    NULL_CALL(BindBuffer, target, buffer, 0, 0, 0);
+    _boundBuffers[_Vita_NullTarget(target)] = buffer;
+}
+
+void glBindTexture(GLenum target, GLuint texture)
+{
+    NULL_CALL(BindTexture, target, texture, 0, 0, 0);
+    _boundTextures[_activeUnit] = texture;
+}
+
+void glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    NULL_CALL(BlendFunc, sfactor, dfactor, 0, 0, 0);
+}
+
+void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    size_t bytes = data != NULL ? (size_t)size : 0;
+    NULL_CALL(BufferData, target, size, usage, 0, bytes);
+    _stats.buffer_upload_bytes += bytes;
+
+    NullBuffer *buffer = _Vita_NullBoundBuffer(target);
+    if(buffer == NULL) return;
+
+    _Vita_NullTrack(&_stats.buffer_bytes, &_stats.buffer_bytes_peak, buffer->size, (size_t)size);
+    buffer->size = (size_t)size;
+
+    // Storage is only kept for mapping, so it's dropped rather than resized.
+    free(buffer->storage);
+    buffer->storage = NULL;
+}
+
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    (void)data;
+    NULL_CALL(BufferSubData, target, offset, size, 0, (size_t)size);
+    _stats.buffer_upload_bytes += (size_t)size;
+}
+
+void glClear(GLbitfield mask)
+{
+    NULL_CALL(Clear, mask, 0, 0, 0, 0);
+}
+
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    (void)red;
+    (void)green;
+    (void)blue;
+    (void)alpha;
+    NULL_CALL(ClearColor, 0, 0, 0, 0, 0);
+}
+
+GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    (void)timeout;
+    NULL_CALL(ClientWaitSync, (uintptr_t)sync, flags, 0, 0, 0);
+    return _fencesHeld ? GL_TIMEOUT_EXPIRED : GL_ALREADY_SIGNALED;
+}
+
+void glCompileShader(GLuint shader)
+{
+    NULL_CALL(CompileShader, shader, 0, 0, 0, 0);
+}
+
+void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data)
+{
+    (void)target;
+    (void)border;
+    (void)data;
+    NULL_CALL(CompressedTexImage2D, level, internalformat, width, height, (size_t)imageSize);
+    _stats.texture_upload_bytes += (size_t)imageSize;
+    _Vita_NullSetLevel(level, (size_t)imageSize);
+}
+
+GLuint glCreateProgram(void)
+{
+    GLuint program = _nextObject++;
+    NULL_CALL(CreateProgram, program, 0, 0, 0, 0);
+    _stats.programs++;
+    return program;
+}
+
+GLuint glCreateShader(GLenum type)
+{
+    GLuint shader = _nextObject++;
+    NULL_CALL(CreateShader, type, shader, 0, 0, 0);
+    _stats.shaders++;
+    return shader;
+}
+
+void glDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    NULL_CALL(DeleteBuffers, n, n > 0 ? buffers[0] : 0, 0, 0, 0);
+
+    for(GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = buffers[i];
+        if(name == 0 || name >= _bufferCapacity || !_buffers[name].live) continue;
+
+        _Vita_NullTrack(&_stats.buffer_bytes, &_stats.buffer_bytes_peak, _buffers[name].size, 0);
+        free(_buffers[name].storage);
+        memset(&_buffers[name], 0, sizeof(NullBuffer));
+        _stats.buffers--;
+
+        for(int t = 0; t < TARGET_COUNT; t++)
+        {
+            if(_boundBuffers[t] == name) _boundBuffers[t] = 0;
+        }
+    }
+}
+
+void glDeleteProgram(GLuint program)
+{
+    NULL_CALL(DeleteProgram, program, 0, 0, 0, 0);
+    if(program != 0) _stats.programs--;
+}
+
+void glDeleteQueries(GLsizei n, const GLuint *ids)
+{
+    NULL_CALL(DeleteQueries, n, n > 0 ? ids[0] : 0, 0, 0, 0);
+    _stats.queries -= n;
+}
+
+void glDeleteShader(GLuint shader)
+{
+    NULL_CALL(DeleteShader, shader, 0, 0, 0, 0);
+    if(shader != 0) _stats.shaders--;
+}
+
+void glDeleteSync(GLsync sync)
+{
+    NULL_CALL(DeleteSync, (uintptr_t)sync, 0, 0, 0, 0);
+}
+
+void glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+    NULL_CALL(DeleteTextures, n, n > 0 ? textures[0] : 0, 0, 0, 0);
+
+    for(GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = textures[i];
+        if(name == 0 || name >= _textureCapacity || !_textures[name].live) continue;
+
+        for(int level = 0; level < MAX_LEVELS; level++)
+            _Vita_NullTrack(&_stats.texture_bytes, &_stats.texture_bytes_peak, _textures[name].level_bytes[level], 0);
+        memset(&_textures[name], 0, sizeof(NullTexture));
+        _stats.textures--;
+
+        for(int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+        {
+            if(_boundTextures[unit] == name) _boundTextures[unit] = 0;
+        }
+    }
+}
+
+void glDepthFunc(GLenum func)
+{
+    NULL_CALL(DepthFunc, func, 0, 0, 0, 0);
+}
+
+void glDepthMask(GLboolean flag)
+{
+    NULL_CALL(DepthMask, flag, 0, 0, 0, 0);
+}
+
+void glDisable(GLenum cap)
+{
+    NULL_CALL(Disable, cap, 0, 0, 0, 0);
+}
+
+void glDisableVertexAttribArray(GLuint index)
+{
+    NULL_CALL(DisableVertexAttribArray, index, 0, 0, 0, 0);
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices)
+{
+    NULL_CALL(DrawElements, mode, count, type, (uintptr_t)indices, 0);
+    _stats.indices_drawn += (unsigned long long)count;
+}
+
+void glEnable(GLenum cap)
+{
+    NULL_CALL(Enable, cap, 0, 0, 0, 0);
+}
+
+void glEnableVertexAttribArray(GLuint index)
+{
+    NULL_CALL(EnableVertexAttribArray, index, 0, 0, 0, 0);
+}
+
+GLsync glFenceSync(GLenum condition, GLbitfield flags)
+{
+    GLsync sync = (GLsync)_nextSync++;
+    NULL_CALL(FenceSync, condition, flags, (uintptr_t)sync, 0, 0);
+    return sync;
+}
+
+void glGenBuffers(GLsizei n, GLuint *buffers)
+{
+    for(GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = _nextBuffer;
+        buffers[i] = 0;
+        if(_Vita_NullGrow((void **)&_buffers, &_bufferCapacity, name, sizeof(NullBuffer)) != 0) continue;
+
+        _nextBuffer++;
+        _buffers[name].live = 1;
+        buffers[i] = name;
+        _stats.buffers++;
+    }
+
+    NULL_CALL(GenBuffers, n, n > 0 ? buffers[0] : 0, 0, 0, 0);
+}
+
+void glGenQueries(GLsizei n, GLuint *ids)
+{
+    for(GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = _nextQuery;
+        ids[i] = 0;
+        if(_Vita_NullGrow((void **)&_queries, &_queryCapacity, name, sizeof(GLuint64)) != 0) continue;
+
+        _nextQuery++;
+        ids[i] = name;
+        _stats.queries++;
+    }
+
+    NULL_CALL(GenQueries, n, n > 0 ? ids[0] : 0, 0, 0, 0);
+}
+
+void glGenTextures(GLsizei n, GLuint *textures)
+{
+    for(GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = _nextTexture;
+        textures[i] = 0;
+        if(_Vita_NullGrow((void **)&_textures, &_textureCapacity, name, sizeof(NullTexture)) != 0) continue;
+
+        _nextTexture++;
+        _textures[name].live = 1;
+        textures[i] = name;
+        _stats.textures++;
+    }
+
+    NULL_CALL(GenTextures, n, n > 0 ? textures[0] : 0, 0, 0, 0);
+}
+
+GLint glGetAttribLocation(GLuint program, const GLchar *name)
+{
+    NULL_CALL(GetAttribLocation, program, 0, 0, 0, 0);
+    return _Vita_NullLocation(_attribNames, &_attribCount, MAX_ATTRIBS, name);
+}
+
+GLenum glGetError(void)
+{
+    NULL_CALL(GetError, 0, 0, 0, 0, 0);
+    return GL_NO_ERROR;
+}
+
+void glGetIntegerv(GLenum pname, GLint *params)
+{
+    NULL_CALL(GetIntegerv, pname, 0, 0, 0, 0);
+
+    switch(pname)
+    {
+        case GL_MAX_TEXTURE_SIZE:
+            *params = 4096;
+            break;
+        default: // No compressed formats, no program binary formats...
+            *params = 0;
+            break;
+    }
+}
+
+void glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary)
+{
+    (void)bufSize;
+    (void)binaryFormat;
+    (void)binary;
+    NULL_CALL(GetProgramBinary, program, 0, 0, 0, 0);
+    if(length != NULL) *length = 0;
+}
+
+void glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+    NULL_CALL(GetProgramInfoLog, program, 0, 0, 0, 0);
+    if(length != NULL) *length = 0;
+    if(infoLog != NULL && bufSize > 0) infoLog[0] = '\0';
+}
+
+void glGetProgramiv(GLuint program, GLenum pname, GLint *params)
+{
+    NULL_CALL(GetProgramiv, program, pname, 0, 0, 0);
+    *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+
+void glGetQueryObjectiv(GLuint id, GLenum pname, GLint *params)
+{
+    NULL_CALL(GetQueryObjectiv, id, pname, 0, 0, 0);
+    *params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params)
+{
+    NULL_CALL(GetQueryObjectui64v, id, pname, 0, 0, 0);
+    *params = (id < _queryCapacity) ? _queries[id] : 0;
+}
+
+void glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+    NULL_CALL(GetShaderInfoLog, shader, 0, 0, 0, 0);
+    if(length != NULL) *length = 0;
+    if(infoLog != NULL && bufSize > 0) infoLog[0] = '\0';
+}
+
+void glGetShaderiv(GLuint shader, GLenum pname, GLint *params)
+{
+    NULL_CALL(GetShaderiv, shader, pname, 0, 0, 0);
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+const GLubyte *glGetString(GLenum name)
+{
+    NULL_CALL(GetString, name, 0, 0, 0, 0);
+
+    switch(name)
+    {
+        case GL_VENDOR: return (const GLubyte *)"vgl";
+        case GL_RENDERER: return (const GLubyte *)"vgl null backend";
+        case GL_VERSION: return (const GLubyte *)"2.1 vgl null backend";
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte *)"1.20";
+        default: return (const GLubyte *)"";
+    }
+}
+
+GLint glGetUniformLocation(GLuint program, const GLchar *name)
+{
+    NULL_CALL(GetUniformLocation, program, 0, 0, 0, 0);
+    return _Vita_NullLocation(_uniformNames, &_uniformCount, MAX_UNIFORMS, name);
+}
+
+void glLinkProgram(GLuint program)
+{
+    NULL_CALL(LinkProgram, program, 0, 0, 0, 0);
+}
+
+void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    NULL_CALL(MapBufferRange, target, offset, length, access, 0);
+
+    NullBuffer *buffer = _Vita_NullBoundBuffer(target);
+    if(buffer == NULL || offset < 0 || (size_t)(offset + length) > buffer->size) return NULL;
+
+    if(buffer->storage == NULL)
+    {
+        buffer->storage = (unsigned char *)malloc(buffer->size);
+        if(buffer->storage == NULL) return NULL;
+    }
+
+    buffer->map_length = (size_t)length;
+    return buffer->storage + offset;
+}
+
+void glPixelStorei(GLenum pname, GLint param)
+{
+    NULL_CALL(PixelStorei, pname, param, 0, 0, 0);
+}
+
+void glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length)
+{
+    (void)binary;
+    NULL_CALL(ProgramBinary, program, binaryFormat, length, 0, (size_t)length);
+}
+
+void glProgramParameteri(GLuint program, GLenum pname, GLint value)
+{
+    NULL_CALL(ProgramParameteri, program, pname, value, 0, 0);
+}
+
+void glQueryCounter(GLuint id, GLenum target)
+{
+    NULL_CALL(QueryCounter, id, target, 0, 0, 0);
+
+    // There's no GPU, so it's "reached" as soon as it's written.
+    if(id < _queryCapacity) _queries[id] = Vita_ProfilerNow();
+}
+
+void glShaderSource(GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length)
+{
+    (void)string;
+    (void)length;
+    NULL_CALL(ShaderSource, shader, count, 0, 0, 0);
+}
+
+void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    (void)target;
+    (void)border;
+
+    size_t bytes = _Vita_NullPixelBytes(format, type, width, height);
+    size_t uploaded = (pixels != NULL || _boundBuffers[TARGET_PIXEL_UNPACK] != 0) ? bytes : 0;
+    NULL_CALL(TexImage2D, level, internalFormat, width, height, uploaded);
+    _stats.texture_upload_bytes += uploaded;
+
+    _Vita_NullSetLevel(level, bytes);
+}
+
+void glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    NULL_CALL(TexParameteri, target, pname, param, 0, 0);
+}
+
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    (void)target;
+    (void)xoffset;
+    (void)pixels;
+
+    size_t bytes = _Vita_NullPixelBytes(format, type, width, height);
+    NULL_CALL(TexSubImage2D, level, yoffset, width, height, bytes);
+    _stats.texture_upload_bytes += bytes;
+}
+
+void glUniform1f(GLint location, GLfloat v0)
+{
+    (void)v0;
+    NULL_CALL(Uniform1f, location, 0, 0, 0, 0);
+}
+
+void glUniform1i(GLint location, GLint v0)
+{
+    NULL_CALL(Uniform1i, location, v0, 0, 0, 0);
+}
+
+void glUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    (void)v0;
+    (void)v1;
+    NULL_CALL(Uniform2f, location, 0, 0, 0, 0);
+}
+
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    (void)value;
+    NULL_CALL(UniformMatrix4fv, location, count, transpose, 0, 0);
+}
+
+GLboolean glUnmapBuffer(GLenum target)
+{
+    NullBuffer *buffer = _Vita_NullBoundBuffer(target);
+    size_t bytes = buffer != NULL ? buffer->map_length : 0;
+
+    NULL_CALL(UnmapBuffer, target, 0, 0, 0, bytes);
+    _stats.buffer_upload_bytes += bytes;
+
+    if(buffer != NULL) buffer->map_length = 0;
+    return GL_TRUE;
+}
+
+void glUseProgram(GLuint program)
+{
+    NULL_CALL(UseProgram, program, 0, 0, 0, 0);
+}
+
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+    (void)normalized;
+    NULL_CALL(VertexAttribPointer, index, size, type, stride, 0);
+    (void)pointer;
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    NULL_CALL(Viewport, x, y, width, height, 0);
+}
+
+// ------------------------------------------   END GL
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_NULL_GL_H__
+#define __VGL_NULL_GL_H__
+
+/*
+    Null GL backend (cmake -DVGL_NULL_BACKEND=ON).
+
+    Builds the renderer without a window or a GPU: instead of linking
+    GLFW, GLEW & libGL, vgl_null_gl.c implements every GL call the renderer
+    makes. Nothing is drawn. Each call is counted, the bytes given to
+    buffers & textures are totalled, and the memory buffers & textures
+    would hold on the GPU is tracked, so submission, batching & uploads
+    can be benchmarked & regression tested on a headless box.
+
+    Calls can also be recorded, in order, with their integer arguments,
+    to compare the command stream a scene produces against a known one.
+
+    Extensions are simulated well enough for the code using them to run:
+    timestamp queries read the CPU clock when they're written, fences are
+    signaled (unless held, see Vita_NullGLHoldFences) & mapped buffers get
+    real memory. Program binaries aren't supported, so the program cache
+    stays off.
+
+    Only the GL headers (Khronos' gl.h & glext.h) are needed to build it.
+*/
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES 1
+#endif
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Extensions the null backend can claim, see Vita_NullGLSetExtensions.
+#define VGL_NULL_EXT_TIMER_QUERY (1u << 0)
+#define VGL_NULL_EXT_PIXEL_BUFFER_OBJECT (1u << 1)
+#define VGL_NULL_EXT_SYNC (1u << 2)
+#define VGL_NULL_EXT_MAP_BUFFER_RANGE (1u << 3)
+#define VGL_NULL_EXT_ALL (VGL_NULL_EXT_TIMER_QUERY | VGL_NULL_EXT_PIXEL_BUFFER_OBJECT | VGL_NULL_EXT_SYNC | VGL_NULL_EXT_MAP_BUFFER_RANGE)
+
+extern unsigned int _vgl_null_extensions;
+
+// GLEW's extension checks, answered by the null backend.
+#define GLEW_ARB_timer_query ((_vgl_null_extensions & VGL_NULL_EXT_TIMER_QUERY) != 0)
+#define GLEW_ARB_pixel_buffer_object ((_vgl_null_extensions & VGL_NULL_EXT_PIXEL_BUFFER_OBJECT) != 0)
+#define GLEW_ARB_sync ((_vgl_null_extensions & VGL_NULL_EXT_SYNC) != 0)
+#define GLEW_ARB_map_buffer_range ((_vgl_null_extensions & VGL_NULL_EXT_MAP_BUFFER_RANGE) != 0)
+#define GLEW_ARB_get_program_binary 0
+
+// Every GL call the null backend implements.
+#define VGL_NULL_GL_CALLS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindTexture) X(BlendFunc) \
+    X(BufferData) X(BufferSubData) X(Clear) X(ClearColor) X(ClientWaitSync) \
+    X(CompileShader) X(CompressedTexImage2D) X(CreateProgram) X(CreateShader) \
+    X(DeleteBuffers) X(DeleteProgram) X(DeleteQueries) X(DeleteShader) X(DeleteSync) \
+    X(DeleteTextures) X(DepthFunc) X(DepthMask) X(Disable) X(DisableVertexAttribArray) \
+    X(DrawElements) X(Enable) X(EnableVertexAttribArray) X(FenceSync) X(GenBuffers) \
+    X(GenQueries) X(GenTextures) X(GetAttribLocation) X(GetError) X(GetIntegerv) \
+    X(GetProgramBinary) X(GetProgramInfoLog) X(GetProgramiv) X(GetQueryObjectiv) \
+    X(GetQueryObjectui64v) X(GetShaderInfoLog) X(GetShaderiv) X(GetString) \
+    X(GetUniformLocation) X(LinkProgram) X(MapBufferRange) X(PixelStorei) \
+    X(ProgramBinary) X(ProgramParameteri) X(QueryCounter) X(ShaderSource) \
+    X(TexImage2D) X(TexParameteri) X(TexSubImage2D) X(Uniform1f) X(Uniform1i) \
+    X(Uniform2f) X(UniformMatrix4fv) X(UnmapBuffer) X(UseProgram) \
+    X(VertexAttribPointer) X(Viewport)
+
+// VGL_NULL_GL_<call without the gl>, e.g. VGL_NULL_GL_DrawElements.
+#define _VGL_NULL_GL_CALL_ID(name) VGL_NULL_GL_##name,
+enum { VGL_NULL_GL_CALLS(_VGL_NULL_GL_CALL_ID) VGL_NULL_GL_CALL_COUNT };
+
+typedef struct _vita_null_gl_stats
+{
+    unsigned long long calls[VGL_NULL_GL_CALL_COUNT]; // By VGL_NULL_GL_*.
+    unsigned long long total_calls;
+    unsigned long long indices_drawn;
+    unsigned long long buffer_upload_bytes; // Given to buffers: data, sub data & mapped ranges.
+    unsigned long long texture_upload_bytes; // Given to textures, compressed or not.
+    unsigned int swaps; // Frames presented.
+
+    // What the GPU would be holding now, & the most it held.
+    size_t buffer_bytes, buffer_bytes_peak;
+    size_t texture_bytes, texture_bytes_peak;
+    int buffers, textures, programs, shaders, queries;
+} VitaNullGLStats;
+
+// One recorded call, see Vita_NullGLSetRecording.
+typedef struct _vita_null_gl_command
+{
+    uint16_t call; // VGL_NULL_GL_*
+    uint32_t args[4]; // Its first integer arguments (names, enums, sizes...), 0 past them.
+    uint32_t bytes; // Data it handed over, if any.
+} VitaNullGLCommand;
+
+/**
+ * Vita_NullGLSetExtensions():
+ *  Picks the VGL_NULL_EXT_* extensions to claim. Default VGL_NULL_EXT_ALL.
+ *  Call it before initGL; the renderer checks extensions once.
+ */
+void Vita_NullGLSetExtensions(unsigned int extensions);
+
+/**
+ * Vita_NullGLGetStats():
+ *  Copies the counters & memory use so far to `stats`.
+ */
+void Vita_NullGLGetStats(VitaNullGLStats *stats);
+
+/**
+ * Vita_NullGLResetCounters():
+ *  Zeroes the call, byte & swap counters. Memory use is left alone,
+ *  its peaks drop to what's held now.
+ */
+void Vita_NullGLResetCounters();
+
+/**
+ * Vita_NullGLSetRecording():
+ *  Starts (or stops) recording every call. Recorded calls stay
+ *  until Vita_NullGLClearCommands.
+ */
+void Vita_NullGLSetRecording(int enabled);
+
+/**
+ * Vita_NullGLCommands():
+ *  returns the calls recorded so far, in order, and their number in `count`.
+ *  Valid until the next call is recorded or they're cleared.
+ */
+const VitaNullGLCommand *Vita_NullGLCommands(size_t *count);
+void Vita_NullGLClearCommands();
+
+/**
+ * Vita_NullGLHoldFences():
+ *  While `held`, every fence reads as unsignaled: glClientWaitSync times
+ *  out, as if the GPU were still busy. Anything that waits on one spins.
+ */
+void Vita_NullGLHoldFences(int held);
+
+/**
+ * Vita_NullGLCallName():
+ *  returns the GL function a VGL_NULL_GL_* call is ("glDrawElements").
+ */
+const char *Vita_NullGLCallName(int call);
+
+/**
+ * Vita_NullGLSwapBuffers():
+ *  Presents a frame, which only counts it. Called by Vita_Repaint.
+ */
+void Vita_NullGLSwapBuffers();
+
+#endif // __VGL_NULL_GL_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,295 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// EGL's headers would otherwise pull in Xlib's.
+#ifndef EGL_NO_X11
+#define EGL_NO_X11
+#endif
+
+#include "vgl_renderer.h"
+#include "vgl_offscreen.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static void (*_debugPrintf)(const char*, ...);
+
+static EGLDisplay _display = EGL_NO_DISPLAY;
+static EGLContext _context = EGL_NO_CONTEXT;
+static EGLSurface _surface = EGL_NO_SURFACE; // Only without surfaceless contexts.
+
+static GLuint _framebuffer = 0;
+static GLuint _colorBuffer = 0, _depthBuffer = 0;
+static int _width = 0, _height = 0;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static int _Vita_HasExtension(const char *extensions, const char *name)
+{
+    size_t length = strlen(name);
+    for(const char *at = extensions; at != NULL && (at = strstr(at, name)) != NULL; at += length)
+    {
+        if((at == extensions || at[-1] == ' ') && (at[length] == ' ' || at[length] == '\0'))
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * _Vita_OpenDisplay():
+ *  Opens Mesa's surfaceless platform if EGL has it, so no display server
+ *  is needed, and the default display otherwise.
+ */
+static EGLDisplay _Vita_OpenDisplay()
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if(_Vita_HasExtension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if(getPlatformDisplay != NULL)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+#endif
+
+    if(display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    return display;
+}
+
+/**
+ * _Vita_CreateContext():
+ *  Creates a desktop GL context on _display & makes it current,
+ *  with a `width` x `height` pbuffer if it can't go without a surface.
+ */
+static int _Vita_CreateContext(int width, int height)
+{
+    int surfaceless = _Vita_HasExtension(eglQueryString(_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint config_count = 0;
+    if(!eglChooseConfig(_display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        _debugPrintf("[offscreen] No EGL config renders desktop GL.\n");
+        return -1;
+    }
+
+    // The renderer's shaders are GLSL 1.20, so no core profile.
+    if(!eglBindAPI(EGL_OPENGL_API))
+    {
+        _debugPrintf("[offscreen] EGL can't create desktop GL contexts.\n");
+        return -1;
+    }
+
+    _context = eglCreateContext(_display, config, EGL_NO_CONTEXT, NULL);
+    if(_context == EGL_NO_CONTEXT)
+    {
+        _debugPrintf("[offscreen] eglCreateContext failed: 0x%x\n", eglGetError());
+        return -1;
+    }
+
+    if(!surfaceless)
+    {
+        const EGLint pbuffer_attributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        _surface = eglCreatePbufferSurface(_display, config, pbuffer_attributes);
+        if(_surface == EGL_NO_SURFACE)
+        {
+            _debugPrintf("[offscreen] eglCreatePbufferSurface failed: 0x%x\n", eglGetError());
+            return -1;
+        }
+    }
+
+    if(!eglMakeCurrent(_display, _surface, _surface, _context))
+    {
+        _debugPrintf("[offscreen] eglMakeCurrent failed: 0x%x\n", eglGetError());
+        return -1;
+    }
+
+    _debugPrintf("[offscreen] EGL %s context on %s.\n", surfaceless ? "surfaceless" : "pbuffer",
+        eglQueryString(_display, EGL_VENDOR));
+    return 0;
+}
+
+/**
+ * _Vita_CreateFramebuffer():
+ *  Creates the `width` x `height` framebuffer object frames are drawn
+ *  into & leaves it bound. The renderer never binds another one.
+ */
+static int _Vita_CreateFramebuffer(int width, int height)
+{
+    glGenRenderbuffers(1, &_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthBuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        _debugPrintf("[offscreen] Framebuffer incomplete: 0x%x\n", status);
+        return -1;
+    }
+
+    _width = width;
+    _height = height;
+    return 0;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_OffscreenInit(int width, int height, void (*dbgPrintFn)(const char*, ...))
+{
+    _debugPrintf = dbgPrintFn;
+
+    _display = _Vita_OpenDisplay();
+    EGLint major = 0, minor = 0;
+    if(_display == EGL_NO_DISPLAY || !eglInitialize(_display, &major, &minor))
+    {
+        _debugPrintf("[offscreen] Could not open an EGL display.\n");
+        return -1;
+    }
+    _debugPrintf("[offscreen] EGL %d.%d\n", major, minor);
+
+    if(_Vita_CreateContext(width, height) != 0)
+        return -1;
+
+    // GLEW built for GLX still loads every GL function, but then
+    // fails to find a GLX display, which isn't needed here.
+    glewExperimental = 1;
+    GLenum glewReturnVal = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if(glewReturnVal == GLEW_ERROR_NO_GLX_DISPLAY) glewReturnVal = GLEW_OK;
+#endif
+    if(glewReturnVal != GLEW_OK)
+    {
+        _debugPrintf("[offscreen] GLEWINIT FAILED! (%d)\n", glewReturnVal);
+        return -1;
+    }
+
+    if(!GLEW_ARB_framebuffer_object)
+    {
+        _debugPrintf("[offscreen] The GL has no framebuffer objects.\n");
+        return -1;
+    }
+
+    return _Vita_CreateFramebuffer(width, height);
+}
+
+void Vita_OffscreenPresent()
+{
+    glFlush();
+}
+
+void Vita_OffscreenTerminate()
+{
+    if(_context != EGL_NO_CONTEXT && _framebuffer != 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &_framebuffer);
+        glDeleteRenderbuffers(1, &_colorBuffer);
+        glDeleteRenderbuffers(1, &_depthBuffer);
+    }
+    _framebuffer = _colorBuffer = _depthBuffer = 0;
+    _width = _height = 0;
+
+    if(_display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(_surface != EGL_NO_SURFACE) eglDestroySurface(_display, _surface);
+    if(_context != EGL_NO_CONTEXT) eglDestroyContext(_display, _context);
+    eglTerminate(_display);
+
+    _surface = EGL_NO_SURFACE;
+    _context = EGL_NO_CONTEXT;
+    _display = EGL_NO_DISPLAY;
+}
+
+size_t Vita_OffscreenReadPixels(unsigned char *rgba, int *width, int *height)
+{
+    if(width != NULL) *width = _width;
+    if(height != NULL) *height = _height;
+
+    size_t row = (size_t)_width * 4;
+    if(_framebuffer == 0 || rgba == NULL) return row * _height;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+
+    // GL's rows go bottom up.
+    unsigned char swap[256];
+    for(int y = 0; y < _height / 2; y++)
+    {
+        unsigned char *top = rgba + row * y, *bottom = rgba + row * (_height - 1 - y);
+        for(size_t x = 0; x < row; x += sizeof(swap))
+        {
+            size_t n = row - x < sizeof(swap) ? row - x : sizeof(swap);
+            memcpy(swap, top + x, n);
+            memcpy(top + x, bottom + x, n);
+            memcpy(bottom + x, swap, n);
+        }
+    }
+
+    return row * _height;
+}
+
+int Vita_OffscreenSavePPM(const char *path)
+{
+    size_t size = Vita_OffscreenReadPixels(NULL, NULL, NULL);
+    if(_framebuffer == 0 || size == 0) return -1;
+
+    unsigned char *rgba = (unsigned char *)VGL_MALLOC(size);
+    if(rgba == NULL) return -1;
+
+    Vita_OffscreenReadPixels(rgba, NULL, NULL);
+
+    FILE *file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        free(rgba);
+        return -1;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", _width, _height);
+
+    // RGBA -> RGB, in place.
+    size_t pixels = size / 4;
+    for(size_t i = 0; i < pixels; i++)
+    {
+        rgba[i * 3 + 0] = rgba[i * 4 + 0];
+        rgba[i * 3 + 1] = rgba[i * 4 + 1];
+        rgba[i * 3 + 2] = rgba[i * 4 + 2];
+    }
+
+    int result = fwrite(rgba, 3, pixels, file) == pixels ? 0 : -1;
+    if(fclose(file) != 0) result = -1;
+
+    free(rgba);
+    return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
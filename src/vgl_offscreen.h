@@ -0,0 +1,69 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_OFFSCREEN_H__
+#define __VGL_OFFSCREEN_H__
+
+/*
+    Offscreen GL context (cmake -DVGL_OFFSCREEN=ON, Linux only).
+
+    Builds the renderer without GLFW: initGL creates its context through
+    EGL instead of opening a window, surfaceless where the driver allows it
+    (EGL_KHR_surfaceless_context) and on a pbuffer otherwise, then renders
+    every frame into a framebuffer object of the display's size.
+
+    Nothing is presented, so nothing waits on a vsync: Vita_Repaint only
+    flushes, and frames run as fast as the GL can take them. Mesa's
+    surfaceless platform is used when EGL has it, so with llvmpipe
+    (LIBGL_ALWAYS_SOFTWARE=1 forces it over a GPU driver) the whole GL path
+    can be benchmarked & its output checked, pixel for pixel, on a machine
+    without a GPU or a display. See Vita_OffscreenReadPixels.
+*/
+
+#include <stddef.h>
+
+/**
+ * Vita_OffscreenInit():
+ *  Creates an EGL context, makes it current & binds a `width` x `height`
+ *  RGBA8 + depth framebuffer object to draw into. Called by initGL.
+ *
+ *  returns 0 on success, -1 if any of it failed (printed with `dbgPrintFn`).
+ */
+int Vita_OffscreenInit(int width, int height, void (*dbgPrintFn)(const char*, ...));
+
+/**
+ * Vita_OffscreenPresent():
+ *  Ends a frame: flushes the GL & returns, never waiting. Called by Vita_Repaint.
+ */
+void Vita_OffscreenPresent();
+
+/**
+ * Vita_OffscreenTerminate():
+ *  Frees the framebuffer object & destroys the context. Called by deInitGL.
+ */
+void Vita_OffscreenTerminate();
+
+/**
+ * Vita_OffscreenReadPixels():
+ *  Reads the last frame drawn into `rgba`, top row first, 4 bytes a pixel.
+ *  `rgba` must hold width * height * 4 bytes; NULL only gets the size.
+ *  `width` & `height` (may be NULL) receive the framebuffer's size.
+ *
+ *  returns the number of bytes read (or needed), 0 without a context.
+ */
+size_t Vita_OffscreenReadPixels(unsigned char *rgba, int *width, int *height);
+
+/**
+ * Vita_OffscreenSavePPM():
+ *  Writes the last frame drawn to `path` as a binary PPM (alpha is dropped).
+ *
+ *  returns 0 on success, -1 otherwise.
+ */
+int Vita_OffscreenSavePPM(const char *path);
+
+#endif // __VGL_OFFSCREEN_H__
+
+#ifdef __cplusplus
+}
+#endif
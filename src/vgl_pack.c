@@ -0,0 +1,189 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__APPLE__) || defined(PC_BUILD)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VGL_PACK_MMAP 1
+#endif
+
+#include "vgl_pack.h"
+#include "vgl_alloc.h"
+
+static VitaPack _mountedPack;
+static char _mountPrefix[64];
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_CheckPack():
+ *  Validates the header & index of a freshly loaded pack and
+ *  points pack->entries/names into it.
+ */
+static int _Vita_CheckPack(VitaPack *pack)
+{
+    VitaPackHeader header;
+    if(pack->size < sizeof(header)) return -1;
+    memcpy(&header, pack->data, sizeof(header));
+
+    if(header.magic != VGL_PACK_MAGIC || header.version != VGL_PACK_VERSION)
+        return -1;
+
+    size_t index_size = (size_t)header.entry_count * sizeof(VitaPackEntry);
+    if(header.index_offset > pack->size || index_size > pack->size - header.index_offset
+        || header.names_offset > pack->size || header.names_size > pack->size - header.names_offset
+        || (header.index_offset % sizeof(uint64_t)) != 0)
+        return -1;
+
+    pack->entries = (const VitaPackEntry *)(pack->data + header.index_offset);
+    pack->entry_count = header.entry_count;
+    pack->names = (const char *)(pack->data + header.names_offset);
+    pack->names_size = header.names_size;
+
+    // Blobs must be in bounds and zero terminated, names terminated, the index sorted.
+    for(uint32_t i = 0; i < pack->entry_count; i++)
+    {
+        const VitaPackEntry *entry = &pack->entries[i];
+        if(entry->offset > pack->size || entry->size >= pack->size - entry->offset
+            || pack->data[entry->offset + entry->size] != '\0'
+            || entry->name_offset >= pack->names_size
+            || memchr(pack->names + entry->name_offset, '\0', pack->names_size - entry->name_offset) == NULL)
+            return -1;
+
+        if(i > 0 && pack->entries[i - 1].path_hash > entry->path_hash)
+            return -1;
+    }
+
+    return 0;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_OpenPack(VitaPack *pack, const char *path)
+{
+    memset(pack, 0, sizeof(VitaPack));
+
+#ifdef VGL_PACK_MMAP
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return -1;
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED) return -1;
+
+    pack->data = (const unsigned char *)data;
+    pack->size = info.st_size;
+    pack->mapped = 1;
+#else
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) return -1;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = length > 0 ? (unsigned char *)VGL_MALLOC(length) : NULL;
+    if(data != NULL && fread(data, length, 1, file) != 1)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    if(data == NULL) return -1;
+
+    pack->data = data;
+    pack->size = length;
+#endif
+
+    if(_Vita_CheckPack(pack) != 0)
+    {
+        Vita_ClosePack(pack);
+        return -1;
+    }
+
+    return 0;
+}
+
+void Vita_ClosePack(VitaPack *pack)
+{
+    if(pack->data == NULL) return;
+
+#ifdef VGL_PACK_MMAP
+    if(pack->mapped) munmap((void *)pack->data, pack->size);
+    else
+#endif
+    free((void *)pack->data);
+
+    memset(pack, 0, sizeof(VitaPack));
+}
+
+const void *Vita_PackFind(const VitaPack *pack, const char *name, size_t *size)
+{
+    if(pack->data == NULL || name == NULL) return NULL;
+
+    uint64_t hash = Vita_PackHashPath(name);
+
+    // Lower bound on the hash, then walk the (rare) run of equal hashes.
+    uint32_t lo = 0, hi = pack->entry_count;
+    while(lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2);
+        if(pack->entries[mid].path_hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for(; lo < pack->entry_count && pack->entries[lo].path_hash == hash; lo++)
+    {
+        const VitaPackEntry *entry = &pack->entries[lo];
+        if(strcmp(pack->names + entry->name_offset, name) != 0) continue;
+
+        if(size != NULL) *size = entry->size;
+        return pack->data + entry->offset;
+    }
+
+    return NULL;
+}
+
+int Vita_MountPack(const char *path, const char *prefix)
+{
+    Vita_UnmountPack();
+
+    if(prefix != NULL && strlen(prefix) >= sizeof(_mountPrefix)) return -1;
+    if(Vita_OpenPack(&_mountedPack, path) != 0) return -1;
+
+    strcpy(_mountPrefix, prefix != NULL ? prefix : "");
+    return 0;
+}
+
+void Vita_UnmountPack()
+{
+    Vita_ClosePack(&_mountedPack);
+    _mountPrefix[0] = '\0';
+}
+
+const void *Vita_FindPackedFile(const char *path, size_t *size)
+{
+    if(_mountedPack.data == NULL || path == NULL) return NULL;
+
+    size_t prefix_length = strlen(_mountPrefix);
+    if(prefix_length > 0 && strncmp(path, _mountPrefix, prefix_length) == 0)
+        path += prefix_length;
+
+    return Vita_PackFind(&_mountedPack, path, size);
+}
+
+#ifdef __cplusplus
+}
+#endif
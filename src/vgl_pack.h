@@ -0,0 +1,137 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_PACK_H__
+#define __VGL_PACK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Asset pack (.vpak): every resource in one file, opened once.
+
+    File layout (little endian):
+        VitaPackHeader
+        blobs, each starting on a VGL_PACK_ALIGNMENT boundary and
+            followed by at least one zero byte, so text assets can
+            be used as C strings in place
+        VitaPackEntry[entry_count], sorted by path_hash
+        names: NUL terminated, one per entry
+
+    Lookups binary search the index by path hash, then compare the
+    stored name to rule out a collision. The pack is memory mapped
+    where we can (PC), otherwise read in whole, and every lookup returns
+    a pointer into it: nothing is copied.
+
+    Packs are written by tools/vgl_pack.c (the vgl_assets build target).
+*/
+
+#define VGL_PACK_MAGIC 0x4B415056 // "VPAK"
+#define VGL_PACK_VERSION 1
+
+// Blob alignment. A cache line, and enough for any texel or vertex type.
+#define VGL_PACK_ALIGNMENT 64
+
+typedef struct _vita_pack_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t index_offset; // VitaPackEntry array.
+    uint32_t names_offset;
+    uint32_t names_size;
+} __attribute__ ((packed)) VitaPackHeader;
+
+typedef struct _vita_pack_entry
+{
+    uint64_t path_hash; // Vita_PackHashPath of the name.
+    uint32_t offset;
+    uint32_t size; // Without the terminating zero.
+    uint32_t name_offset; // Into the names block.
+    uint32_t reserved;
+} __attribute__ ((packed)) VitaPackEntry;
+
+typedef struct _vita_pack
+{
+    const unsigned char *data;
+    size_t size;
+    char mapped; // data is an mmap, not a malloc.
+
+    const VitaPackEntry *entries;
+    uint32_t entry_count;
+    const char *names;
+    uint32_t names_size;
+} VitaPack;
+
+/**
+ * Vita_PackHashPath():
+ *  FNV-1a of a pack name. Names use '/' and are relative to the
+ *  project root, e.g. "res/frag.glsl".
+ */
+static inline uint64_t Vita_PackHashPath(const char *name)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(; *name != '\0'; name++)
+    {
+        hash ^= (unsigned char)*name;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * Vita_OpenPack():
+ *  Maps (or reads) the pack at `path` and checks its index.
+ *
+ *  returns 0 on success, -1 if it can't be read or is malformed.
+ */
+int Vita_OpenPack(VitaPack *pack, const char *path);
+
+/**
+ * Vita_ClosePack():
+ *  Unmaps the pack. Pointers from Vita_PackFind die with it.
+ */
+void Vita_ClosePack(VitaPack *pack);
+
+/**
+ * Vita_PackFind():
+ *  returns a pointer to the contents of `name` inside the pack and
+ *  stores its size in `size`, or NULL if the pack doesn't have it.
+ *  The contents are followed by a zero byte.
+ */
+const void *Vita_PackFind(const VitaPack *pack, const char *name, size_t *size);
+
+/**
+ * Vita_MountPack():
+ *  Opens the pack at `path` as the one Vita_FindPackedFile looks in.
+ *  Paths starting with `prefix` (e.g. "app0:") have it stripped before
+ *  the lookup, so existing asset paths keep working.
+ *  Mount before starting the texture loader, unmount after stopping it.
+ *
+ *  returns 0 on success.
+ */
+int Vita_MountPack(const char *path, const char *prefix);
+
+/**
+ * Vita_UnmountPack():
+ *  Closes the mounted pack, if any.
+ */
+void Vita_UnmountPack();
+
+/**
+ * Vita_FindPackedFile():
+ *  Looks `path` up in the mounted pack.
+ *  Safe to call from any thread while the pack stays mounted.
+ *
+ *  returns a pointer into the pack (see Vita_PackFind), or NULL if
+ *  nothing is mounted or the pack doesn't have it.
+ */
+const void *Vita_FindPackedFile(const char *path, size_t *size);
+
+#endif // __VGL_PACK_H__
+
+#ifdef __cplusplus
+}
+#endif
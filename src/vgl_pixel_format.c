@@ -0,0 +1,532 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VGL_PIXEL_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VGL_PIXEL_SSE2 1
+#endif
+
+#include "vgl_pixel_format.h"
+#include "vgl_alloc.h"
+
+// Largest value & bit position of each channel (r, g, b, a) in a 16 bit texel.
+// A max of 0 drops the channel.
+typedef struct _pixel_layout
+{
+    uint8_t max[4];
+    uint8_t shift[4];
+} PixelLayout;
+
+static const PixelLayout _pixelLayouts[] = {
+    { { 0, 0, 0, 0 }, { 0, 0, 0, 0 } },         // VGL_PIXEL_RGBA8888, not converted.
+    { { 15, 15, 15, 15 }, { 12, 8, 4, 0 } },    // VGL_PIXEL_RGBA4444
+    { { 31, 31, 31, 1 }, { 11, 6, 1, 0 } },     // VGL_PIXEL_RGBA5551
+    { { 31, 63, 31, 0 }, { 11, 5, 0, 0 } },     // VGL_PIXEL_RGB565
+};
+
+// 4x4 Bayer matrix, thresholds 0 .. 15.
+static const uint8_t _bayer[4][4] = {
+    { 0, 8, 2, 10 },
+    { 12, 4, 14, 6 },
+    { 3, 11, 1, 9 },
+    { 15, 7, 13, 5 },
+};
+
+// Marks a free ColorTable slot. Never a real value: those are palette
+// indices or pixel counts, which stay far below it.
+#define COLOR_TABLE_EMPTY 0xFFFFFFFFu
+
+// Open addressing map of RGBA8 colors (as loaded from memory) to a value,
+// used while palettizing. Sized for the worst case up front, never grows.
+typedef struct _color_table
+{
+    uint32_t *colors;
+    uint32_t *values; // COLOR_TABLE_EMPTY for free slots.
+    uint32_t mask;
+} ColorTable;
+
+// A unique color of the image being palettized, and how many pixels use it.
+typedef struct _color_entry
+{
+    uint32_t color;
+    uint32_t count;
+    uint8_t key; // The channel a median cut box is being sorted on.
+} ColorEntry;
+
+// A median cut box: a run of ColorEntries.
+typedef struct _color_box
+{
+    uint32_t begin;
+    uint32_t end;
+    int range; // Largest channel range in the box.
+    int channel; // ...and which channel that is.
+} ColorBox;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_Quantize():
+ *  floor((v * max + offset) / 255) without a divide, exact for the
+ *  whole range we use. An offset of 128 rounds to nearest, dithering
+ *  spreads it over 0 .. 255.
+ */
+static inline unsigned _Vita_Quantize(unsigned v, unsigned max, unsigned offset)
+{
+    unsigned t = (v * max) + offset;
+    return (t + 1 + (t >> 8)) >> 8;
+}
+
+/**
+ * _Vita_DitherOffsets():
+ *  The color rounding offsets for the 4 pixel columns of row `y`.
+ */
+static void _Vita_DitherOffsets(int y, int dither, uint16_t offsets[4])
+{
+    for(int x = 0; x < 4; x++)
+        offsets[x] = dither ? (uint16_t)((((_bayer[y & 3][x] * 2) + 1) * 255) / 32) : 128;
+}
+
+/**
+ * _Vita_ConvertRow():
+ *  One row, `offsets` from _Vita_DitherOffsets.
+ */
+static void _Vita_ConvertRow(const PixelLayout *layout, const unsigned char *src, uint16_t *dst, int width, const uint16_t offsets[4])
+{
+    int x = 0;
+
+#if defined(VGL_PIXEL_NEON)
+    // 8 pixels per iteration, deinterleaved into one vector per channel.
+    uint16x8_t color_offset = vcombine_u16(vld1_u16(offsets), vld1_u16(offsets));
+    uint16x8_t alpha_offset = vdupq_n_u16(128);
+    uint16x8_t one = vdupq_n_u16(1);
+
+    for(; x + 8 <= width; x += 8)
+    {
+        uint8x8x4_t px = vld4_u8(src + (x * 4));
+        uint16x8_t out = vdupq_n_u16(0);
+
+        for(int c = 0; c < 4; c++)
+        {
+            if(layout->max[c] == 0) continue;
+
+            uint16x8_t t = vmlal_u8(c == 3 ? alpha_offset : color_offset, px.val[c], vdup_n_u8(layout->max[c]));
+            uint16x8_t q = vshrq_n_u16(vaddq_u16(vaddq_u16(t, one), vshrq_n_u16(t, 8)), 8);
+            out = vorrq_u16(out, vshlq_u16(q, vdupq_n_s16(layout->shift[c])));
+        }
+
+        vst1q_u16(dst + x, out);
+    }
+#elif defined(VGL_PIXEL_SSE2)
+    // 8 pixels per iteration, 4 per register with one channel per 32 bit lane.
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i color_offset = _mm_set_epi32(offsets[3], offsets[2], offsets[1], offsets[0]);
+    const __m128i alpha_offset = _mm_set1_epi32(128);
+
+    for(; x + 8 <= width; x += 8)
+    {
+        __m128i packed[2];
+        for(int half = 0; half < 2; half++)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + ((x + (half * 4)) * 4)));
+            __m128i out = _mm_setzero_si128();
+
+            for(int c = 0; c < 4; c++)
+            {
+                if(layout->max[c] == 0) continue;
+
+                __m128i channel = c == 3 ? _mm_srli_epi32(v, 24) : _mm_and_si128(_mm_srli_epi32(v, c * 8), byte);
+                // The product fits in 16 bits, and the lane's high half stays 0 * 0.
+                __m128i t = _mm_add_epi32(_mm_mullo_epi16(channel, _mm_set1_epi32(layout->max[c])), c == 3 ? alpha_offset : color_offset);
+                __m128i q = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(t, one), _mm_srli_epi32(t, 8)), 8);
+                out = _mm_or_si128(out, _mm_sll_epi32(q, _mm_cvtsi32_si128(layout->shift[c])));
+            }
+
+            packed[half] = _mm_sub_epi32(out, bias);
+        }
+
+        // No unsigned 32 -> 16 bit pack in SSE2: bias into signed range and back.
+        __m128i out = _mm_xor_si128(_mm_packs_epi32(packed[0], packed[1]), _mm_set1_epi16((short)0x8000));
+        _mm_storeu_si128((__m128i *)(dst + x), out);
+    }
+#endif
+
+    for(; x < width; x++)
+    {
+        const unsigned char *p = src + (x * 4);
+        unsigned out = 0;
+
+        for(int c = 0; c < 4; c++)
+        {
+            if(layout->max[c] == 0) continue;
+            out |= _Vita_Quantize(p[c], layout->max[c], c == 3 ? 128 : offsets[x & 3]) << layout->shift[c];
+        }
+
+        dst[x] = (uint16_t)out;
+    }
+}
+
+/**
+ * _Vita_QuantizeErrors():
+ *  Squared error of rounding every 8 bit value to `max` + 1 levels.
+ */
+static void _Vita_QuantizeErrors(unsigned max, uint32_t errors[256])
+{
+    for(unsigned v = 0; v < 256; v++)
+    {
+        if(max == 0)
+        {
+            errors[v] = 0;
+            continue;
+        }
+
+        unsigned q = _Vita_Quantize(v, max, 128);
+        int back = (int)(((q * 255) + (max / 2)) / max);
+        errors[v] = (uint32_t)((back - (int)v) * (back - (int)v));
+    }
+}
+
+/**
+ * _Vita_CanonicalColor():
+ *  The pixel as a table key. Every fully transparent pixel is the same color.
+ */
+static inline uint32_t _Vita_CanonicalColor(const unsigned char *p)
+{
+    uint32_t color;
+    if(p[3] == 0) return 0;
+
+    memcpy(&color, p, sizeof(color));
+    return color;
+}
+
+static int _Vita_ColorTableInit(ColorTable *table, size_t entries)
+{
+    size_t capacity = 16;
+    while(capacity < entries * 2) capacity <<= 1;
+
+    table->colors = (uint32_t *)VGL_MALLOC(capacity * sizeof(uint32_t));
+    table->values = (uint32_t *)VGL_MALLOC(capacity * sizeof(uint32_t));
+    table->mask = (uint32_t)(capacity - 1);
+
+    if(table->colors == NULL || table->values == NULL)
+    {
+        free(table->colors);
+        free(table->values);
+        return -1;
+    }
+
+    memset(table->values, 0xFF, capacity * sizeof(uint32_t));
+    return 0;
+}
+
+static void _Vita_ColorTableFree(ColorTable *table)
+{
+    free(table->colors);
+    free(table->values);
+    memset(table, 0, sizeof(ColorTable));
+}
+
+/**
+ * _Vita_ColorTableSlot():
+ *  returns the slot holding `color`, or the free slot it goes in
+ *  (values[slot] == COLOR_TABLE_EMPTY).
+ */
+static inline uint32_t _Vita_ColorTableSlot(const ColorTable *table, uint32_t color)
+{
+    uint32_t hash = color * 0x9E3779B1u;
+    uint32_t slot = (hash ^ (hash >> 16)) & table->mask;
+
+    while(table->values[slot] != COLOR_TABLE_EMPTY && table->colors[slot] != color)
+        slot = (slot + 1) & table->mask;
+
+    return slot;
+}
+
+static int _Vita_CompareEntryKeys(const void *a, const void *b)
+{
+    const ColorEntry *ea = (const ColorEntry *)a, *eb = (const ColorEntry *)b;
+    if(ea->key != eb->key) return ea->key < eb->key ? -1 : 1;
+    return ea->color < eb->color ? -1 : (ea->color > eb->color);
+}
+
+static void _Vita_MeasureBox(const ColorEntry *entries, ColorBox *box)
+{
+    unsigned char lo[4] = { 255, 255, 255, 255 }, hi[4] = { 0, 0, 0, 0 };
+    for(uint32_t i = box->begin; i < box->end; i++)
+    {
+        const unsigned char *c = (const unsigned char *)&entries[i].color;
+        for(int ch = 0; ch < 4; ch++)
+        {
+            if(c[ch] < lo[ch]) lo[ch] = c[ch];
+            if(c[ch] > hi[ch]) hi[ch] = c[ch];
+        }
+    }
+
+    box->range = -1;
+    for(int ch = 0; ch < 4; ch++)
+    {
+        if(hi[ch] - lo[ch] > box->range)
+        {
+            box->range = hi[ch] - lo[ch];
+            box->channel = ch;
+        }
+    }
+}
+
+/**
+ * _Vita_MedianCut():
+ *  Splits `entries` into at most `max_colors` boxes, always cutting the box
+ *  with the widest channel at its pixel weighted median, and writes each
+ *  box's weighted average to `palette`.
+ *
+ *  returns the number of colors.
+ */
+static int _Vita_MedianCut(ColorEntry *entries, uint32_t count, int max_colors, unsigned char *palette)
+{
+    ColorBox boxes[VGL_PALETTE_SIZE];
+    int box_count = 1;
+
+    boxes[0].begin = 0;
+    boxes[0].end = count;
+    _Vita_MeasureBox(entries, &boxes[0]);
+
+    while(box_count < max_colors)
+    {
+        int best = -1;
+        for(int i = 0; i < box_count; i++)
+        {
+            if(boxes[i].end - boxes[i].begin > 1 && (best < 0 || boxes[i].range > boxes[best].range))
+                best = i;
+        }
+        if(best < 0 || boxes[best].range <= 0) break;
+
+        ColorBox *box = &boxes[best];
+        uint64_t total = 0;
+        for(uint32_t i = box->begin; i < box->end; i++)
+        {
+            entries[i].key = ((const unsigned char *)&entries[i].color)[box->channel];
+            total += entries[i].count;
+        }
+        qsort(entries + box->begin, box->end - box->begin, sizeof(ColorEntry), _Vita_CompareEntryKeys);
+
+        uint64_t running = 0;
+        uint32_t split = box->begin + 1;
+        for(uint32_t i = box->begin; i < box->end - 1; i++)
+        {
+            running += entries[i].count;
+            split = i + 1;
+            if(running * 2 >= total) break;
+        }
+
+        ColorBox *next = &boxes[box_count++];
+        next->begin = split;
+        next->end = box->end;
+        box->end = split;
+        _Vita_MeasureBox(entries, box);
+        _Vita_MeasureBox(entries, next);
+    }
+
+    for(int b = 0; b < box_count; b++)
+    {
+        uint64_t sum[4] = { 0, 0, 0, 0 }, weight = 0;
+        for(uint32_t i = boxes[b].begin; i < boxes[b].end; i++)
+        {
+            const unsigned char *c = (const unsigned char *)&entries[i].color;
+            for(int ch = 0; ch < 4; ch++) sum[ch] += (uint64_t)c[ch] * entries[i].count;
+            weight += entries[i].count;
+        }
+
+        for(int ch = 0; ch < 4; ch++)
+            palette[(b * 4) + ch] = (unsigned char)((sum[ch] + (weight / 2)) / weight);
+    }
+
+    return box_count;
+}
+
+static int _Vita_NearestColor(const unsigned char *c, const unsigned char *palette, int colors)
+{
+    int best = 0;
+    int best_distance = 0x7FFFFFFF;
+    for(int i = 0; i < colors && best_distance > 0; i++)
+    {
+        const unsigned char *p = palette + (i * 4);
+        int distance = 0;
+        for(int ch = 0; ch < 4; ch++) distance += (c[ch] - p[ch]) * (c[ch] - p[ch]);
+
+        if(distance < best_distance)
+        {
+            best_distance = distance;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_ChoosePixelFormat(const unsigned char *rgba, int width, int height)
+{
+    size_t count = (size_t)width * height;
+    if(count == 0) return VGL_PIXEL_RGBA8888;
+
+    int opaque = 1, binary_alpha = 1;
+    for(size_t i = 0; i < count && binary_alpha; i++)
+    {
+        unsigned char a = rgba[(i * 4) + 3];
+        if(a != 255) opaque = 0;
+        if(a != 0 && a != 255) binary_alpha = 0;
+    }
+
+    int format = opaque ? VGL_PIXEL_RGB565 : (binary_alpha ? VGL_PIXEL_RGBA5551 : VGL_PIXEL_RGBA4444);
+    const PixelLayout *layout = &_pixelLayouts[format];
+
+    uint32_t errors[4][256];
+    for(int c = 0; c < 4; c++)
+        _Vita_QuantizeErrors(c == 3 && format != VGL_PIXEL_RGBA4444 ? 0 : layout->max[c], errors[c]);
+
+    // Color only counts where something is visible. Alpha is exact except in 4444.
+    uint64_t total = 0, samples = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        const unsigned char *p = rgba + (i * 4);
+        if(p[3] != 0)
+        {
+            total += errors[0][p[0]] + errors[1][p[1]] + errors[2][p[2]];
+            samples += 3;
+        }
+        total += errors[3][p[3]];
+        samples += format == VGL_PIXEL_RGBA4444;
+    }
+
+    if(total == 0 || samples == 0) return format;
+
+    double mse = (double)total / samples;
+    double psnr = 10.0 * log10((255.0 * 255.0) / mse);
+    return psnr >= VGL_PIXEL_AUTO_MIN_PSNR ? format : VGL_PIXEL_RGBA8888;
+}
+
+int Vita_ConvertPixels(int format, const unsigned char *rgba, int width, int height, uint16_t *out, int dither)
+{
+    if(format <= VGL_PIXEL_RGBA8888 || format > VGL_PIXEL_RGB565) return -1;
+
+    const PixelLayout *layout = &_pixelLayouts[format];
+    for(int y = 0; y < height; y++)
+    {
+        uint16_t offsets[4];
+        _Vita_DitherOffsets(y, dither, offsets);
+        _Vita_ConvertRow(layout, rgba + ((size_t)y * width * 4), out + ((size_t)y * width), width, offsets);
+    }
+
+    return 0;
+}
+
+int Vita_PalettizePixels(int format, const unsigned char *rgba, int width, int height, unsigned char *palette, unsigned char *out, int *exact)
+{
+    if(!Vita_IsIndexedPixelFormat(format)) return -1;
+
+    int max_colors = format == VGL_PIXEL_INDEX8 ? 256 : 16;
+    size_t pixels = (size_t)width * height;
+    ColorTable table;
+    int colors = 0;
+    int is_exact = 1;
+
+    memset(palette, 0, VGL_PALETTE_SIZE * 4);
+
+    // Most pixel art fits: give every new color the next index.
+    if(_Vita_ColorTableInit(&table, max_colors) != 0) return -1;
+    for(size_t i = 0; i < pixels && is_exact; i++)
+    {
+        uint32_t color = _Vita_CanonicalColor(rgba + (i * 4));
+        uint32_t slot = _Vita_ColorTableSlot(&table, color);
+        if(table.values[slot] != COLOR_TABLE_EMPTY) continue;
+
+        if(colors == max_colors) is_exact = 0;
+        else
+        {
+            table.colors[slot] = color;
+            table.values[slot] = colors;
+            memcpy(palette + (colors * 4), &color, 4);
+            colors++;
+        }
+    }
+
+    if(!is_exact)
+    {
+        // Too many: count every color, merge them, then map each to its closest entry.
+        _Vita_ColorTableFree(&table);
+        if(_Vita_ColorTableInit(&table, pixels) != 0) return -1;
+
+        uint32_t unique = 0;
+        for(size_t i = 0; i < pixels; i++)
+        {
+            uint32_t color = _Vita_CanonicalColor(rgba + (i * 4));
+            uint32_t slot = _Vita_ColorTableSlot(&table, color);
+            if(table.values[slot] == COLOR_TABLE_EMPTY)
+            {
+                table.colors[slot] = color;
+                table.values[slot] = 0;
+                unique++;
+            }
+            table.values[slot]++;
+        }
+
+        ColorEntry *entries = (ColorEntry *)VGL_MALLOC(unique * sizeof(ColorEntry));
+        if(entries == NULL)
+        {
+            _Vita_ColorTableFree(&table);
+            return -1;
+        }
+
+        uint32_t n = 0;
+        for(uint32_t slot = 0; slot <= table.mask; slot++)
+        {
+            if(table.values[slot] == COLOR_TABLE_EMPTY) continue;
+            entries[n].color = table.colors[slot];
+            entries[n].count = table.values[slot];
+            n++;
+        }
+
+        colors = _Vita_MedianCut(entries, unique, max_colors, palette);
+        free(entries);
+
+        for(uint32_t slot = 0; slot <= table.mask; slot++)
+        {
+            if(table.values[slot] == COLOR_TABLE_EMPTY) continue;
+            table.values[slot] = _Vita_NearestColor((const unsigned char *)&table.colors[slot], palette, colors);
+        }
+    }
+
+    size_t row_bytes = Vita_PixelRowBytes(format, width);
+    for(int y = 0; y < height; y++)
+    {
+        const unsigned char *src = rgba + ((size_t)y * width * 4);
+        unsigned char *row = out + (row_bytes * y);
+
+        for(int x = 0; x < width; x++)
+        {
+            uint32_t index = table.values[_Vita_ColorTableSlot(&table, _Vita_CanonicalColor(src + (x * 4)))];
+
+            if(format == VGL_PIXEL_INDEX8) row[x] = (unsigned char)index;
+            else if(x & 1) row[x / 2] |= (unsigned char)(index << 4);
+            else row[x / 2] = (unsigned char)index;
+        }
+    }
+
+    _Vita_ColorTableFree(&table);
+    if(exact != NULL) *exact = is_exact;
+    return colors;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_PIXEL_FORMAT_H__
+#define __VGL_PIXEL_FORMAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    16 bit texel formats, converted from RGBA8 on the CPU.
+
+    Half the memory & sampling bandwidth of RGBA8, which is plenty for
+    most pixel art. Texels are native endian uint16s laid out the way
+    GL's packed UNSIGNED_SHORT types expect (red in the high bits):
+
+        VGL_PIXEL_RGBA4444: 4 bits per channel. Smooth alpha.
+        VGL_PIXEL_RGBA5551: 5 bits per color, 1 bit alpha (>= 128 is opaque).
+        VGL_PIXEL_RGB565:   5/6/5 bits of color, fully opaque.
+
+    Conversion rounds to the nearest value, or with `dither` adds a 4x4
+    ordered (Bayer) dither to the color channels, which hides the banding
+    of smooth gradients. Alpha is never dithered. SSE2 / NEON where available.
+
+    Indexed formats store palette indices instead, drawn through a 256x1
+    RGBA8 palette texture by the VGL_SHADER_PALETTE shader variants:
+
+        VGL_PIXEL_INDEX8: 1 byte per texel, up to 256 colors.
+        VGL_PIXEL_INDEX4: 2 texels per byte (low nibble first), up to 16 colors.
+
+    Palettes are exact when the image has few enough colors, and in order of
+    first appearance, so recolored copies of a sprite get identical indices
+    and only differ in their palette. Otherwise colors are merged by median cut.
+*/
+
+#define VGL_PIXEL_AUTO (-1) // Let Vita_ChoosePixelFormat decide.
+#define VGL_PIXEL_RGBA8888 0
+#define VGL_PIXEL_RGBA4444 1
+#define VGL_PIXEL_RGBA5551 2
+#define VGL_PIXEL_RGB565 3
+#define VGL_PIXEL_INDEX8 4
+#define VGL_PIXEL_INDEX4 5
+
+// Entries in a palette texture, whatever the index format.
+#define VGL_PALETTE_SIZE 256
+
+// Vita_ChoosePixelFormat only picks a 16 bit format when
+// quantizing to it keeps at least this PSNR (in dB).
+#define VGL_PIXEL_AUTO_MIN_PSNR 38.0
+
+static inline int Vita_IsIndexedPixelFormat(int format)
+{
+    return format == VGL_PIXEL_INDEX8 || format == VGL_PIXEL_INDEX4;
+}
+
+/**
+ * Vita_PixelRowBytes():
+ *  returns the bytes a row of `width` texels in `format` takes.
+ */
+static inline size_t Vita_PixelRowBytes(int format, int width)
+{
+    switch(format)
+    {
+        case VGL_PIXEL_RGBA8888: return (size_t)width * 4;
+        case VGL_PIXEL_INDEX8: return (size_t)width;
+        case VGL_PIXEL_INDEX4: return ((size_t)width + 1) / 2;
+        default: return (size_t)width * 2;
+    }
+}
+
+/**
+ * Vita_ChoosePixelFormat():
+ *  Looks at how `rgba` uses alpha and color precision:
+ *   - fully opaque images can use RGB565,
+ *   - images with only on/off alpha can use RGBA5551,
+ *   - anything else can use RGBA4444,
+ *  provided rounding to that format keeps VGL_PIXEL_AUTO_MIN_PSNR.
+ *  Otherwise the image stays RGBA8888.
+ *
+ *  Never picks an indexed format, those need a palette to draw with.
+ *
+ *  returns a VGL_PIXEL_* format (never VGL_PIXEL_AUTO).
+ */
+int Vita_ChoosePixelFormat(const unsigned char *rgba, int width, int height);
+
+/**
+ * Vita_ConvertPixels():
+ *  Converts `width` x `height` RGBA8 pixels to `format` (a 16 bit one)
+ *  into `out`. With `dither`, uses ordered dithering.
+ *
+ *  returns 0 on success, -1 if `format` isn't a 16 bit format.
+ */
+int Vita_ConvertPixels(int format, const unsigned char *rgba, int width, int height, uint16_t *out, int dither);
+
+/**
+ * Vita_PalettizePixels():
+ *  Converts `width` x `height` RGBA8 pixels to `format` (VGL_PIXEL_INDEX8
+ *  or _INDEX4) indices into `out`, Vita_PixelRowBytes per row, and their
+ *  palette into `palette` (VGL_PALETTE_SIZE RGBA8 entries, unused ones zeroed).
+ *  Fully transparent pixels all share one transparent entry.
+ *  `exact` (optional) is set to 0 if colors had to be merged.
+ *
+ *  returns the number of colors in the palette,
+ *  or -1 for a bad format or a failed allocation.
+ */
+int Vita_PalettizePixels(int format, const unsigned char *rgba, int width, int height, unsigned char *palette, unsigned char *out, int *exact);
+
+#endif // __VGL_PIXEL_FORMAT_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+#ifndef __VGL_POOL_H__
+#define __VGL_POOL_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_arena.h"
+
+/*
+    Fixed size block pool.
+
+    Blocks are carved out of slabs of `blocks_per_slab` contiguous blocks,
+    so objects allocated together sit next to each other in memory.
+    Free blocks are kept in an intrusive singly linked list, which makes
+    both Vita_PoolAlloc and Vita_PoolFree O(1). Slabs are only released
+    by Vita_PoolDestroy.
+
+    Not thread safe. The renderer only uses pools from the GL thread.
+*/
+
+// Pass as `alignment` to keep every block on its own cache line(s).
+#define VGL_CACHE_LINE_SIZE 64
+
+#define VGL_POOL_DEFAULT_SLAB_BLOCKS 64
+
+typedef struct _vita_pool_slab
+{
+    struct _vita_pool_slab *next;
+} VitaPoolSlab;
+
+typedef struct _vita_pool
+{
+    size_t block_size; // Rounded up to a multiple of alignment.
+    size_t alignment;
+    size_t blocks_per_slab;
+
+    void *free_list;
+    VitaPoolSlab *slabs;
+
+    size_t live; // Blocks currently handed out.
+    size_t capacity; // Blocks across every slab.
+} VitaPool;
+
+/**
+ * Vita_PoolInit():
+ *  Sets up `pool` for blocks of `block_size` bytes, aligned to `alignment`
+ *  (a power of two; 0 means pointer alignment). No memory is allocated
+ *  until the first Vita_PoolAlloc.
+ *
+ *  returns 0 on success.
+ */
+static inline int Vita_PoolInit(VitaPool *pool, size_t block_size, size_t alignment, size_t blocks_per_slab)
+{
+    if(pool == NULL || block_size == 0) return -1;
+
+    if(alignment < sizeof(void *)) alignment = sizeof(void *);
+    if((alignment & (alignment - 1)) != 0) return -1;
+
+    // Free blocks hold the free list link.
+    if(block_size < sizeof(void *)) block_size = sizeof(void *);
+
+    memset(pool, 0, sizeof(VitaPool));
+    pool->block_size = (block_size + alignment - 1) & ~(alignment - 1);
+    pool->alignment = alignment;
+    pool->blocks_per_slab = blocks_per_slab ? blocks_per_slab : VGL_POOL_DEFAULT_SLAB_BLOCKS;
+
+    return 0;
+}
+
+static inline int _Vita_PoolAddSlab(VitaPool *pool)
+{
+    size_t header = (sizeof(VitaPoolSlab) + pool->alignment - 1) & ~(pool->alignment - 1);
+    char *raw = (char *)VGL_MALLOC(header + (pool->block_size * pool->blocks_per_slab) + pool->alignment);
+    if(raw == NULL) return -1;
+
+    VitaPoolSlab *slab = (VitaPoolSlab *)raw;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    uintptr_t first = ((uintptr_t)raw + header + pool->alignment - 1) & ~(uintptr_t)(pool->alignment - 1);
+
+    // Thread the blocks back to front, so they're handed out in address order.
+    for(size_t i = pool->blocks_per_slab; i-- > 0; )
+    {
+        void **block = (void **)(first + (i * pool->block_size));
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+
+    pool->capacity += pool->blocks_per_slab;
+    return 0;
+}
+
+/**
+ * Vita_PoolAlloc():
+ *  returns an uninitialized block, or NULL if a new slab couldn't be allocated.
+ */
+static inline void *Vita_PoolAlloc(VitaPool *pool)
+{
+    if(pool->free_list == NULL && _Vita_PoolAddSlab(pool) != 0)
+        return NULL;
+
+    void **block = (void **)pool->free_list;
+    pool->free_list = *block;
+    pool->live++;
+
+    return block;
+}
+
+/**
+ * Vita_PoolCalloc():
+ *  Same as Vita_PoolAlloc, but the block is zeroed.
+ */
+static inline void *Vita_PoolCalloc(VitaPool *pool)
+{
+    void *block = Vita_PoolAlloc(pool);
+    if(block != NULL) memset(block, 0, pool->block_size);
+
+    return block;
+}
+
+/**
+ * Vita_PoolFree():
+ *  Returns `block` (from this pool) to the free list. NULL is ignored.
+ */
+static inline void Vita_PoolFree(VitaPool *pool, void *block)
+{
+    if(block == NULL) return;
+
+    *(void **)block = pool->free_list;
+    pool->free_list = block;
+    pool->live--;
+}
+
+/**
+ * Vita_PoolDestroy():
+ *  Frees every slab. Any blocks still handed out become invalid.
+ */
+static inline void Vita_PoolDestroy(VitaPool *pool)
+{
+    VitaPoolSlab *slab = pool->slabs;
+    while(slab != NULL)
+    {
+        VitaPoolSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->live = 0;
+    pool->capacity = 0;
+}
+
+#endif // __VGL_POOL_H__
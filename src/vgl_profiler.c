@@ -0,0 +1,250 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_profiler.h"
+#include "vgl_alloc.h"
+
+// Frames ended so far. GL thread writes, any thread reads.
+static uint32_t _frame = 0;
+
+#ifdef VGL_PROFILER
+
+typedef struct _profile_event
+{
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t frame; // The frame it began in.
+    uint32_t depth;
+} ProfileEvent;
+
+// One thread's events. Only its thread writes to it; exporters read
+// `head` (acquire) to know which events are complete.
+typedef struct _profile_ring
+{
+    ProfileEvent events[VGL_PROFILER_RING_EVENTS];
+    uint64_t head; // Events ever recorded. events[head % size] is written next.
+    char name[32];
+
+    // Scopes begun but not ended yet, innermost last.
+    int depth;
+    const char *open_name[VGL_PROFILER_MAX_DEPTH];
+    uint64_t open_start[VGL_PROFILER_MAX_DEPTH];
+    uint32_t open_frame[VGL_PROFILER_MAX_DEPTH];
+} ProfileRing;
+
+// Rings are handed out once per thread & never freed, so exporters
+// can read them at any time.
+static ProfileRing *_rings[VGL_PROFILER_MAX_THREADS];
+static uint32_t _ringsClaimed = 0;
+
+static __thread ProfileRing *_threadRing;
+static __thread char _threadHasNoRing;
+
+// When the frame being recorded began.
+static uint64_t _frameStart = 0;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+/**
+ * _Vita_ThreadRing():
+ *  returns the calling thread's ring, claiming one the first time.
+ *  NULL once VGL_PROFILER_MAX_THREADS threads have one.
+ */
+static ProfileRing *_Vita_ThreadRing()
+{
+    if(_threadRing != NULL || _threadHasNoRing) return _threadRing;
+
+    uint32_t slot = __atomic_fetch_add(&_ringsClaimed, 1, __ATOMIC_RELAXED);
+    ProfileRing *ring = slot < VGL_PROFILER_MAX_THREADS ? (ProfileRing *)VGL_CALLOC(1, sizeof(ProfileRing)) : NULL;
+    if(ring == NULL)
+    {
+        _threadHasNoRing = 1;
+        return NULL;
+    }
+
+    snprintf(ring->name, sizeof(ring->name), "thread %u", slot);
+    __atomic_store_n(&_rings[slot], ring, __ATOMIC_RELEASE);
+
+    _threadRing = ring;
+    return ring;
+}
+
+static inline void _Vita_ProfileRecord(ProfileRing *ring, const char *name, uint64_t start_ns, uint64_t end_ns, uint32_t frame, int depth)
+{
+    uint64_t head = ring->head;
+    ProfileEvent *event = &ring->events[head & (VGL_PROFILER_RING_EVENTS - 1)];
+
+    event->name = name;
+    event->start_ns = start_ns;
+    event->end_ns = end_ns;
+    event->frame = frame;
+    event->depth = (uint32_t)depth;
+
+    // Publishes the event: exporters never read past head.
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static void _Vita_WriteJSONString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for(; *str != '\0'; str++)
+    {
+        unsigned char c = (unsigned char)*str;
+        if(c == '"' || c == '\\') fprintf(file, "\\%c", c);
+        else if(c < 0x20) fprintf(file, "\\u%04x", c);
+        else fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+void Vita_ProfileBegin(const char *name)
+{
+    ProfileRing *ring = _Vita_ThreadRing();
+    if(ring == NULL) return;
+
+    // Past the deepest level, scopes are only counted so ends still pair up.
+    int depth = ring->depth++;
+    if(depth >= VGL_PROFILER_MAX_DEPTH) return;
+
+    ring->open_name[depth] = name;
+    ring->open_frame[depth] = __atomic_load_n(&_frame, __ATOMIC_RELAXED);
+    ring->open_start[depth] = Vita_ProfilerNow();
+}
+
+void Vita_ProfileEnd()
+{
+    uint64_t end_ns = Vita_ProfilerNow();
+
+    ProfileRing *ring = _threadRing;
+    if(ring == NULL || ring->depth == 0) return;
+
+    int depth = --ring->depth;
+    if(depth >= VGL_PROFILER_MAX_DEPTH) return;
+
+    _Vita_ProfileRecord(ring, ring->open_name[depth], ring->open_start[depth], end_ns, ring->open_frame[depth], depth);
+}
+
+void Vita_ProfilerNameThread(const char *name)
+{
+    ProfileRing *ring = _Vita_ThreadRing();
+    if(ring == NULL || name == NULL) return;
+
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+void Vita_ProfilerEndFrame()
+{
+    uint64_t now = Vita_ProfilerNow();
+
+    // The frame itself, on the thread ending it.
+    ProfileRing *ring = _Vita_ThreadRing();
+    if(ring != NULL)
+        _Vita_ProfileRecord(ring, "frame", _frameStart != 0 ? _frameStart : now, now, _frame, ring->depth);
+
+    _frameStart = now;
+    __atomic_store_n(&_frame, _frame + 1, __ATOMIC_RELAXED);
+}
+
+int Vita_ProfilerExportTrace(const char *path, uint32_t first_frame, uint32_t last_frame)
+{
+    if(path == NULL) return -1;
+
+    ProfileEvent *copy = (ProfileEvent *)VGL_MALLOC(sizeof(ProfileEvent) * VGL_PROFILER_RING_EVENTS);
+    FILE *file = copy != NULL ? fopen(path, "w") : NULL;
+    if(file == NULL)
+    {
+        free(copy);
+        return -1;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    int written = 0;
+    const char *separator = "\n";
+
+    uint32_t ring_count = __atomic_load_n(&_ringsClaimed, __ATOMIC_RELAXED);
+    if(ring_count > VGL_PROFILER_MAX_THREADS) ring_count = VGL_PROFILER_MAX_THREADS;
+
+    for(uint32_t r = 0; r < ring_count; r++)
+    {
+        ProfileRing *ring = __atomic_load_n(&_rings[r], __ATOMIC_ACQUIRE);
+        if(ring == NULL) continue;
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", separator, r + 1);
+        _Vita_WriteJSONString(file, ring->name);
+        fprintf(file, "}}");
+        separator = ",\n";
+
+        // Copy what's complete, then drop whatever the thread may have
+        // overwritten while we were copying.
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t begin = head > VGL_PROFILER_RING_EVENTS ? head - VGL_PROFILER_RING_EVENTS : 0;
+        for(uint64_t i = begin; i < head; i++)
+            copy[i - begin] = ring->events[i & (VGL_PROFILER_RING_EVENTS - 1)];
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t head_after = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        uint64_t intact = head_after >= VGL_PROFILER_RING_EVENTS ? head_after - VGL_PROFILER_RING_EVENTS + 1 : 0;
+
+        for(uint64_t i = begin > intact ? begin : intact; i < head; i++)
+        {
+            const ProfileEvent *event = &copy[i - begin];
+            if(event->frame < first_frame || event->frame > last_frame) continue;
+
+            uint64_t duration = event->end_ns - event->start_ns;
+            fprintf(file, "%s{\"name\":", separator);
+            _Vita_WriteJSONString(file, event->name);
+            fprintf(file, ",\"cat\":\"vgl\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"args\":{\"frame\":%u}}",
+                r + 1,
+                (unsigned long long)(event->start_ns / 1000), (unsigned long long)(event->start_ns % 1000),
+                (unsigned long long)(duration / 1000), (unsigned long long)(duration % 1000),
+                event->frame);
+            written++;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    int failed = ferror(file);
+    fclose(file);
+    free(copy);
+
+    return failed ? -1 : written;
+}
+
+#else // VGL_PROFILER
+
+void Vita_ProfileBegin(const char *name) { (void)name; }
+void Vita_ProfileEnd() {}
+void Vita_ProfilerNameThread(const char *name) { (void)name; }
+
+void Vita_ProfilerEndFrame()
+{
+    __atomic_store_n(&_frame, _frame + 1, __ATOMIC_RELAXED);
+}
+
+int Vita_ProfilerExportTrace(const char *path, uint32_t first_frame, uint32_t last_frame)
+{
+    (void)path;
+    (void)first_frame;
+    (void)last_frame;
+    return -1;
+}
+
+#endif // VGL_PROFILER
+
+uint32_t Vita_ProfilerFrame()
+{
+    return __atomic_load_n(&_frame, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,150 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_PROFILER_H__
+#define __VGL_PROFILER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef VITA
+#include <psp2/kernel/processmgr.h>
+#endif
+
+/*
+    Frame profiler.
+
+    Scopes are recorded on the thread they run on, into that thread's own
+    ring buffer, so recording never takes a lock. Old events are
+    overwritten once a ring fills up.
+
+        VGL_PROFILE_SCOPE("decode");   // Until the end of the block (GCC cleanup).
+        VGL_PROFILE_BEGIN("draw");     // Or explicitly, where a block
+        ...                            // doesn't fit (gotos, loops).
+        VGL_PROFILE_END();
+
+    Scope names must be string literals (or otherwise outlive the profiler).
+    Every event is tagged with the frame it began in; Vita_Repaint ends
+    frames. Vita_ProfilerExportTrace writes any range of the frames still
+    in the rings as Chrome trace JSON, which chrome://tracing & Perfetto
+    (ui.perfetto.dev) open.
+
+    The macros only exist in builds with VGL_PROFILER defined (cmake
+    -DVGL_PROFILER=ON). Without it they compile to nothing, and the
+    functions below are stubs.
+*/
+
+// Stages of a frame Vita_Repaint always times, profiler or not.
+// See Vita_GetFrameTimings.
+#define VGL_TIMING_FRAME 0  // One Vita_Repaint's end to the next: the whole frame.
+#define VGL_TIMING_UPLOAD 1 // Texture uploads (Vita_PumpTextureUploads).
+#define VGL_TIMING_SORT 2   // Sorting the frame's draws (Vita_SetSorting).
+#define VGL_TIMING_SUBMIT 3 // Buffering the frame's vertices to the GPU.
+#define VGL_TIMING_DRAW 4   // Every pass's batches.
+#define VGL_TIMING_SWAP 5   // Presenting (& polling events on PC).
+#define VGL_TIMING_COUNT 6
+
+// Shading pass slots Vita_Repaint can time.
+#define VGL_TIMING_MAX_PASSES 6
+
+typedef struct _vita_frame_timings
+{
+    uint32_t frame; // Vita_ProfilerFrame when it was recorded.
+    float cpu_ms[VGL_TIMING_COUNT]; // Wall time spent on the calling thread.
+
+    // GPU time (see vgl_gpu_timer.h), read back a few frames late:
+    // gpu_frame is the frame measured. Only _FRAME, _UPLOAD & _DRAW are
+    // measured; everything is -1 without timer queries.
+    uint32_t gpu_frame;
+    float gpu_ms[VGL_TIMING_COUNT];
+    float gpu_pass_ms[VGL_TIMING_MAX_PASSES]; // By pass slot, -1 for passes not drawn.
+} VitaFrameTimings;
+
+// Events each thread's ring holds. Must be a power of 2.
+#ifndef VGL_PROFILER_RING_EVENTS
+#define VGL_PROFILER_RING_EVENTS 8192
+#endif
+
+// Most threads that can record. Scopes on threads past it are dropped.
+#define VGL_PROFILER_MAX_THREADS 8
+
+// Deepest scope nesting recorded per thread. Deeper scopes are dropped.
+#define VGL_PROFILER_MAX_DEPTH 32
+
+/**
+ * Vita_ProfilerNow():
+ *  returns a monotonic wall clock, in nanoseconds.
+ */
+static inline uint64_t Vita_ProfilerNow()
+{
+#ifdef VITA
+    return (uint64_t)sceKernelGetProcessTimeWide() * 1000;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+void Vita_ProfileBegin(const char *name);
+void Vita_ProfileEnd();
+
+static inline void _Vita_ProfileScopeEnd(char *scope)
+{
+    (void)scope;
+    Vita_ProfileEnd();
+}
+
+#ifdef VGL_PROFILER
+#define _VGL_PROFILE_CONCAT2(a, b) a##b
+#define _VGL_PROFILE_CONCAT(a, b) _VGL_PROFILE_CONCAT2(a, b)
+
+#define VGL_PROFILE_BEGIN(name) Vita_ProfileBegin(name)
+#define VGL_PROFILE_END() Vita_ProfileEnd()
+#define VGL_PROFILE_SCOPE(name) \
+    __attribute__((cleanup(_Vita_ProfileScopeEnd))) char _VGL_PROFILE_CONCAT(_vgl_profile_scope_, __LINE__) = (Vita_ProfileBegin(name), 0)
+#else
+#define VGL_PROFILE_BEGIN(name) ((void)0)
+#define VGL_PROFILE_END() ((void)0)
+#define VGL_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+/**
+ * Vita_ProfilerNameThread():
+ *  Names the calling thread in exported traces ("GL", "loader 0", ...).
+ *  `name` is copied.
+ */
+void Vita_ProfilerNameThread(const char *name);
+
+/**
+ * Vita_ProfilerEndFrame():
+ *  Records the frame that just ended & starts the next one.
+ *  Called at the end of Vita_Repaint.
+ */
+void Vita_ProfilerEndFrame();
+
+/**
+ * Vita_ProfilerFrame():
+ *  returns the number of the frame being recorded. Frames count up from 0.
+ */
+uint32_t Vita_ProfilerFrame();
+
+/**
+ * Vita_ProfilerExportTrace():
+ *  Writes every event still in the rings from frames `first_frame`
+ *  to `last_frame` (inclusive) to `path`, as Chrome trace JSON.
+ *  Best called from the GL thread between frames; scopes other threads
+ *  are recording meanwhile may be left out.
+ *
+ *  returns the number of events written, -1 if the file couldn't be
+ *  written or the profiler isn't compiled in.
+ */
+int Vita_ProfilerExportTrace(const char *path, uint32_t first_frame, uint32_t last_frame);
+
+#endif // __VGL_PROFILER_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,248 @@
+#ifndef __VGL_PROGRAM_CACHE_H__
+#define __VGL_PROGRAM_CACHE_H__
+
+#if defined(VGL_NULL_BACKEND)
+#include "vgl_null_gl.h"
+#include <sys/stat.h>
+#elif defined(__APPLE__) || defined(PC_BUILD)
+#include <GL/glew.h>
+#include <sys/stat.h>
+#else
+#include <vitasdk.h>
+#include <vitaGL.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vgl_alloc.h"
+
+/*
+    On-disk program binary cache.
+
+    Every linked program is stored as `<dir>/<key>.vgpb`, where key is a
+    hash of both shader sources along with the GL vendor, renderer and
+    version strings. A driver update changes the key, so stale binaries
+    are simply never looked up again.
+
+    File layout:
+        ProgramCacheHeader
+        binary (header.length bytes)
+*/
+
+#define PROGRAM_CACHE_MAGIC 0x42504756 // 'VGPB'
+#define PROGRAM_CACHE_VERSION 1
+
+typedef struct _program_cache_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binary_format;
+    uint32_t length;
+} __attribute__ ((packed)) ProgramCacheHeader;
+
+// GL_PROGRAM_BINARY_LENGTH only exists on GL versions/ports
+// that can hand us program binaries in the first place.
+#if defined(GL_PROGRAM_BINARY_LENGTH)
+#define PROGRAM_CACHE_SUPPORTED 1
+#endif
+
+static inline uint64_t _Vita_FNV1a64(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static inline uint64_t _Vita_FNV1a64Str(uint64_t hash, const char *str)
+{
+    if(str == NULL) return hash;
+    // Hash the terminator too, so ("ab", "c") != ("a", "bc").
+    return _Vita_FNV1a64(hash, str, strlen(str) + 1);
+}
+
+/**
+ * Vita_ProgramCacheKey():
+ *  Builds the cache key for a vertex/fragment source pair
+ *  on the currently bound GL context.
+ */
+static inline uint64_t Vita_ProgramCacheKey(const char *vert_src, const char *frag_src)
+{
+    uint64_t key = 0xcbf29ce484222325ULL;
+    uint32_t version = PROGRAM_CACHE_VERSION;
+
+    key = _Vita_FNV1a64(key, &version, sizeof(version));
+    key = _Vita_FNV1a64Str(key, vert_src);
+    key = _Vita_FNV1a64Str(key, frag_src);
+    key = _Vita_FNV1a64Str(key, (const char *)glGetString(GL_VENDOR));
+    key = _Vita_FNV1a64Str(key, (const char *)glGetString(GL_RENDERER));
+    key = _Vita_FNV1a64Str(key, (const char *)glGetString(GL_VERSION));
+
+    return key;
+}
+
+/**
+ * Vita_ProgramCacheAvailable():
+ *  returns 1 if the current context can save & restore program binaries.
+ */
+static inline int Vita_ProgramCacheAvailable()
+{
+#ifdef PROGRAM_CACHE_SUPPORTED
+#if defined(__APPLE__) || defined(PC_BUILD)
+    if(!GLEW_ARB_get_program_binary) return 0;
+#endif
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+#else
+    return 0;
+#endif
+}
+
+static inline void _Vita_ProgramCachePath(char *out, size_t out_size, const char *dir, uint64_t key)
+{
+    snprintf(out, out_size, "%s/%016llx.vgpb", dir, (unsigned long long)key);
+}
+
+/**
+ * Vita_ProgramCacheLoad():
+ *  Attempts to create a linked program from the binary cached under `key`.
+ *
+ * returns:
+ *  the program object ID, or 0 on a miss. A cached binary the driver
+ *  refuses to link is treated as stale: it is deleted and 0 is returned.
+ */
+static inline GLuint Vita_ProgramCacheLoad(const char *dir,
+    uint64_t key,
+    void (*debugPrintf)(const char*, ...)
+)
+{
+#ifdef PROGRAM_CACHE_SUPPORTED
+    if(dir == NULL || !Vita_ProgramCacheAvailable()) return 0;
+
+    char path[512];
+    _Vita_ProgramCachePath(path, sizeof(path), dir, key);
+
+    FILE *_file = fopen(path, "rb");
+    if(_file == NULL) return 0;
+
+    ProgramCacheHeader header;
+    if(fread(&header, sizeof(header), 1, _file) != 1
+        || header.magic != PROGRAM_CACHE_MAGIC
+        || header.version != PROGRAM_CACHE_VERSION
+        || header.key != key
+        || header.length == 0)
+    {
+        fclose(_file);
+        debugPrintf("[program_cache] %s is not a valid cache entry. Ignoring it.\n", path);
+        remove(path);
+        return 0;
+    }
+
+    void *binary = VGL_MALLOC(header.length);
+    if(binary == NULL || fread(binary, header.length, 1, _file) != 1)
+    {
+        free(binary);
+        fclose(_file);
+        return 0;
+    }
+    fclose(_file);
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binary_format, binary, header.length);
+    free(binary);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(!linked)
+    {
+        debugPrintf("[program_cache] Stale binary %s (driver refused it). Recompiling.\n", path);
+        glDeleteProgram(program);
+        remove(path);
+        return 0;
+    }
+
+    debugPrintf("[program_cache] Hit: %s\n", path);
+    return program;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Vita_ProgramCacheStore():
+ *  Writes the binary of a linked `program` to the cache under `key`.
+ *
+ *  returns 0 on success.
+ */
+static inline int Vita_ProgramCacheStore(const char *dir,
+    uint64_t key,
+    GLuint program,
+    void (*debugPrintf)(const char*, ...)
+)
+{
+#ifdef PROGRAM_CACHE_SUPPORTED
+    if(dir == NULL || program == 0 || !Vita_ProgramCacheAvailable()) return -1;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) return -1;
+
+    void *binary = VGL_MALLOC(length);
+    if(binary == NULL) return -1;
+
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary);
+
+#ifdef VITA
+    sceIoMkdir(dir, 0777);
+#else
+    mkdir(dir, 0755);
+#endif
+
+    char path[512];
+    _Vita_ProgramCachePath(path, sizeof(path), dir, key);
+
+    FILE *_file = fopen(path, "wb");
+    if(_file == NULL)
+    {
+        debugPrintf("[program_cache] Could not open %s for writing.\n", path);
+        free(binary);
+        return -1;
+    }
+
+    ProgramCacheHeader header;
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binary_format = format;
+    header.length = length;
+
+    int ok = fwrite(&header, sizeof(header), 1, _file) == 1
+        && fwrite(binary, length, 1, _file) == 1;
+
+    fclose(_file);
+    free(binary);
+
+    if(!ok)
+    {
+        remove(path);
+        return -1;
+    }
+
+    debugPrintf("[program_cache] Stored %s (%d bytes)\n", path, length);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+#endif // __VGL_PROGRAM_CACHE_H__
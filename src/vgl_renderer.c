@@ -4,10 +4,16 @@ extern "C" {
 
 #include "vgl_renderer.h"
 
+#include <math.h>
 #include <cglm/cglm.h>
 #include <cglm/clipspace/ortho_lh_zo.h>
 
 #include "SHADERS.h"
+#include "vgl_program_cache.h"
+#include "vgl_texture_loader.h"
+#include "vgl_ex_data.h"
+#include "vgl_gpu_timer.h"
+#include "vgl_cull.h"
 
 #ifndef nullptr
 #define nullptr 0
@@ -15,7 +21,7 @@ extern "C" {
 
 // #define EXPERIMENTAL_SORTING
 
-#ifndef VITA
+#ifdef VGL_GLFW_WINDOW
 static GLFWwindow* _game_window;
 #endif
 
@@ -29,26 +35,8 @@ static int DISPLAY_WIDTH = 960;
 // The height of the display.
 static int DISPLAY_HEIGHT = 544;
 
-// The attribute location index for the vertex position in the shader.
-static int VERTEX_POS_INDEX = 0;
-
-// Attribute location index for tex coordinates in the shader.
-static int VERTEX_TEXCOORD_INDEX = 0;
-
-// Attribute location index for color in the shader.
-static int VERTEX_COLOR_INDEX = 0;
-
-// UNIFFORM location index for the MVP in the shader.
-static int VERTEX_MVP_INDEX = 3;
-
-// Uniform location index for the rotation matrix in the shader.
-static int UNIFORM_ROTMAT_INDEX = 4;
-
-// Uniform location index for the scale matrix in the shader.
-static int UNIFORM_SCALE_INDEX = 5;
-
-// Uniform location index for the `useTexture` flag in the shader.
-static int UNIFORM_USE_TEXTURE_BOOL_INDEX = 0;
+// Attribute & uniform locations are cached per program
+// in each ShadingPass (see _Vita_CacheShaderLocations).
 
 // Uniform location index for the sampler2D that IS the texture in the shader.
 // More than likely, this is set automatically just by calling `glBindBuffer`. 
@@ -75,8 +63,81 @@ static DrawCall *_vgl_current_write_buffer;
 static unsigned int _vgl_pending_offset; // INDEX
 static size_t _vgl_pending_total_size; // SIZE IN BYTES
 static unsigned int _DrawCalls = 0; // DRAW CALL COUNT
+
+// Where each pending call was made from, swapped along with the call
+// buffers, for batch diagnostics (vgl_batch_breaks.h). NULL until
+// diagnostics are first turned on.
+static const void **_callSitesA;
+static const void **_callSitesB;
+static const void **_vgl_pending_sites;
+static const void **_vgl_current_write_sites;
+
+// Which pending call each one left after culling was, see Vita_CullQuads.
+static uint32_t *_keptFrom;
+
+// The frame being drawn's call sites & original call indices,
+// NULL if unknown / unchanged (see _Vita_RecordBreak).
+static const void **_frameSites;
+static const uint32_t *_frameOrder;
+
+// Draw functions wrapping another pass their caller on through this.
+static const void *_wrappedCallSite;
+
+// The game code the current draw function was called from.
+#define VGL_CALL_SITE() (_wrappedCallSite != NULL ? _wrappedCallSite : __builtin_return_address(0))
 // ------------------------------------------ END SHADERS 
 
+// ------------------------------------------ ARENAS
+
+// Transient allocations. Reset at the end of every Vita_Repaint.
+static VitaArena _frameArena;
+
+// Short lived allocations inside renderer calls (shader logs, variant source...).
+static VitaArena _scratchArena;
+
+#ifdef DEBUG_BUILD
+unsigned long _vgl_heap_allocations = 0;
+static unsigned long _frameStartHeapAllocations = 0;
+#endif
+static unsigned long _lastFrameHeapAllocations = 0;
+
+// ------------------------------------------ END ARENAS
+
+// ------------------------------------------ TIMINGS
+
+// The frame being timed, and the last one timed in full (Vita_GetFrameTimings).
+static VitaFrameTimings _curTimings;
+static VitaFrameTimings _frameTimings;
+
+// When the last Vita_Repaint ended.
+static uint64_t _lastFrameEndNs = 0;
+
+// Where the GPU timer's results are read into, every frame.
+static VitaGPUTimings _gpuTimings;
+
+// What the frame being drawn did (Vita_GetFrameStats).
+static VitaFrameStats _curStats;
+
+// Off screen sprites are dropped before uploading (Vita_SetCulling).
+static char _cullingEnabled = 1;
+
+// Calls are sorted by texture before drawing (Vita_SetSorting).
+// Building with EXPERIMENTAL_SORTING turns it on by default.
+#ifdef EXPERIMENTAL_SORTING
+static char _sortingEnabled = 1;
+#else
+static char _sortingEnabled = 0;
+#endif
+
+// Calls with the same state share a draw (Vita_SetBatching).
+static char _batchingEnabled = 1;
+
+#ifdef DEBUG_BUILD
+static uint64_t _lastStatsPrintNs = 0;
+#endif
+
+// ------------------------------------------ END TIMINGS
+
 // ------------------------------------------ PASSES
 
 // An array of passes. If any passes have a program ID 
@@ -89,6 +150,16 @@ static ShadingPass _shading_passes[6];
 
 // The total number of real passes in the buffer (real = program object ID != 0)
 static unsigned int _ShadingPasses = 1;
+
+// Index of the default pass in _shading_passes.
+#define DEFAULT_PASS_INDEX 2
+
+// Total number of pass slots in _shading_passes.
+#define MAX_SHADING_PASSES 6
+
+#if MAX_SHADING_PASSES > VGL_TIMING_MAX_PASSES
+#error "VitaFrameTimings can't hold every pass's timings."
+#endif
 // ------------------------------------------
 
 // ------------------------------------------   BUFFERS
@@ -96,6 +167,20 @@ static unsigned int _ShadingPasses = 1;
 // The default ID of the VBO we'll be writing
 // draw calls to.
 static GLuint _vertexBufferID;
+
+// Static index buffer turning every 4 vertex quad into 2 triangles.
+// This lets a whole batch of quads go out in a single glDrawElements.
+static GLuint _indexBufferID;
+
+#define INDICES_PER_QUAD 6
+
+#if MAX_VERTICES > VGL_MAX_SHORT_INDEXED_QUADS
+typedef GLuint VitaIndex;
+#define VGL_INDEX_TYPE GL_UNSIGNED_INT
+#else
+typedef GLushort VitaIndex;
+#define VGL_INDEX_TYPE GL_UNSIGNED_SHORT
+#endif
 // ------------------------------------------ END BUFFERS
 
 // ------------------------------------------   SHADERS
@@ -114,6 +199,14 @@ static GLint fragmentShaderID;
 // This either the embedded default vert & frag shaders linked together
 // OR the shaders specified in initGLShading2 linked together.
 static GLint programObjectID;
+
+// The VGL_SHADER_* features every batch is drawn with.
+// VGL_SHADER_PER_BATCH features are added per batch.
+static unsigned int _shaderFeatures = VGL_SHADER_VERTEX_COLOR;
+
+// Directory linked program binaries are cached in.
+// NULL disables the program cache.
+static char *_programCacheDir;
 // ------------------------------------------ END SHADERS
 
 // ------------------------------------------   MAT BUFFERS
@@ -143,20 +236,175 @@ mat4 _scale_arb;
 // ------------------------------------------   INTERNAL FUNCTIONS
 
 
+/**
+ * _Vita_SortDrawCalls():
+ *  qsort comparator ordering draw calls by texture, then palette, then
+ *  submission order. Calls without extra data sort as texture 0. Every call's
+ *  z is (MAX_VERTICES - its index) / MAX_VERTICES, so the higher z was
+ *  submitted first: that keeps the order total & the same frame to frame.
+ */
 static inline int _Vita_SortDrawCalls(const void *s1, const void *s2)
 {
-    DrawCall *dc1 = (DrawCall *)s1;
-    DrawCall *dc2 = (DrawCall *)s2;
+    const DrawCall *dc1 = (const DrawCall *)s1;
+    const DrawCall *dc2 = (const DrawCall *)s2;
+
+    const obj_extra_data *ex1 = Vita_GetExData(dc1->draw.verts_quad[0].ex_data);
+    const obj_extra_data *ex2 = Vita_GetExData(dc2->draw.verts_quad[0].ex_data);
+
+    unsigned int tex1 = (ex1 != NULL) ? ex1->textureID : 0;
+    unsigned int tex2 = (ex2 != NULL) ? ex2->textureID : 0;
+    if(tex1 != tex2) return (tex1 > tex2) - (tex1 < tex2);
+
+    // As _Vita_DrawPass sees it: untextured calls have no palette.
+    unsigned int pal1 = (tex1 != 0) ? ex1->paletteID : 0;
+    unsigned int pal2 = (tex2 != 0) ? ex2->paletteID : 0;
+    if(pal1 != pal2) return (pal1 > pal2) - (pal1 < pal2);
+
+    float z1 = dc1->draw.verts_quad[0].z;
+    float z2 = dc2->draw.verts_quad[0].z;
+    return (z1 < z2) - (z1 > z2);
+}
+
+
+static GLuint _Vita_BuildProgram(const char *vert_src, const char *frag_src, GLuint *vs_out, GLuint *fs_out);
+static void _Vita_CacheShaderLocations(GLuint program, ShaderLocations *loc);
+
+/**
+ * _Vita_PrependShaderDefines():
+ *  Returns a copy of `src`, in the scratch arena, with a `#define`
+ *  for every VGL_SHADER_* bit set in `features`. A leading #version
+ *  line is kept first, as GLSL requires.
+ *  returns NULL if the source doesn't fit in the scratch arena.
+ */
+static char *_Vita_PrependShaderDefines(const char *src, unsigned int features)
+{
+    char defines[256];
+    int defines_len = snprintf(defines, sizeof(defines), "%s%s%s%s%s%s",
+        (features & VGL_SHADER_TEXTURED) ? "#define VGL_TEXTURED 1\n" : "",
+        (features & VGL_SHADER_ALPHA_TEST) ? "#define VGL_ALPHA_TEST 1\n" : "",
+        (features & VGL_SHADER_VERTEX_COLOR) ? "#define VGL_VERTEX_COLOR 1\n" : "",
+        (features & VGL_SHADER_PREMULTIPLIED) ? "#define VGL_PREMULTIPLIED 1\n" : "",
+        (features & VGL_SHADER_PALETTE) ? "#define VGL_PALETTE 1\n" : "",
+        (features & VGL_SHADER_PALETTE4) ? "#define VGL_PALETTE4 1\n" : ""
+    );
 
-    if(dc1->draw.verts_quad[0].obj_ptr != NULL 
-        && dc2->draw.verts_quad[0].obj_ptr != NULL)
+    size_t src_len = strlen(src);
+    size_t head = 0;
+    if(strncmp(src, "#version", 8) == 0)
     {
-        return (((obj_extra_data *)dc1->draw.verts_quad[0].obj_ptr)->textureID) - (((obj_extra_data *)dc2->draw.verts_quad[0].obj_ptr)->textureID);
+        const char *newline = strchr(src, '\n');
+        head = (newline != NULL) ? (size_t)(newline - src) + 1 : src_len;
     }
 
-    return +1;
+    char *out = (char *)Vita_ScratchAlloc(src_len + defines_len + 1);
+    if(out == NULL) return NULL;
+
+    memcpy(out, src, head);
+    memcpy(out + head, defines, defines_len);
+    memcpy(out + head + defines_len, src + head, (src_len - head) + 1);
+
+    return out;
 }
 
+/**
+ * _Vita_GetVariant():
+ *  Returns the variant of `pass` built with `features`,
+ *  building it first if this is the first time it's asked for.
+ * 
+ *  If the variant fails to build, the pass's base variant
+ *  is returned instead. returns NULL if neither exists.
+ */
+static ShaderVariant *_Vita_GetVariant(ShadingPass *pass, unsigned int features)
+{
+    ShaderVariant *variant = &pass->Variants[features & (VGL_SHADER_VARIANT_COUNT - 1)];
+
+    if(!variant->Built)
+    {
+        variant->Built = 1;
+
+        size_t scratch = Vita_ScratchBegin();
+        char *vert_src = _Vita_PrependShaderDefines(pass->VertexSource, features);
+        char *frag_src = _Vita_PrependShaderDefines(pass->FragmentSource, features);
+
+        GLuint _vs = 0, _fs = 0;
+        if(vert_src != NULL && frag_src != NULL)
+            variant->ProgramObjectID = _Vita_BuildProgram(vert_src, frag_src, &_vs, &_fs);
+        else
+            _debugPrintf("ERROR: Shader source is too big for the scratch arena (%d bytes).\n", VGL_SCRATCH_ARENA_SIZE);
+
+        Vita_ScratchEnd(scratch);
+
+        if(variant->ProgramObjectID != 0)
+        {
+            if(pass->VertexShaderID == 0)
+            {
+                pass->VertexShaderID = _vs;
+                pass->FragmentShaderID = _fs;
+            }
+
+            _Vita_CacheShaderLocations(variant->ProgramObjectID, &variant->Locations);
+            _debugPrintf("Built shader variant 0x%x (program %d)\n", features, variant->ProgramObjectID);
+        }
+        else _debugPrintf("WARNING: Shader variant 0x%x failed to build.\n", features);
+    }
+
+    if(variant->ProgramObjectID == 0)
+    {
+        variant = &pass->Variants[pass->BaseFeatures];
+        if(variant->ProgramObjectID == 0) return NULL;
+    }
+
+    return variant;
+}
+
+/**
+ * _Vita_InitPass():
+ *  Sets up `pass` to build its variants from the given source
+ *  and builds the textured & untextured variants for the current
+ *  shader features right away, so the first frame doesn't hitch.
+ * 
+ *  returns 0 if the base (textured) variant built.
+ */
+static int _Vita_InitPass(ShadingPass *pass, const char *vert_src, const char *frag_src)
+{
+    memset(pass, 0, sizeof(ShadingPass));
+
+    pass->VertexSource = VGL_STRDUP(vert_src);
+    pass->FragmentSource = VGL_STRDUP(frag_src);
+    pass->BaseFeatures = _shaderFeatures | VGL_SHADER_TEXTURED;
+
+    ShaderVariant *base = _Vita_GetVariant(pass, pass->BaseFeatures);
+    if(base == NULL)
+    {
+        free(pass->VertexSource);
+        free(pass->FragmentSource);
+        memset(pass, 0, sizeof(ShadingPass));
+        return -1;
+    }
+
+    _Vita_GetVariant(pass, _shaderFeatures & ~VGL_SHADER_TEXTURED);
+
+    pass->ProgramObjectID = base->ProgramObjectID;
+    pass->Locations = base->Locations;
+    return 0;
+}
+
+/**
+ * _Vita_FreePass():
+ *  Deletes every built variant of `pass` and clears it.
+ */
+static void _Vita_FreePass(ShadingPass *pass)
+{
+    for(int i = 0; i < VGL_SHADER_VARIANT_COUNT; i++)
+    {
+        if(pass->Variants[i].ProgramObjectID != 0)
+            glDeleteProgram(pass->Variants[i].ProgramObjectID);
+    }
+
+    free(pass->VertexSource);
+    free(pass->FragmentSource);
+    memset(pass, 0, sizeof(ShadingPass));
+}
 
 /**
  * Vita_AddPass():
@@ -177,22 +425,22 @@ static inline void Vita_AddPass(ShadingPass passInfo, int order)
 {
     if(passInfo.ProgramObjectID <= 0) return;
 
-    int idx = 2 + order;
+    int idx = DEFAULT_PASS_INDEX + order;
 
     _debugPrintf("VITA_ADDPASS PROGRAM: %d at index: %d (specified order: %d)\n", passInfo.ProgramObjectID, idx, order);
 
     // (count - 1) - order
-    if(idx < 0 || idx > 5)
+    if(idx < 0 || idx >= MAX_SHADING_PASSES)
     {
         return;
     }
 
-    _shading_passes[idx].FragmentShaderID = passInfo.FragmentShaderID;
-    _shading_passes[idx].ProgramObjectID = passInfo.ProgramObjectID;
-    _shading_passes[idx].VertexShaderID = passInfo.VertexShaderID;
-    _shading_passes[idx].offset_x = passInfo.offset_x;
-    _shading_passes[idx].offset_y = passInfo.offset_y;
+    if(_shading_passes[idx].ProgramObjectID == 0)
+        _ShadingPasses++;
+    else
+        _Vita_FreePass(&_shading_passes[idx]);
 
+    _shading_passes[idx] = passInfo;
 }
 
 /**
@@ -202,9 +450,10 @@ static inline void Vita_AddPass(ShadingPass passInfo, int order)
  */
 static inline DrawCall *_Vita_GetAvailableDrawCall()
 {
-    if((_vgl_pending_offset + 1) > _vgl_pending_total_size)
+    // _vgl_pending_total_size is in bytes, the buffers hold MAX_VERTICES calls.
+    if((_vgl_pending_offset + 1) > MAX_VERTICES)
     {
-        _debugPrintf("Ran out of draw calls. %d / %zu\n", _vgl_pending_offset, _vgl_pending_total_size);
+        _debugPrintf("Ran out of draw calls. %d / %d\n", _vgl_pending_offset, MAX_VERTICES);
         return NULL;
     }
 
@@ -215,9 +464,13 @@ static inline DrawCall *_Vita_GetAvailableDrawCall()
  * _Vita_DoneWithDrawCall():
  *  Concludes the draw call by incrementing 
  *  _vgl_pending_offset and _DrawCalls variables.
+ *  `site` is where it was made from (VGL_CALL_SITE).
  */
-static inline void _Vita_DoneWithDrawCall()
+static inline void _Vita_DoneWithDrawCall(const void *site)
 {
+    if(_vgl_current_write_sites != NULL)
+        _vgl_current_write_sites[_vgl_pending_offset] = site;
+
     _vgl_pending_offset += 1;
     _DrawCalls++;
 }
@@ -335,6 +588,10 @@ static inline void _Vita_SwapBuffers()
 
     _vgl_pending_calls = _vgl_current_write_buffer;
     _vgl_current_write_buffer = _curDrawBuffer;
+
+    const void **_curDrawSites = _vgl_pending_sites;
+    _vgl_pending_sites = _vgl_current_write_sites;
+    _vgl_current_write_sites = _curDrawSites;
 }
 
 static inline void Vita_ResetTotalCalls()
@@ -368,14 +625,15 @@ GLuint LoadShader(GLenum type, const char *shaderSrc)
         GLint infoLen = 0;
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
 
-        if(infoLen > 1)
-        {
-            char *infoLog = (char*)malloc(sizeof(char) * infoLen);
+        size_t scratch = Vita_ScratchBegin();
+        char *infoLog = (infoLen > 1) ? (char*)Vita_ScratchAlloc(sizeof(char) * infoLen) : NULL;
 
+        if(infoLog != NULL)
+        {
             glGetShaderInfoLog(shader, infoLen, NULL, infoLog);
             _debugPrintf("\n\nError Compiling Shader:\n\n%s\n", infoLog);
-            free(infoLog);
         }
+        Vita_ScratchEnd(scratch);
 
         glDeleteShader(shader);
         return 0;
@@ -384,6 +642,155 @@ GLuint LoadShader(GLenum type, const char *shaderSrc)
     return shader;
 }
 
+/**
+ * _Vita_BuildProgram():
+ *  Creates a linked program from the given vertex & fragment source.
+ * 
+ *  The program cache is checked first. On a miss (or a stale entry)
+ *  the sources are compiled & linked as usual and the binary is stored
+ *  back into the cache for the next launch.
+ * 
+ *  vs_out & fs_out receive the shader objects. Both are 0 when the
+ *  program came straight from the cache.
+ * 
+ *  returns the program object ID, 0 on failure.
+ */
+static GLuint _Vita_BuildProgram(const char *vert_src, const char *frag_src, GLuint *vs_out, GLuint *fs_out)
+{
+    *vs_out = 0;
+    *fs_out = 0;
+
+    uint64_t key = 0;
+    if(_programCacheDir != NULL)
+    {
+        key = Vita_ProgramCacheKey(vert_src, frag_src);
+
+        GLuint cached = Vita_ProgramCacheLoad(_programCacheDir, key, _debugPrintf);
+        if(cached != 0) return cached;
+    }
+
+    GLuint _vs = LoadShader(GL_VERTEX_SHADER, vert_src);
+    if(_vs == 0)
+    {
+        _debugPrintf("ERROR: vertex shader ID: %d\n", _vs);
+        return 0;
+    }
+    CHECK_GL_ERROR("Vertex Shader");
+
+    GLuint _fs = LoadShader(GL_FRAGMENT_SHADER, frag_src);
+    if(_fs == 0)
+    {
+        _debugPrintf("ERROR: frag shader ID: %d\n", _fs);
+        glDeleteShader(_vs);
+        return 0;
+    }
+    CHECK_GL_ERROR("Frag Shader");
+
+    GLuint program = glCreateProgram();
+    CHECK_GL_ERROR("Make Program Shader");
+
+    if(program == 0)
+    {
+        _debugPrintf("ERROR: Program object is 0.\n");
+        glDeleteShader(_vs);
+        glDeleteShader(_fs);
+        return 0;
+    }
+
+    glAttachShader(program, _vs);
+    glAttachShader(program, _fs);
+    CHECK_GL_ERROR("Shader Attach");
+
+#ifdef PROGRAM_CACHE_SUPPORTED
+    if(_programCacheDir != NULL && Vita_ProgramCacheAvailable())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+
+    glLinkProgram(program);
+    CHECK_GL_ERROR("LINK PROGRRAM");
+
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    CHECK_GL_ERROR("Get Program Info Value");
+
+    if(!linked)
+    {
+        _debugPrintf("!!!!! ERROR: Could not link shader.\n");
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+        size_t scratch = Vita_ScratchBegin();
+        char* log = (length > 1) ? (char*)Vita_ScratchAlloc(length) : NULL;
+
+        if(log != NULL)
+        {
+            glGetProgramInfoLog(program, length, &length, log);
+            _debugPrintf("Error Message: %s\n", log);
+        }
+        Vita_ScratchEnd(scratch);
+
+        glDeleteShader(_vs);
+        glDeleteShader(_fs);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    if(_programCacheDir != NULL)
+        Vita_ProgramCacheStore(_programCacheDir, key, program, _debugPrintf);
+
+    *vs_out = _vs;
+    *fs_out = _fs;
+    return program;
+}
+
+/**
+ * _Vita_CacheShaderLocations():
+ *  Looks up every attribute & uniform location the repaint
+ *  loop needs from a linked `program` and stores them in `loc`.
+ * 
+ *  Locations the program doesn't use (eg: a fragment-only pass
+ *  that ignores vColor) come back as -1 and are skipped when drawing.
+ */
+static void _Vita_CacheShaderLocations(GLuint program, ShaderLocations *loc)
+{
+#ifdef VITA
+    loc->PositionAttrib = glGetAttribLocation(program, "aPosition");
+#else
+    loc->PositionAttrib = glGetAttribLocation(program, "vPosition"); // Vertex position.
+#endif
+    loc->TexCoordAttrib = glGetAttribLocation(program, "vTexCoord"); // Vertex Tex Coord.
+    loc->ColorAttrib = glGetAttribLocation(program, "vColor"); // Gets passed to the fragment shader.
+
+    // Uniforms
+    loc->MVPUniform = glGetUniformLocation(program, "mvp"); // MVP matrix. In our case, this is an ortho matrix for the Vita's screen.
+    loc->RotUniform = glGetUniformLocation(program, "_rot");
+    loc->ScaleUniform = glGetUniformLocation(program, "_scale");
+    loc->UseTextureUniform = glGetUniformLocation(program, "useTexture");
+    loc->OffsetUniform = glGetUniformLocation(program, "_offset"); // Per pass offset, in clip space.
+    loc->PaletteUniform = glGetUniformLocation(program, "ourPalette"); // Palette variants only, always unit 1.
+    loc->IndexWidthUniform = glGetUniformLocation(program, "ourIndexWidth");
+}
+
+/**
+ * _Vita_CheckExData():
+ *  Stores `texId` in the extra data behind `ex_data` for the repaint loop.
+ *  returns `ex_data`, or VGL_EX_DATA_NONE if the handle is stale.
+ */
+static inline VitaExDataHandle _Vita_CheckExData(VitaExDataHandle ex_data, GLuint texId)
+{
+    if(ex_data == VGL_EX_DATA_NONE) return VGL_EX_DATA_NONE;
+
+    obj_extra_data *data = Vita_GetExData(ex_data);
+    if(data == NULL)
+    {
+        _debugPrintf("WARNING: Drawing with stale ex data handle %08x. Ignoring it.\n", ex_data);
+        return VGL_EX_DATA_NONE;
+    }
+
+    data->textureID = texId;
+    return ex_data;
+}
+
 // ------------------------------------------   END INTERNAL FUNCTIONS
 
 // ------------------------------------------   EXPOSED 2D DRAW FUNCTIONS
@@ -404,12 +811,18 @@ void Vita_DrawRect4xColor(float x, float y,
     // _drawTypes[_DrawCalls] = GL_TRIANGLE_STRIP;
     // _curDrawCall->draw_type = GL_TRIANGLE_STRIP;
 
+    if(_curDrawCall == NULL)
+    {
+        _debugPrintf("WARNING: Got null draw call.\n");
+        return;
+    }
+
     for(int i = 0; i < 4; i++)
-        _curDrawCall->draw.verts_quad[i].obj_ptr = 0;
+        _curDrawCall->draw.verts_quad[i].ex_data = VGL_EX_DATA_NONE;
 
     _Vita_WriteVertices4xColor(_curDrawCall, x, y, wDst, hDst, 0.f, 1.f, 0.f, 1.f, rgba0, rgba1, rgba2, rgba3);
 
-    _Vita_DoneWithDrawCall();
+    _Vita_DoneWithDrawCall(VGL_CALL_SITE());
 }
 
 
@@ -425,7 +838,9 @@ void Vita_DrawRectColor(float x, float y,
                         float _a)
 {
     float rgba0[4] = {_r, _g, _b, _a};
+    _wrappedCallSite = __builtin_return_address(0);
     Vita_DrawRect4xColor(x, y, wDst, hDst, rgba0, rgba0, rgba0, rgba0);
+    _wrappedCallSite = NULL;
 }
 
 /**
@@ -439,19 +854,24 @@ void Vita_DrawRectColorExData(float x, float y,
                            float _g,
                            float _b,
                            float _a,
-                           obj_extra_data *ex_data)
+                           VitaExDataHandle ex_data)
 {
     float rgba0[4] = {_r, _g, _b, _a};
     DrawCall *_curDrawCall = _Vita_GetAvailableDrawCall();
     // _drawTypes[_DrawCalls] = GL_TRIANGLE_STRIP;
 
-    if(ex_data != NULL)
-        ex_data->textureID = 0;
+    if(_curDrawCall == NULL)
+    { 
+        _debugPrintf("WARNING: Got null draw call.\n");
+        return;
+    }
+
+    ex_data = _Vita_CheckExData(ex_data, 0);
 
-    _curDrawCall->draw.verts_quad[0].obj_ptr = ex_data;
-    _curDrawCall->draw.verts_quad[1].obj_ptr = ex_data;
-    _curDrawCall->draw.verts_quad[2].obj_ptr = ex_data;
-    _curDrawCall->draw.verts_quad[3].obj_ptr = ex_data;
+    _curDrawCall->draw.verts_quad[0].ex_data = ex_data;
+    _curDrawCall->draw.verts_quad[1].ex_data = ex_data;
+    _curDrawCall->draw.verts_quad[2].ex_data = ex_data;
+    _curDrawCall->draw.verts_quad[3].ex_data = ex_data;
 
 
     // _curDrawCall->scale = 1.0f;
@@ -463,7 +883,7 @@ void Vita_DrawRectColorExData(float x, float y,
 
     _Vita_WriteVertices4xColor(_curDrawCall, x, y, wDst, hDst, 1.f, 1.f, 1.f, 1.f, rgba0, rgba0, rgba0, rgba0);
 
-    _Vita_DoneWithDrawCall();
+    _Vita_DoneWithDrawCall(VGL_CALL_SITE());
 
 }
 
@@ -481,16 +901,22 @@ void Vita_Draw(float x,
     
     DrawCall *_curDrawCall = _Vita_GetAvailableDrawCall();
     // _drawTypes[_DrawCalls] = GL_TRIANGLE_STRIP;
+
+    if(_curDrawCall == NULL)
+    { 
+        _debugPrintf("WARNING: Got null draw call.\n");
+        return;
+    }
     
     for(int i = 0; i < VERTICES_PER_QUAD; i++)
-        _curDrawCall->draw.verts_quad[i].obj_ptr = NULL;
+        _curDrawCall->draw.verts_quad[i].ex_data = VGL_EX_DATA_NONE;
 #if 0
     _curDrawCall->scale = 1.0f;
 #endif
 
     _Vita_WriteVertices(_curDrawCall, x, y, wDst, hDst, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
     
-    _Vita_DoneWithDrawCall();
+    _Vita_DoneWithDrawCall(VGL_CALL_SITE());
 }
 
 /**
@@ -503,8 +929,8 @@ void Vita_Draw(float x,
  *  The tex_w & tex_h is used to normalize the given src coordinates
  *  into graphics texture space.
  * 
- *  You can also specify a pointer to `ex_data` for setting
- *  scaling, rotation, and pivot data. 
+ *  You can also specify an `ex_data` handle for setting
+ *  scaling, rotation, and pivot data. (See Vita_CreateExData.)
  */
 void Vita_DrawTextureAnimColorExData(
         float x,
@@ -522,7 +948,7 @@ void Vita_DrawTextureAnimColorExData(
         float _g,
         float _b,
         float _a,
-        obj_extra_data *ex_data)
+        VitaExDataHandle ex_data)
 {
 
     DrawCall *_curDrawCall = _Vita_GetAvailableDrawCall();
@@ -534,15 +960,13 @@ void Vita_DrawTextureAnimColorExData(
         return;
     }
 
-    if(ex_data != NULL)
-    {
-        if(texId == 0) _debugPrintf("WARNING: Draw Texture called without texture passed.\n");
-        if(ex_data != NULL && ex_data->textureID != texId)
-            ex_data->textureID = texId;
-    }
+    if(ex_data != VGL_EX_DATA_NONE && texId == 0)
+        _debugPrintf("WARNING: Draw Texture called without texture passed.\n");
+
+    ex_data = _Vita_CheckExData(ex_data, texId);
 
     for(int i = 0; i < VERTICES_PER_QUAD; i++)
-        _curDrawCall->draw.verts_quad[i].obj_ptr = (void*)ex_data;
+        _curDrawCall->draw.verts_quad[i].ex_data = ex_data;
     
 #if 0
     _curDrawCall->piv_x = x + (wDst * .5f);
@@ -566,7 +990,7 @@ void Vita_DrawTextureAnimColorExData(
         n_src_y2, 
         _r, _g, _b, _a);
     
-    _Vita_DoneWithDrawCall();
+    _Vita_DoneWithDrawCall(VGL_CALL_SITE());
 
     // Vita_DrawTextureAnimColorRotScale(x, y, wDst, hDst, texId, tex_w, tex_h, src_x, src_y, src_w, src_h, _r, _g, _b, _a, _rot, 1.f);
 }
@@ -601,7 +1025,9 @@ void Vita_DrawTextureAnimColor(
         float _b,
         float _a)
 {
-    Vita_DrawTextureAnimColorExData(x, y, wDst, hDst, texId, tex_w, tex_h, src_x, src_y, src_w, src_h, _r, _g, _b, _a, NULL);
+    _wrappedCallSite = __builtin_return_address(0);
+    Vita_DrawTextureAnimColorExData(x, y, wDst, hDst, texId, tex_w, tex_h, src_x, src_y, src_w, src_h, _r, _g, _b, _a, VGL_EX_DATA_NONE);
+    _wrappedCallSite = NULL;
 }
 
 // ------------------------------------------   END EXPOSED 2D DRAW FUNCTIONS
@@ -624,8 +1050,11 @@ void Vita_DrawTextureAnimColor(
  */
 int Vita_AddShaderPass(char* vert_shader, char* frag_shader, int order)
 {
-    int add_idx = 3 + order;
-    if(add_idx < 0 || add_idx > 5)
+    int add_idx = DEFAULT_PASS_INDEX + order;
+    if(add_idx < 0 || add_idx >= MAX_SHADING_PASSES || add_idx == DEFAULT_PASS_INDEX)
+        return -1;
+
+    if(vert_shader == NULL && frag_shader == NULL)
         return -1;
     
     _debugPrintf
@@ -636,77 +1065,106 @@ int Vita_AddShaderPass(char* vert_shader, char* frag_shader, int order)
         (frag_shader == NULL ? "No" : "Yes!")
     );
 
-    // New vert shader.
-    GLuint _newProgVertShader;
-    if(vert_shader == NULL)
-        _newProgVertShader = vertexShaderID;
-    else
-    {
-        _newProgVertShader = LoadShader(GL_VERTEX_SHADER, vert_shader);
-        if(_newProgVertShader == 0)
-            return -1;
-    }
-    CHECK_GL_ERROR("Vita_AddShaderPass newProgVertShader");
-    
-    // New frag shader.
-    GLuint _newProgFragShader;
-    if(frag_shader == NULL)
-        _newProgFragShader = fragmentShaderID;
-    else
-    {
-        _newProgFragShader = LoadShader(GL_FRAGMENT_SHADER, frag_shader);
-        if(_newProgFragShader == 0)
-            return -1;
-    }
-    CHECK_GL_ERROR("Vita_AddShaderPass newProgFragShader");
-    
-    // Linking
-    GLuint _newProgProgram = glCreateProgram();
-    glAttachShader(_newProgProgram, _newProgVertShader);
-    glAttachShader(_newProgProgram, _newProgFragShader);
-
-    glLinkProgram(_newProgProgram);
-    CHECK_GL_ERROR("Vita_AddShaderPass link newProgProgram");
-
-    GLint linked;
-    glGetProgramiv(_newProgProgram, GL_LINK_STATUS, &linked);
-    CHECK_GL_ERROR("Vita_AddShaderPass glGetProgramiv");
+    ShadingPass *defaultPass = &_shading_passes[DEFAULT_PASS_INDEX];
 
-    if(!linked)
+    ShadingPass passInfo;
+    if(_Vita_InitPass(&passInfo,
+        (vert_shader == NULL ? defaultPass->VertexSource : vert_shader),
+        (frag_shader == NULL ? defaultPass->FragmentSource : frag_shader)) != 0)
     {
-        _debugPrintf("!!!!! ERROR: Could not link shader.\n");
-        GLint length;
-        glGetProgramiv(_newProgProgram,GL_INFO_LOG_LENGTH,&length);
-        char* log = (char*)malloc(length);
-        
-        glGetProgramInfoLog(_newProgProgram,200,&length,log);
-
-        _debugPrintf("Error Message: %s\n", log);
-
-
-        if(vert_shader != NULL)
-            glDeleteShader(_newProgVertShader);
-        
-        if(frag_shader != NULL)
-            glDeleteShader(_newProgFragShader);
-        
-        glDeleteProgram(_newProgProgram);
-        
         return -1;
     }
+    CHECK_GL_ERROR("Vita_AddShaderPass build program");
 
-    // 
-    ShadingPass passInfo;
     passInfo.offset_x = 4.f;
     passInfo.offset_y = 4.f;
-    passInfo.ProgramObjectID = _newProgProgram;
-    passInfo.VertexShaderID = _newProgVertShader;
-    passInfo.FragmentShaderID = _newProgFragShader;
 
     Vita_AddPass(passInfo, order);
     return 0;
 }
 
+/**
+ * Vita_SetShaderFeatures():
+ *  Sets the VGL_SHADER_* features every batch is drawn with.
+ *  VGL_SHADER_PER_BATCH features are chosen per batch, so they're masked off here.
+ * 
+ *  Variants for the new features are built the first time a batch needs them.
+ *  With the program cache enabled, that's a quick load after the first launch.
+ */
+void Vita_SetShaderFeatures(unsigned int features)
+{
+    _shaderFeatures = features & ~VGL_SHADER_PER_BATCH;
+}
+
+unsigned int Vita_GetShaderFeatures()
+{
+    return _shaderFeatures;
+}
+
+/**
+ * Vita_SetProgramCacheDir():
+ *  Sets the directory linked shader programs are cached in.
+ *  Call this before initGLShading/initGLShading2 to have the default
+ *  program come out of the cache as well. Passing NULL disables the cache.
+ * 
+ *  Cached binaries are keyed on the shader source and the GL driver,
+ *  so edited shaders and driver updates recompile automatically.
+ */
+void Vita_SetProgramCacheDir(const char *dir)
+{
+    free(_programCacheDir);
+    _programCacheDir = (dir == NULL) ? NULL : VGL_STRDUP(dir);
+}
+
+void *Vita_FrameAlloc(size_t size)
+{
+    void *ptr = Vita_ArenaAlloc(&_frameArena, size, VGL_ARENA_ALIGNMENT);
+    if(ptr == NULL)
+        _debugPrintf("WARNING: Frame arena is full (%zu of %zu bytes used).\n", _frameArena.offset, _frameArena.size);
+
+    return ptr;
+}
+
+size_t Vita_ScratchBegin()
+{
+    return Vita_ArenaMark(&_scratchArena);
+}
+
+void *Vita_ScratchAlloc(size_t size)
+{
+    return Vita_ArenaAlloc(&_scratchArena, size, VGL_ARENA_ALIGNMENT);
+}
+
+void Vita_ScratchEnd(size_t mark)
+{
+    Vita_ArenaRewind(&_scratchArena, mark);
+}
+
+void Vita_GetFrameTimings(VitaFrameTimings *timings)
+{
+    if(timings != NULL) *timings = _frameTimings;
+}
+
+void Vita_SetCulling(int enabled)
+{
+    _cullingEnabled = enabled != 0;
+}
+
+void Vita_SetSorting(int enabled)
+{
+    _sortingEnabled = enabled != 0;
+}
+
+void Vita_SetBatching(int enabled)
+{
+    _batchingEnabled = enabled != 0;
+}
+
+unsigned long Vita_GetFrameHeapAllocations()
+{
+    return _lastFrameHeapAllocations;
+}
+
 // ------------------------------------------ END PASSES
 
 // ------------------------------------------    INIT FUNCTIONS
@@ -722,77 +1180,33 @@ int Vita_AddShaderPass(char* vert_shader, char* frag_shader, int order)
  *      be linked.
  *    - If the program is created successfully, then the proper attribute
  *      and uniform indices will be retrieved from the program.
+ * 
+ *  If a program cache directory was set (Vita_SetProgramCacheDir), a
+ *  matching cached binary is used instead of compiling the source.
  *  
  *  returns 0 if the function completed successfully
  */
 int initGLShading2(char* _vShaderString, char* _fShaderString)
 {
     _debugPrintf("(NOTE): Init GL Shading 2. Initializing GL Shading with shader strings passed to us externally (by the user).\n");
-    vertexShaderID = LoadShader(GL_VERTEX_SHADER, _vShaderString);
-    if(vertexShaderID == 0)
-    {
-        _debugPrintf("ERROR: vertex shader ID: %d\n", vertexShaderID);
-        return -1;
-    }
-    else _debugPrintf("V Shader ID: %d\n", vertexShaderID);
-
-    CHECK_GL_ERROR("Vertex Shader");
-
-    fragmentShaderID = LoadShader(GL_FRAGMENT_SHADER, _fShaderString);
-    if(fragmentShaderID == 0)
-    {
-        _debugPrintf("ERROR: frag shader ID: %d\n", fragmentShaderID);
-        return -1;
-    }
-    else _debugPrintf("F Shader ID: %d\n", fragmentShaderID);
-
-    CHECK_GL_ERROR("Frag Shader");
-
-    programObjectID = glCreateProgram();
-    CHECK_GL_ERROR("Make Program Shader");
-
-    if(programObjectID == 0)
-    {
-        _debugPrintf("ERROR: Program object is 0.\n");
-        return -1;
-    }
-
-    CHECK_GL_ERROR("Pre Shader Attach");
-    glAttachShader(programObjectID, vertexShaderID);
-    CHECK_GL_ERROR("Vertex Shader Attach");
-
-    glAttachShader(programObjectID, fragmentShaderID);  
-    CHECK_GL_ERROR("Frag Shader Attach");
-
-    glLinkProgram(programObjectID);
-    CHECK_GL_ERROR("LINK PROGRRAM");
 
-    GLint linked;
-    glGetProgramiv(programObjectID, GL_LINK_STATUS, &linked);
-    CHECK_GL_ERROR("Get Program Info Value");
+    ShadingPass *pass = &_shading_passes[DEFAULT_PASS_INDEX];
+    if(pass->ProgramObjectID != 0)
+        _Vita_FreePass(pass);
 
-    if(!linked)
+    if(_Vita_InitPass(pass, _vShaderString, _fShaderString) != 0)
     {
         // TODO: proper error.
         _debugPrintf("!!!!!! FAILED TO LINK SHADER!\n");
         return -1;
     }
-    
-#ifdef VITA
-    VERTEX_POS_INDEX = glGetAttribLocation(programObjectID, "aPosition");
-#else
-    VERTEX_POS_INDEX = glGetAttribLocation(programObjectID, "vPosition"); // Vertex position.
-#endif
-    VERTEX_TEXCOORD_INDEX = glGetAttribLocation(programObjectID, "vTexCoord"); // Vertex Tex Coord.
-    VERTEX_COLOR_INDEX = glGetAttribLocation(programObjectID, "vColor"); // Gets passed to the fragment shader.
 
-    // Uniforms
-    VERTEX_MVP_INDEX = glGetUniformLocation(programObjectID, "mvp"); // MVP matrix. In our case, this is an ortho matrix for the Vita's screen.
-
-    UNIFORM_ROTMAT_INDEX = glGetUniformLocation(programObjectID, "_rot");
-    UNIFORM_SCALE_INDEX = glGetUniformLocation(programObjectID, "_scale");
+    programObjectID = pass->ProgramObjectID;
+    vertexShaderID = pass->VertexShaderID;
+    fragmentShaderID = pass->FragmentShaderID;
+    _debugPrintf("Program ID: %d\n", programObjectID);
     
-    UNIFORM_USE_TEXTURE_BOOL_INDEX = glGetUniformLocation(programObjectID, "useTexture");
+    ShaderLocations *loc = &pass->Locations;
 
     glm_mat4_identity(_rot);
     glm_mat4_identity(_rot_arb);
@@ -800,42 +1214,41 @@ int initGLShading2(char* _vShaderString, char* _fShaderString)
     glm_mat4_identity(_scale);
     glm_mat4_identity(_scale_arb);
 
-    _shading_passes[2].ProgramObjectID = programObjectID;
-    _shading_passes[2].offset_x = 0;
-    _shading_passes[2].offset_y = 0;
+    pass->offset_x = 0;
+    pass->offset_y = 0;
     
 #ifndef VITA
-    if(VERTEX_POS_INDEX <= -1)
+    if(loc->PositionAttrib <= -1)
     {
-        _debugPrintf("VERTEX_POS_INDEX returned invalid value: %d\n", VERTEX_POS_INDEX);
+        _debugPrintf("VERTEX_POS_INDEX returned invalid value: %d\n", loc->PositionAttrib);
         return -1;
     }
     CHECK_GL_ERROR("VERTEX_POS_INDEX");
 
-    if(VERTEX_TEXCOORD_INDEX <= -1)
+    if(loc->TexCoordAttrib <= -1)
     {
-        _debugPrintf("VERTEX_TEXCOORD_INDEX returned invalid value: %d\n", VERTEX_TEXCOORD_INDEX);
+        _debugPrintf("VERTEX_TEXCOORD_INDEX returned invalid value: %d\n", loc->TexCoordAttrib);
         return -1;
     }
     CHECK_GL_ERROR("VERTEX_TEXCOORD_INDEX");
 
-    if(VERTEX_MVP_INDEX <= -1)
+    if(loc->MVPUniform <= -1)
     {
-        _debugPrintf("VERTEX_MVP_INDEX returned invalid value: %d\n", VERTEX_MVP_INDEX);
+        _debugPrintf("VERTEX_MVP_INDEX returned invalid value: %d\n", loc->MVPUniform);
         return -1;
     }
     CHECK_GL_ERROR("VERTEX_MVP_INDEX");
 
-    if(VERTEX_COLOR_INDEX <= -1)
+    if(loc->ColorAttrib <= -1 && (_shaderFeatures & VGL_SHADER_VERTEX_COLOR))
     {
-        _debugPrintf("VERTEX_COLOR_INDEX returned invalid value: %d\n", VERTEX_COLOR_INDEX);
+        _debugPrintf("VERTEX_COLOR_INDEX returned invalid value: %d\n", loc->ColorAttrib);
         return -1;
     }
     CHECK_GL_ERROR("VERTEX_COLOR_INDEX");
 #endif
     _debugPrintf(
         "[Attrib Location Report]\n\nVERTEX_POS_INDEX: %d\nVERTEX_TEXCOORD_INDEX: %d\nVERTEX_MVP_INDEX: %d\nVERTEX_COLOR_INDEX: %d\n",
-        VERTEX_POS_INDEX, VERTEX_TEXCOORD_INDEX, VERTEX_MVP_INDEX, VERTEX_COLOR_INDEX
+        loc->PositionAttrib, loc->TexCoordAttrib, loc->MVPUniform, loc->ColorAttrib
     );
 
     
@@ -851,8 +1264,8 @@ int initGLAdv()
 {
     _vgl_pending_total_size = sizeof(DrawCall) * MAX_VERTICES;
 
-    _curBufferA = (DrawCall*)malloc(_vgl_pending_total_size);
-    _curBufferB = (DrawCall*)malloc(_vgl_pending_total_size);
+    _curBufferA = (DrawCall*)VGL_MALLOC(_vgl_pending_total_size);
+    _curBufferB = (DrawCall*)VGL_MALLOC(_vgl_pending_total_size);
     // _drawTypes = (uint8_t*)malloc(sizeof(uint8_t) * MAX_VERTICES);
 
     memset(_curBufferA, 0, _vgl_pending_total_size);
@@ -878,6 +1291,37 @@ int initGLAdv()
     _debugPrintf("Initial Buffer Data with %ld bytes (%.2f MB)\n", _vgl_pending_total_size, (_vgl_pending_total_size / 1024.f) / 1024.f);
     CHECK_GL_ERROR("INITIAL BUFFER DATA");
 
+    // Quad vertices are written in triangle strip order (0, 1, 2, 3),
+    // so each quad becomes the triangles (0, 1, 2) & (2, 1, 3).
+    size_t _indicesSize = sizeof(VitaIndex) * INDICES_PER_QUAD * MAX_VERTICES;
+    size_t scratch = Vita_ScratchBegin();
+    VitaIndex *_indices = (VitaIndex *)Vita_ScratchAlloc(_indicesSize);
+    if(_indices == NULL)
+    {
+        _debugPrintf("ERROR: Index data doesn't fit in the scratch arena.\n");
+        return -1;
+    }
+
+    for(uint32_t q = 0; q < MAX_VERTICES; q++)
+    {
+        VitaIndex first = q * VERTICES_PER_QUAD;
+        VitaIndex *out = _indices + (q * INDICES_PER_QUAD);
+
+        out[0] = first + 0;
+        out[1] = first + 1;
+        out[2] = first + 2;
+        out[3] = first + 2;
+        out[4] = first + 1;
+        out[5] = first + 3;
+    }
+
+    glGenBuffers(1, &_indexBufferID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferID);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indicesSize, _indices, GL_STATIC_DRAW);
+    CHECK_GL_ERROR("INDEX BUFFER DATA");
+
+    Vita_ScratchEnd(scratch);
+
     return 0;
 }
 
@@ -888,17 +1332,36 @@ int deInitGL()
 
     free(_curBufferA);
     free(_curBufferB);
+
+    free(_callSitesA);
+    free(_callSitesB);
+    free(_keptFrom);
+    _callSitesA = _callSitesB = _vgl_pending_sites = _vgl_current_write_sites = NULL;
+    _keptFrom = NULL;
+
+    for(int i = 0; i < MAX_SHADING_PASSES; i++)
+        _Vita_FreePass(&_shading_passes[i]);
+
+    free(_programCacheDir);
+    _programCacheDir = NULL;
+
+    Vita_FreeAllExData();
+
+    Vita_ArenaDestroy(&_frameArena);
+    Vita_ArenaDestroy(&_scratchArena);
     
 #ifdef VITA
     vglEnd();
-#else
+#elif defined(VGL_OFFSCREEN)
+    Vita_OffscreenTerminate();
+#elif defined(VGL_GLFW_WINDOW)
     glfwTerminate();
 #endif
 
     return 0;
 }
 
-#ifndef VITA
+#ifdef VGL_GLFW_WINDOW
 static void glfwError(int id, const char* description)
 {
     _debugPrintf("[GLFW] ERROR ID %d: %s\n", id, description);
@@ -949,9 +1412,18 @@ int initGL(void (*dbgPrintFn)(const char*, ...))
     start_time_s = time(NULL);
 #endif
     _debugPrintf = dbgPrintFn;
+    Vita_ProfilerNameThread("GL");
 
-    for(int i = 0; i < 6; i++)
+    if(Vita_ArenaInit(&_frameArena, VGL_FRAME_ARENA_SIZE) != 0
+        || Vita_ArenaInit(&_scratchArena, VGL_SCRATCH_ARENA_SIZE) != 0)
     {
+        _debugPrintf("[main] Could not allocate the renderer's arenas.\n");
+        return -1;
+    }
+
+    for(int i = 0; i < MAX_SHADING_PASSES; i++)
+    {
+        memset(&_shading_passes[i], 0, sizeof(ShadingPass));
         _shading_passes[i].ProgramObjectID = 0;
         _shading_passes[i].offset_x = 0;
         _shading_passes[i].offset_y = 0;
@@ -967,7 +1439,15 @@ int initGL(void (*dbgPrintFn)(const char*, ...))
                            SCE_GXM_MULTISAMPLE_NONE);
     _userHasLibshaccg();
 #endif
-#ifndef VITA // TODO: elif for glew? restructure the *way* this is done? per platform private impl of init functions?
+#if defined(VGL_NULL_BACKEND)
+    _debugPrintf("[main] Null GL backend, nothing will be drawn.\n");
+#elif defined(VGL_OFFSCREEN)
+    if(Vita_OffscreenInit(DISPLAY_WIDTH, DISPLAY_HEIGHT, _debugPrintf) != 0)
+    {
+        _debugPrintf("[main] Could not create an offscreen GL context.\n");
+        return -1;
+    }
+#elif !defined(VITA) // TODO: elif for glew? restructure the *way* this is done? per platform private impl of init functions?
     glewExperimental = 1;
     glfwSetErrorCallback(&glfwError);
     int glfwReturnVal = glfwInit();
@@ -1037,202 +1517,497 @@ void Vita_Clear()
 }
 
 /**
- * Vita_Repaint():
- *  Repaint does the following.
- *      1. Buffers the CPU calculated vertices into the GPU.
- *      2. Sets up the vertex attrib pointers for the shader based on the data.
- *      3. Binds the buffers and the default shader and calls glDrawArrays for
- *         each vertex. This sounds bad, but is surprisingly performant 
- *         due to the fact that the data already exists on the GPU at this time.
- *          
- *         Still, this was a workaround due to the fact that glDrawArrays 
- *         tries to render the full list as one quad and the fact that glDrawElements
- *         requires an indices list. 
+ * _Vita_CullOffscreen():
+ *  Drops the `count` pending `calls` no pass can draw on screen.
+ *  Passes are drawn offset, so the screen is widened by the largest offset.
+ *  `kept_from` (may be NULL) receives the index each call left had.
+ *
+ *  returns the number of calls left, at the front of `calls`.
  */
-void Vita_Repaint()
+static uint32_t _Vita_CullOffscreen(DrawCall *calls, uint32_t count, uint32_t *kept_from)
 {
-    __vgl_repaint_inprog = 1;
-    _Vita_SwapBuffers();
+    float margin_x = 0.f, margin_y = 0.f;
+    for(int p = 0; p < MAX_SHADING_PASSES; p++)
+    {
+        if(_shading_passes[p].ProgramObjectID == 0) continue;
 
-    const GLsizei stride = VERTEX_ATTRIB_TOTAL_SIZE_1; // NOT Tightly packed. 4 verts per GL_TRIANGLE_STRIP
-    uint32_t draw_calls = Vita_GetTotalCalls();
+        // The same pixels to clip space as the _offset uniform (see _Vita_BindVariant).
+        float offset_x = fabsf(_shading_passes[p].offset_x * 2.f) / DISPLAY_WIDTH;
+        float offset_y = fabsf(_shading_passes[p].offset_y * 2.f) / DISPLAY_HEIGHT;
+        if(offset_x > margin_x) margin_x = offset_x;
+        if(offset_y > margin_y) margin_y = offset_y;
+    }
 
-    if(draw_calls == 0) goto FINISH_DRAWING;
-    if(draw_calls > GL_MAX_VERTEX_ATTRIBS)
+    return Vita_CullQuads(calls, count, (const float *)cpu_mvp, margin_x, margin_y, kept_from);
+}
+
+/**
+ * _Vita_AllocCallSites():
+ *  Starts tracking where draw calls are made from, for batch diagnostics.
+ *  Calls already queued have no call site.
+ */
+static void _Vita_AllocCallSites()
+{
+    _callSitesA = (const void **)VGL_CALLOC(MAX_VERTICES, sizeof(void *));
+    _callSitesB = (const void **)VGL_CALLOC(MAX_VERTICES, sizeof(void *));
+    _keptFrom = (uint32_t *)VGL_MALLOC(sizeof(uint32_t) * MAX_VERTICES);
+
+    if(_callSitesA == NULL || _callSitesB == NULL || _keptFrom == NULL)
     {
-        _debugPrintf("Too many calls (%d / %d).\n", draw_calls, GL_MAX_VERTEX_ATTRIBS);
+        _debugPrintf("WARNING: Couldn't allocate call sites for batch diagnostics.\n");
+        free(_callSitesA);
+        free(_callSitesB);
+        free(_keptFrom);
+        _callSitesA = _callSitesB = NULL;
+        _keptFrom = NULL;
+        return;
     }
 
-    // Get pointer to the first pending drawcall.
-    struct _DrawCall *calls = Vita_GetDrawCallsPending();
-#ifdef EXPERIMENTAL_SORTING
-    qsort(calls, draw_calls, sizeof(DrawCall), _Vita_SortDrawCalls);
-#endif
-    GLuint _vbo = Vita_GetVertexBufferID(); // Get OpenGL handle to our vbo. (On the GPU)
-    
-    // Buffer Data.
-    if(_vbo != 0)
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo); // Bind our vbo through OpenGL.
-        CHECK_GL_ERROR("bind");
+    _vgl_pending_sites = _callSitesA;
+    _vgl_current_write_sites = _callSitesB;
+}
 
-        glBufferSubData(GL_ARRAY_BUFFER, 0, draw_calls * sizeof(DrawCall), calls);
+/**
+ * _Vita_RecordBreak():
+ *  Records that a batch of `pass` starts at pending call `i`
+ *  (see Vita_RecordBatchBreak).
+ */
+static void _Vita_RecordBreak(const ShadingPass *pass, uint32_t i, int reason, GLuint texture, GLuint previous_texture)
+{
+    uint32_t draw_index = _frameOrder != NULL ? _frameOrder[i] : i;
+    const void *site = _frameSites != NULL ? _frameSites[draw_index] : NULL;
+
+    Vita_RecordBatchBreak(reason, (int)(pass - _shading_passes), draw_index,
+        texture, reason == VGL_BREAK_PASS ? 0 : previous_texture, site);
+}
+
+/**
+ * _Vita_EndStage():
+ *  Adds the time since `start` to `stage` (VGL_TIMING_*) of the frame
+ *  being timed.
+ *
+ *  returns now, where the next stage starts.
+ */
+static inline uint64_t _Vita_EndStage(int stage, uint64_t start)
+{
+    uint64_t now = Vita_ProfilerNow();
+    _curTimings.cpu_ms[stage] += (float)(now - start) / 1000000.f;
+    return now;
+}
+
+/**
+ * _Vita_EndFrameTimings():
+ *  Publishes the timings & stats of the frame ending at `now`
+ *  and starts timing the next one.
+ */
+static void _Vita_EndFrameTimings(uint64_t now)
+{
+    if(_lastFrameEndNs != 0)
+        _curTimings.cpu_ms[VGL_TIMING_FRAME] = (float)(now - _lastFrameEndNs) / 1000000.f;
+    _lastFrameEndNs = now;
+
+    // The GPU's side, as of the latest frame read back.
+    for(int i = 0; i < VGL_TIMING_COUNT; i++)
+        _curTimings.gpu_ms[i] = -1.f;
+    for(int p = 0; p < VGL_TIMING_MAX_PASSES; p++)
+        _curTimings.gpu_pass_ms[p] = -1.f;
+
+    if(Vita_GetGPUTimings(&_gpuTimings))
+    {
+        _curTimings.gpu_frame = _gpuTimings.frame;
+        _curTimings.gpu_ms[VGL_TIMING_FRAME] = _gpuTimings.frame_ms;
+        _curTimings.gpu_ms[VGL_TIMING_UPLOAD] = _gpuTimings.upload_ms;
+        _curTimings.gpu_ms[VGL_TIMING_DRAW] = _gpuTimings.draw_ms;
+        memcpy(_curTimings.gpu_pass_ms, _gpuTimings.pass_ms, sizeof(_curTimings.gpu_pass_ms));
     }
-    else return;
 
-    // TODO: Did removing glBindBuffer from here cause issues?
+    _curTimings.frame = Vita_ProfilerFrame();
+    _frameTimings = _curTimings;
+    memset(&_curTimings, 0, sizeof(_curTimings));
 
-    glUseProgram(programObjectID); // Begin using our vert/frag shader combo (program)
+    _curStats.frame = _frameTimings.frame;
+    _curStats.cpu_ms = _frameTimings.cpu_ms[VGL_TIMING_FRAME];
+    _curStats.gpu_ms = _frameTimings.gpu_ms[VGL_TIMING_FRAME];
+    Vita_RecordFrameStats(&_curStats);
+    memset(&_curStats, 0, sizeof(_curStats));
 
-    // ONLY enable these for data that you want to be
-    // defined/ passed through the vertex attribute array.
-    glEnableVertexAttribArray(VERTEX_POS_INDEX); // Enabling the property on the shader side.
-    glEnableVertexAttribArray(VERTEX_TEXCOORD_INDEX); // Enabling TEX_COORD_INDEX
-    glEnableVertexAttribArray(VERTEX_COLOR_INDEX); // Enabling color index
+    Vita_ProfilerEndFrame();
+}
 
-    CHECK_GL_ERROR("enable vertex attrib array 0");
+/**
+ * _Vita_BindVariant():
+ *  Makes `variant` the current program and points its attributes
+ *  at the (already uploaded) VBO. Per frame uniforms are set here too, 
+ *  as every program has its own copy of them.
+ * 
+ *  `enabledAttribs` tracks which attribute arrays are enabled,
+ *  so they can all be turned off again at the end of the pass.
+ */
+static void _Vita_BindVariant(const ShadingPass *pass, const ShaderVariant *variant, unsigned int *enabledAttribs)
+{
+    const GLsizei stride = VERTEX_ATTRIB_TOTAL_SIZE_1; // NOT Tightly packed.
+    const ShaderLocations *loc = &variant->Locations;
+
+    glUseProgram(variant->ProgramObjectID);
+    _curStats.shader_changes++;
 
-    glVertexAttribPointer(VERTEX_POS_INDEX, 3, GL_FLOAT, GL_FALSE, stride, (void*)0); // Binding the data from the vbo to our vertex attrib.
+    // ONLY enable these for data that you want to be
+    // defined/ passed through the vertex attribute array.
+    if(loc->PositionAttrib >= 0)
+    {
+        glEnableVertexAttribArray(loc->PositionAttrib); // Enabling the property on the shader side.
+        glVertexAttribPointer(loc->PositionAttrib, 3, GL_FLOAT, GL_FALSE, stride, (void*)0); // Binding the data from the vbo to our vertex attrib.
+        *enabledAttribs |= (1u << loc->PositionAttrib);
+    }
     CHECK_GL_ERROR("vert attrib ptr arrays");
 
-    glVertexAttribPointer(VERTEX_TEXCOORD_INDEX, 2, GL_FLOAT, GL_FALSE, stride, (void*)(0 + (3 * sizeof(float))));
+    if(loc->TexCoordAttrib >= 0)
+    {
+        glEnableVertexAttribArray(loc->TexCoordAttrib); // Enabling TEX_COORD_INDEX
+        glVertexAttribPointer(loc->TexCoordAttrib, 2, GL_FLOAT, GL_FALSE, stride, (void*)(0 + (3 * sizeof(float))));
+        *enabledAttribs |= (1u << loc->TexCoordAttrib);
+    }
     CHECK_GL_ERROR("vert attrib ptr tex coord.");
 
-    glVertexAttribPointer(VERTEX_COLOR_INDEX, 4, GL_FLOAT, GL_FALSE, stride, (void*)(0 + (5 * sizeof(float))));
+    if(loc->ColorAttrib >= 0)
+    {
+        glEnableVertexAttribArray(loc->ColorAttrib); // Enabling color index
+        glVertexAttribPointer(loc->ColorAttrib, 4, GL_FLOAT, GL_FALSE, stride, (void*)(0 + (5 * sizeof(float))));
+        *enabledAttribs |= (1u << loc->ColorAttrib);
+    }
     CHECK_GL_ERROR("vert attrib ptr color");
 
-    glUniformMatrix4fv(VERTEX_MVP_INDEX, 1, GL_FALSE, (const GLfloat*)cpu_mvp);
+    glUniformMatrix4fv(loc->MVPUniform, 1, GL_FALSE, (const GLfloat*)cpu_mvp);
+    glUniformMatrix4fv(loc->ScaleUniform, 1, GL_FALSE, (const GLfloat *)_scale_arb);
+    glUniformMatrix4fv(loc->RotUniform, 1, GL_FALSE, (const GLfloat *)_rot_arb);
     CHECK_GL_ERROR("glUniformMatrix4fv");
 
-    // This is a "hack around".
-    // Ideally, I'd be able to batch this all at once.
-    GLuint i;
+    // Offsets are given in pixels, the vertices are in clip space.
+    glUniform2f(loc->OffsetUniform, 
+        (pass->offset_x * 2.f) / DISPLAY_WIDTH, 
+        -(pass->offset_y * 2.f) / DISPLAY_HEIGHT);
+
+    _curStats.uniform_changes += 4;
+
+    if(loc->PaletteUniform >= 0)
+    {
+        glUniform1i(loc->PaletteUniform, 1);
+        _curStats.uniform_changes++;
+    }
+}
+
+/**
+ * _Vita_FlushBatch():
+ *  Draws the quads [first, end) with whatever state is currently bound.
+ */
+static inline void _Vita_FlushBatch(uint32_t first, uint32_t end)
+{
+    if(end <= first) return;
+
+    glDrawElements(GL_TRIANGLES, 
+        (end - first) * INDICES_PER_QUAD, 
+        VGL_INDEX_TYPE, 
+        (void*)(first * INDICES_PER_QUAD * sizeof(VitaIndex)));
+
+    Vita_GPUTimerMark(VGL_GPU_MARK_BATCH, 0);
+
+    _curStats.batches++;
+    _curStats.draw_calls++;
+    _curStats.vertices += (end - first) * VERTICES_PER_QUAD;
+}
+
+/**
+ * _Vita_DrawPass():
+ *  Draws every pending call with the given `pass`.
+ * 
+ *  The vertex data is expected to already be in the bound VBO,
+ *  so every pass reuses the single upload done in Vita_Repaint.
+ * 
+ *  Consecutive calls that share a texture (and palette) form a batch,
+ *  drawn with one glDrawElements. Each batch picks the shader variant
+ *  matching its state (textured or not, indexed or not, on top of the
+ *  current shader features), so no shader has to branch on it.
+ *  Palettes are bound to texture unit 1.
+ * 
+ *  returns the number of texture swaps done during the pass.
+ */
+static int _Vita_DrawPass(ShadingPass *pass, DrawCall *calls, uint32_t draw_calls)
+{
+    const ShaderVariant *_curVariant = NULL;
+    unsigned int _enabledAttribs = 0;
     GLuint _curBoundTex = -1;
     GLuint _curReqTex = 0;
+    GLuint _curBoundPalette = 0; // The current batch's, 0 if not indexed.
+    GLuint _unitPalette = 0; // What's actually bound to unit 1.
     int totalTextureSwaps = 0;
-    DrawCall _curDrawCall;
+    uint32_t batchStart = 0;
 
     glm_mat4_identity(_scale_arb);
     glm_mat4_identity(_rot_arb);
 
-    glUniformMatrix4fv(UNIFORM_SCALE_INDEX, 1, GL_FALSE, (const GLfloat *)_scale_arb);
-    glUniformMatrix4fv(UNIFORM_ROTMAT_INDEX, 1, GL_FALSE, (const GLfloat *)_rot_arb);
-
-    glUniform1i(UNIFORM_USE_TEXTURE_BOOL_INDEX, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-#ifdef EXPERIMENTAL_SORTING
-    int thisBatchStart = 0;
-    int thisBatch = 0;
-    int _totalThisBatch = 0;
-    int _totalBatches = 0;
-#endif
-    for (i = 0; i < draw_calls; i++)
+    for(uint32_t i = 0; i < draw_calls; i++)
     {
-        _curDrawCall = *(calls + i);
-        // if(_drawTypes[i] == GL_TRIANGLE_STRIP)
+        const obj_extra_data *ex_data = Vita_GetExData(calls[i].draw.verts_quad[0].ex_data);
+        _curReqTex = (ex_data != NULL) ? ex_data->textureID : 0;
+        GLuint reqPalette = (_curReqTex != 0) ? ex_data->paletteID : 0;
+
+        // Same state as the current batch, keep going.
+        int sameState = _curReqTex == _curBoundTex && reqPalette == _curBoundPalette && _curVariant != NULL;
+        if(sameState && _batchingEnabled) continue;
+
+        _Vita_FlushBatch(batchStart, i);
+        batchStart = i;
+
+        // Unbatched, every call is drawn on its own; only real state changes are breaks.
+        if(Vita_BatchDiagnosticsEnabled() && !sameState)
         {
-#ifdef EXPERIMENTAL_SORTING
-            _totalThisBatch += VERTICES_PER_QUAD;
-#endif
-            if (_curDrawCall.draw.verts_quad[0].obj_ptr != NULL)
-            {
-                obj_extra_data ex_data = *((obj_extra_data *)_curDrawCall.draw.verts_quad[0].obj_ptr);
-                _curReqTex = (_curDrawCall.draw.verts_quad[0].obj_ptr != NULL) ? ex_data.textureID : 0;
-
-                // Only re-bind texture when it's different
-                // from what's currently bound.
-                if (_curBoundTex != _curReqTex)
-                {
-                    if (ex_data.textureID == 0)
-                        glUniform1i(UNIFORM_USE_TEXTURE_BOOL_INDEX, 0);
-                    else
-                        glUniform1i(UNIFORM_USE_TEXTURE_BOOL_INDEX, 1);
-
-                    glBindTexture(GL_TEXTURE_2D, ex_data.textureID);
-                    _curBoundTex = ex_data.textureID;
-                    totalTextureSwaps++;
-
-                    // draw
-#ifdef EXPERIMENTAL_SORTING
-                    _debugPrintf("Batch %d: Total Vertices: %d\n", _totalBatches, _totalThisBatch);
-                    glDrawArrays(GL_TRIANGLE_STRIP, (i * VERTICES_PER_QUAD), _totalThisBatch);              
-                    _totalThisBatch = 0;
-                    _totalBatches++;
-#endif
-                }
+            int reason = _curVariant == NULL ? VGL_BREAK_PASS
+                : (_curReqTex == 0) != (_curBoundTex == 0) ? VGL_BREAK_UNTEXTURED
+                : _curReqTex != _curBoundTex ? VGL_BREAK_TEXTURE
+                : VGL_BREAK_PALETTE;
+            _Vita_RecordBreak(pass, i, reason, _curReqTex, _curBoundTex);
+        }
 
-                // TODO: Add back all the extra shader options
-                // Maybe as efficiently as possible?
-            }
-            else
+        unsigned int features = _shaderFeatures | (_curReqTex != 0 ? VGL_SHADER_TEXTURED : 0);
+        if(reqPalette != 0)
+            features |= VGL_SHADER_PALETTE | (ex_data->index_width != 0 ? VGL_SHADER_PALETTE4 : 0);
+
+        // Nothing to draw these with: skip them, rather than draw them with the last batch's state.
+        const ShaderVariant *variant = _Vita_GetVariant(pass, features);
+        if(variant == NULL)
+        {
+            static int _loggedMissingVariant = 0;
+            if(!_loggedMissingVariant)
             {
-                glUniform1i(UNIFORM_USE_TEXTURE_BOOL_INDEX, 0);
-                glBindTexture(GL_TEXTURE_2D, 0);
-                _curBoundTex = 0;
+                _debugPrintf("ERROR: No shader variant for features 0x%x, skipping its draws.\n", features);
+                _loggedMissingVariant = 1;
+            }
 
-#ifdef EXPERIMENTAL_SORTING
-                _debugPrintf("Batch %d: Total Vertices: %d\n", _totalBatches, _totalThisBatch);
-                glDrawArrays(GL_TRIANGLE_STRIP, (i * VERTICES_PER_QUAD), _totalThisBatch);
+            _curVariant = NULL;
+            _curBoundTex = -1;
+            batchStart = i + 1;
+            continue;
+        }
 
-                _totalThisBatch = 0;
-                _totalBatches++;
-#endif
+        if(variant != _curVariant)
+        {
+            _Vita_BindVariant(pass, variant, &_enabledAttribs);
+            _curVariant = variant;
+        }
+
+        // Shaders written before variants existed still branch on this.
+        glUniform1i(variant->Locations.UseTextureUniform, _curReqTex != 0);
+        _curStats.uniform_changes++;
 
-                totalTextureSwaps++;
+        if(reqPalette != 0)
+        {
+            if(variant->Locations.IndexWidthUniform >= 0)
+            {
+                glUniform1f(variant->Locations.IndexWidthUniform, ex_data->index_width);
+                _curStats.uniform_changes++;
+            }
+
+            if(reqPalette != _unitPalette)
+            {
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, reqPalette);
+                glActiveTexture(GL_TEXTURE0);
+                _unitPalette = reqPalette;
+                _curStats.texture_changes++;
             }
-#ifndef EXPERIMENTAL_SORTING
-            glDrawArrays(GL_TRIANGLE_STRIP, (i * VERTICES_PER_QUAD), VERTICES_PER_QUAD);
-#endif            
         }
+        _curBoundPalette = reqPalette;
+
+        // Only re-bind texture when it's different
+        // from what's currently bound.
+        glBindTexture(GL_TEXTURE_2D, _curReqTex);
+        _curBoundTex = _curReqTex;
+        totalTextureSwaps++;
+        _curStats.texture_changes++;
+
+        // Keeps it resident, or brings it back if it was evicted.
+        if(_curReqTex != 0) Vita_TouchTexture(_curReqTex);
     }
-#if DEBUG_BUILD
-    if(last_frame_time_s != 0)
-    {
-        clock_t cur_time = clock();
-        last_frame_time_consumed_s = (cur_time - last_frame_time_s);
-    }
-#endif
+
+    if(_curVariant != NULL)
+        _Vita_FlushBatch(batchStart, draw_calls);
 
     // Revert shader state.
-    glUniform1i(UNIFORM_USE_TEXTURE_BOOL_INDEX, 0);
+    if(_unitPalette != 0)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
 
     // Reverting state.
-    glDisableVertexAttribArray(VERTEX_POS_INDEX);
-    glDisableVertexAttribArray(VERTEX_TEXCOORD_INDEX);
-    glDisableVertexAttribArray(VERTEX_COLOR_INDEX);
+    for(GLuint a = 0; _enabledAttribs != 0; a++, _enabledAttribs >>= 1)
+    {
+        if(_enabledAttribs & 1) glDisableVertexAttribArray(a);
+    }
+
+    return totalTextureSwaps;
+}
+
+/**
+ * Vita_Repaint():
+ *  Repaint does the following.
+ *      0. Uploads decoded textures from the async loader, within budget,
+ *         and evicts textures past the residency budget.
+ *      1. Buffers the CPU calculated vertices into the GPU, once.
+ *      2. For every active shading pass, in order, walks the calls
+ *         and splits them into batches of matching state (see _Vita_DrawPass).
+ *      3. Each batch binds its shader variant & texture and is drawn
+ *         with a single glDrawElements over the static quad index buffer.
+ * 
+ *  Passes other than the default are drawn without depth writes, so a
+ *  pass like a drop shadow never occludes the sprites drawn after it.
+ */
+void Vita_Repaint()
+{
+    __vgl_repaint_inprog = 1;
+    if(Vita_BatchDiagnosticsEnabled() && _callSitesA == NULL)
+        _Vita_AllocCallSites();
+    _Vita_SwapBuffers();
+
+    uint64_t stage_start = Vita_ProfilerNow();
+    Vita_GPUTimerMark(VGL_GPU_MARK_FRAME, 0);
+
+    // Textures that finished decoding show up this frame.
+    VGL_PROFILE_BEGIN("upload");
+    Vita_PumpTextureUploads();
+    VGL_PROFILE_END();
+    Vita_GPUTimerMark(VGL_GPU_MARK_UPLOADED, 0);
+    stage_start = _Vita_EndStage(VGL_TIMING_UPLOAD, stage_start);
+    _curStats.texture_bytes = (uint32_t)Vita_TextureUploadBytes();
+
+    uint32_t draw_calls = Vita_GetTotalCalls();
+    int totalTextureSwaps = 0;
+    _curStats.sprites_submitted = draw_calls;
+
+    if(draw_calls == 0) goto FINISH_DRAWING;
+
+    // Get pointer to the first pending drawcall.
+    struct _DrawCall *calls = Vita_GetDrawCallsPending();
+    _frameSites = _vgl_pending_sites;
+    _frameOrder = NULL;
+
+    if(_cullingEnabled)
+    {
+        VGL_PROFILE_BEGIN("cull");
+        draw_calls = _Vita_CullOffscreen(calls, draw_calls, _keptFrom);
+        _frameOrder = _keptFrom;
+        VGL_PROFILE_END();
+        stage_start = _Vita_EndStage(VGL_TIMING_SUBMIT, stage_start);
+
+        _curStats.sprites_culled = _curStats.sprites_submitted - draw_calls;
+        if(draw_calls == 0) goto FINISH_DRAWING;
+    }
+    if(_sortingEnabled)
+    {
+        VGL_PROFILE_BEGIN("sort");
+        qsort(calls, draw_calls, sizeof(DrawCall), _Vita_SortDrawCalls);
+        VGL_PROFILE_END();
+
+        // Sorted calls can't be traced back to where they were made.
+        _frameSites = NULL;
+        _frameOrder = NULL;
+        stage_start = _Vita_EndStage(VGL_TIMING_SORT, stage_start);
+    }
+    GLuint _vbo = Vita_GetVertexBufferID(); // Get OpenGL handle to our vbo. (On the GPU)
+    
+    // Buffer Data.
+    if(_vbo != 0)
+    {
+        VGL_PROFILE_BEGIN("submit");
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo); // Bind our vbo through OpenGL.
+        CHECK_GL_ERROR("bind");
+
+        glBufferSubData(GL_ARRAY_BUFFER, 0, draw_calls * sizeof(DrawCall), calls);
+        _curStats.vertex_bytes = draw_calls * sizeof(DrawCall);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferID);
+        VGL_PROFILE_END();
+        stage_start = _Vita_EndStage(VGL_TIMING_SUBMIT, stage_start);
+    }
+    else return;
+
+    if(_shaderFeatures & VGL_SHADER_PREMULTIPLIED)
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    VGL_PROFILE_BEGIN("draw");
+    for(int p = 0; p < MAX_SHADING_PASSES; p++)
+    {
+        if(_shading_passes[p].ProgramObjectID == 0) continue;
+
+        VGL_PROFILE_BEGIN("pass");
+        Vita_GPUTimerMark(VGL_GPU_MARK_PASS, p);
+        if(p != DEFAULT_PASS_INDEX) glDepthMask(GL_FALSE);
+
+        totalTextureSwaps += _Vita_DrawPass(&_shading_passes[p], calls, draw_calls);
+
+        if(p != DEFAULT_PASS_INDEX) glDepthMask(GL_TRUE);
+        Vita_GPUTimerMark(VGL_GPU_MARK_PASS_END, p);
+        VGL_PROFILE_END();
+    }
+    VGL_PROFILE_END();
+    stage_start = _Vita_EndStage(VGL_TIMING_DRAW, stage_start);
 
 FINISH_DRAWING:
+    VGL_PROFILE_BEGIN("swap");
 #ifdef VITA
     vglSwapBuffers(GL_TRUE);
+#elif defined(VGL_NULL_BACKEND)
+    Vita_NullGLSwapBuffers();
+#elif defined(VGL_OFFSCREEN)
+    Vita_OffscreenPresent(); // Uncapped, nothing waits for a vsync.
 #else
     glfwSwapBuffers(_game_window);
     glfwPollEvents();
+#endif
+    VGL_PROFILE_END();
+    stage_start = _Vita_EndStage(VGL_TIMING_SWAP, stage_start);
+
+    // Finish, reset total calls.
+    Vita_ResetTotalCalls();
+
+    // Everything allocated for this frame is done with.
+    Vita_ArenaReset(&_frameArena);
+
+#ifdef DEBUG_BUILD
+    _lastFrameHeapAllocations = _vgl_heap_allocations - _frameStartHeapAllocations;
+    _frameStartHeapAllocations = _vgl_heap_allocations;
+#endif
+
+    _Vita_EndFrameTimings(stage_start);
+    Vita_EndBatchBreakFrame();
+
 #if DEBUG_BUILD
+    const float *cpu_ms = _frameTimings.cpu_ms;
+#ifdef VGL_GLFW_WINDOW
     char temp[128];
-    snprintf(temp, 128, "Draw Calls: %d; Texture Swaps: %d; Frame Time Ticks: %lu (%.6f s, %.4f ms)", draw_calls, totalTextureSwaps, last_frame_time_consumed_s, ((float)clock() - (float)last_frame_time_s) / CLOCKS_PER_SEC, (((float)clock() - (float)last_frame_time_s) / CLOCKS_PER_SEC) * 1000.f);
+    snprintf(temp, 128, "Draw Calls: %d; Texture Swaps: %d; Frame Time: %.4f ms", draw_calls, totalTextureSwaps, cpu_ms[VGL_TIMING_FRAME]);
 
     glfwSetWindowTitle(_game_window, temp);
 #endif
-#endif
 
-#if DEBUG_BUILD
-    if(last_printf_time == 0)
-        last_printf_time = clock();
-    if(clock() - last_printf_time > (6 * CLOCKS_PER_SEC))
+    if(_lastStatsPrintNs == 0)
+        _lastStatsPrintNs = stage_start;
+    if(stage_start - _lastStatsPrintNs > 6000000000ULL)
     {
-        last_printf_time = clock();
-        _debugPrintf("Draw Calls: %d; Texture Swaps: %d; Frame Time Ticks: %lu (%.6f s, %.4f ms)\n", draw_calls, totalTextureSwaps, last_frame_time_consumed_s, ((float)clock() - (float)last_frame_time_s) / CLOCKS_PER_SEC, (((float)clock() - (float)last_frame_time_s) / CLOCKS_PER_SEC) * 1000.f);
+        _lastStatsPrintNs = stage_start;
+        _debugPrintf("Draw Calls: %d; Texture Swaps: %d; Frame Time: %.4f ms (upload %.4f, sort %.4f, submit %.4f, draw %.4f, swap %.4f)\n",
+            draw_calls, totalTextureSwaps, cpu_ms[VGL_TIMING_FRAME], cpu_ms[VGL_TIMING_UPLOAD], cpu_ms[VGL_TIMING_SORT],
+            cpu_ms[VGL_TIMING_SUBMIT], cpu_ms[VGL_TIMING_DRAW], cpu_ms[VGL_TIMING_SWAP]);
+        if(_frameTimings.gpu_ms[VGL_TIMING_FRAME] >= 0.f)
+            _debugPrintf("GPU Time (frame %u): %.4f ms (upload %.4f, draw %.4f)\n", _frameTimings.gpu_frame,
+                _frameTimings.gpu_ms[VGL_TIMING_FRAME], _frameTimings.gpu_ms[VGL_TIMING_UPLOAD], _frameTimings.gpu_ms[VGL_TIMING_DRAW]);
+        _debugPrintf("Heap Allocations Last Frame: %lu; Frame Arena High Water: %zu / %zu bytes\n", _lastFrameHeapAllocations, _frameArena.high_water, _frameArena.size);
     }
 #endif
 
-
-    // Finish, reset total calls, and set the last frame time.
-    Vita_ResetTotalCalls();
-
-#if DEBUG_BUILD
-    last_frame_time_s = clock();
-#endif
     __vgl_repaint_inprog = 0;
 }
 
@@ -7,7 +7,9 @@ extern "C" {
 #define __VGL_RENDERER_H__
 
 
-#if defined(__APPLE__) || defined(PC_BUILD) 
+#if defined(VGL_NULL_BACKEND)
+#include "vgl_null_gl.h"
+#elif defined(__APPLE__) || defined(PC_BUILD) 
 #include <GL/glew.h>
 
 #ifndef __APPLE__
@@ -16,13 +18,22 @@ extern "C" {
 #include <OpenGL/glu.h>
 #endif
 
+#ifdef VGL_OFFSCREEN
+#include "vgl_offscreen.h"
+#else
 #include <GLFW/glfw3.h>
+#endif
 #else
 #include <vitasdk.h>
 #include <vitaGL.h>
 #include <psp2/gxm.h>
 #endif
 
+// PC builds open a GLFW window, unless they're headless (see vgl_null_gl.h & vgl_offscreen.h).
+#if !defined(VITA) && !defined(VGL_NULL_BACKEND) && !defined(VGL_OFFSCREEN)
+#define VGL_GLFW_WINDOW 1
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
@@ -46,11 +57,48 @@ extern "C" {
 // for just x & y, it's 2. this is used for stride.
 // In this case, we have (x, y) (s, v) and (r,g,b,a) available to us.
 #define VERTEX_ATTR_ELEM_COUNT 9
+#ifndef MAX_VERTICES
 #define MAX_VERTICES 8096 // TODO: This should be renamed to MAX_DRAWCALLS. We allocate our VBO with memory to fill MAX_VERTICES * sizeof(DrawCall)
+#endif
 
-#define VERTEX_ATTRIB_TOTAL_SIZE_1 (VERTEX_ATTR_ELEM_COUNT * sizeof(float)) + (sizeof(void *))
+// Quads a frame can hold with 16 bit indices (65536 vertices).
+// Builds raising MAX_VERTICES past it (cmake -DVGL_MAX_VERTICES=...) index with 32 bits.
+#define VGL_MAX_SHORT_INDEXED_QUADS 16384
+
+#define VERTEX_ATTRIB_TOTAL_SIZE_1 (VERTEX_ATTR_ELEM_COUNT * sizeof(float)) + (sizeof(VitaExDataHandle))
+
+// Shader feature bits. Every pass is compiled once per combination in use,
+// with a matching `#define` prepended to both of its shader stages.
+#define VGL_SHADER_TEXTURED      (1 << 0) // VGL_TEXTURED: sample ourTexture. Picked per batch.
+#define VGL_SHADER_ALPHA_TEST    (1 << 1) // VGL_ALPHA_TEST: discard mostly transparent fragments.
+#define VGL_SHADER_VERTEX_COLOR  (1 << 2) // VGL_VERTEX_COLOR: tint by the vertex color.
+#define VGL_SHADER_PREMULTIPLIED (1 << 3) // VGL_PREMULTIPLIED: textures have premultiplied alpha.
+#define VGL_SHADER_PALETTE       (1 << 4) // VGL_PALETTE: ourTexture holds indices into ourPalette. Picked per batch.
+#define VGL_SHADER_PALETTE4      (1 << 5) // VGL_PALETTE4: ...packed two per texel. Picked per batch.
+
+// The features chosen per batch, from what the batch draws.
+#define VGL_SHADER_PER_BATCH (VGL_SHADER_TEXTURED | VGL_SHADER_PALETTE | VGL_SHADER_PALETTE4)
 
 #include "vgl_renderer_types.h"
+#include "vgl_arena.h"
+#include "vgl_profiler.h"
+#include "vgl_frame_stats.h"
+#include "vgl_batch_breaks.h"
+
+// Size of the per frame arena (Vita_FrameAlloc).
+#ifndef VGL_FRAME_ARENA_SIZE
+#define VGL_FRAME_ARENA_SIZE (256 * 1024)
+#endif
+
+// Size of the scratch arena (Vita_ScratchAlloc). It holds the index
+// buffer's data while initGLAdv uploads it, so it grows with MAX_VERTICES.
+#ifndef VGL_SCRATCH_ARENA_SIZE
+#if MAX_VERTICES <= 8096
+#define VGL_SCRATCH_ARENA_SIZE (128 * 1024)
+#else
+#define VGL_SCRATCH_ARENA_SIZE (MAX_VERTICES * 6 * 4 + 32 * 1024)
+#endif
+#endif
 
 typedef unsigned int GLuint;
 
@@ -121,7 +169,7 @@ static inline void CHECK_GL_ERROR(char* prefix)
         printf("[%s] OPENGL ERROR: %s\n", prefix, error_buffer);
     }
 
-#ifndef VITA
+#ifdef VGL_GLFW_WINDOW
     memset(error_buffer, 0, sizeof(error_buffer));
     const char* _eb = (char*)error_buffer;
     if(glfwGetError(&_eb))
@@ -182,6 +230,83 @@ void Vita_Repaint();
 
 int Vita_AddShaderPass(char* vert_shader, char* frag_shader, int order);
 
+/**
+ * Vita_SetShaderFeatures():
+ *  Sets the VGL_SHADER_* features every batch is drawn with.
+ *  VGL_SHADER_PER_BATCH features are ignored here, they're chosen per batch.
+ *  Defaults to VGL_SHADER_VERTEX_COLOR.
+ */
+void Vita_SetShaderFeatures(unsigned int features);
+unsigned int Vita_GetShaderFeatures();
+
+/**
+ * Vita_SetProgramCacheDir():
+ *  Sets the directory linked shader program binaries are cached in.
+ *  Call before initGLShading2. NULL disables the cache.
+ */
+void Vita_SetProgramCacheDir(const char *dir);
+
+/**
+ * Vita_FrameAlloc():
+ *  Allocates `size` bytes that live until the end of the next Vita_Repaint,
+ *  when the whole frame arena is reset. Use it for anything that only
+ *  matters for one frame instead of malloc.
+ *
+ *  returns NULL if the frame arena (VGL_FRAME_ARENA_SIZE) is full.
+ */
+void *Vita_FrameAlloc(size_t size);
+
+/**
+ * Vita_ScratchBegin():
+ *  Opens a scratch scope. Everything allocated with Vita_ScratchAlloc
+ *  after this is freed by the matching Vita_ScratchEnd(mark).
+ *  Scopes nest.
+ */
+size_t Vita_ScratchBegin();
+void *Vita_ScratchAlloc(size_t size);
+void Vita_ScratchEnd(size_t mark);
+
+/**
+ * Vita_GetFrameHeapAllocations():
+ *  returns how many heap allocations the renderer made during the last
+ *  frame (Vita_Repaint to Vita_Repaint), on any thread (see vgl_alloc.h).
+ *  Should be 0 once everything is loaded. Always 0 outside DEBUG_BUILD,
+ *  where they aren't counted.
+ */
+unsigned long Vita_GetFrameHeapAllocations();
+
+/**
+ * Vita_GetFrameTimings():
+ *  Copies the wall time the last complete frame spent in each
+ *  VGL_TIMING_* stage of Vita_Repaint (and in total) to `timings`.
+ */
+void Vita_GetFrameTimings(VitaFrameTimings *timings);
+
+/**
+ * Vita_SetCulling():
+ *  Turns dropping sprites that are entirely off screen before they're
+ *  uploaded on (default) or off. Sprites are culled by where the MVP
+ *  puts them, so turn it off for vertex shaders that move them further.
+ *  Culled sprites are counted in Vita_GetFrameStats.
+ */
+void Vita_SetCulling(int enabled);
+
+/**
+ * Vita_SetSorting():
+ *  Turns sorting each frame's calls by texture, before they're drawn,
+ *  on or off (default, unless built with EXPERIMENTAL_SORTING).
+ *  Fewer batches, but the draw order (& so blending) changes.
+ */
+void Vita_SetSorting(int enabled);
+
+/**
+ * Vita_SetBatching():
+ *  Turns merging consecutive calls with the same state into one draw
+ *  on (default) or off. Off, every sprite is a draw of its own, which
+ *  is only useful to measure what batching saves.
+ */
+void Vita_SetBatching(int enabled);
+
 /// The most basic of draw functions. Draws a white square at a given point.
 void Vita_Draw(float x, float y, float wDst, float hDst);
 
@@ -213,7 +338,8 @@ void Vita_DrawRect4xColor(float x, float y,
 /**
  * Vita_DrawRectColorExData():
  *  Draws a colored rect with the option of passing in 
- *  pointer to `ex_data` for scale, rotation, and pivot data.
+ *  an `ex_data` handle for scale, rotation, and pivot data.
+ *  (See Vita_CreateExData.)
  */
 void Vita_DrawRectColorExData(float x, float y,
                            float wDst, float hDst,
@@ -221,7 +347,7 @@ void Vita_DrawRectColorExData(float x, float y,
                            float _g,
                            float _b,
                            float _a,
-                           struct _obj_extra_data *ex_data
+                           VitaExDataHandle ex_data
 );
 
 /**
@@ -234,8 +360,8 @@ void Vita_DrawRectColorExData(float x, float y,
  *  The tex_w & tex_h is used to normalize the given src coordinates
  *  into graphics texture space.
  * 
- *  You can also specify a pointer to `ex_data` for setting
- *  scaling, rotation, and pivot data. 
+ *  You can also specify an `ex_data` handle for setting
+ *  scaling, rotation, and pivot data. (See Vita_CreateExData.)
  */
 void Vita_DrawTextureAnimColorExData(
     float x,
@@ -253,7 +379,7 @@ void Vita_DrawTextureAnimColorExData(
     float _g,
     float _b,
     float _a,
-    struct _obj_extra_data *ex_data
+    VitaExDataHandle ex_data
 );
 
 /**
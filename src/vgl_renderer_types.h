@@ -1,13 +1,23 @@
 #ifndef __VGL_RENDERER_TYPES_H__
 #define __VGL_RENDERER_TYPES_H__
 
+#include <stdint.h>
+
+// A generational handle to renderer owned obj_extra_data (see vgl_ex_data.h).
+// The low VGL_EX_DATA_INDEX_BITS are the slot, the rest is the slot's generation
+// when the handle was made. Handles to destroyed data no longer match & resolve to NULL.
+typedef uint32_t VitaExDataHandle;
+
+// Never a valid handle. Draws with it use no extra data.
+#define VGL_EX_DATA_NONE 0
+
 typedef struct _vert 
 {
     float x, y, z;
     float s, v; // Tex Coord X, Tex Coord Y
     float _r, _g, _b, _a;
 
-    void *obj_ptr;
+    VitaExDataHandle ex_data;
 } __attribute__ ((packed)) vert;
 
 typedef struct _obj_extra_data 
@@ -19,8 +29,71 @@ typedef struct _obj_extra_data
     float rot_y;
     float rot_z;
     float scale;
+    unsigned int paletteID; // Indexed textures only, see Vita_SetExDataPalette.
+    unsigned short index_width; // 4 bit indexed textures only: their width.
 } __attribute__ ((packed)) obj_extra_data;
 
+// VitaTexture.state values.
+#define VGL_TEXTURE_LOADING 0 // Queued or decoding. textureID is the placeholder.
+#define VGL_TEXTURE_READY 1 // Fully uploaded. textureID, width & height are valid.
+#define VGL_TEXTURE_FAILED 2 // Couldn't be decoded. textureID stays the placeholder.
+
+// VitaTexture.filter values. See Vita_SetTextureFilter.
+#define VGL_TEXTURE_FILTER_NEAREST 0 // Default, for pixel art drawn at 1:1 or integer scales.
+#define VGL_TEXTURE_FILTER_BILINEAR 1
+#define VGL_TEXTURE_FILTER_TRILINEAR 2 // Bilinear between mip levels. Needs mips, else bilinear.
+
+// A texture handle handed out by the texture loader.
+// The handle is usable as soon as it's returned: until the image
+// is ready, textureID refers to a shared placeholder texture.
+// Read textureID from the handle when drawing rather than keeping a copy,
+// since it changes once the image is ready.
+typedef struct _vita_texture
+{
+    unsigned int textureID;
+    int width;
+    int height;
+    float inv_width; // 1 / width, for normalizing src rects.
+    float inv_height; // 1 / height
+    int state;
+    int levels; // Mip levels on the GPU, base level included. 1 while loading.
+    unsigned int paletteID; // Indexed textures (VGL_PIXEL_INDEX*): their palette texture, else 0.
+    char filter; // VGL_TEXTURE_FILTER_*
+    char pixel_format; // VGL_PIXEL_* the texels are stored as (see vgl_pixel_format.h).
+    char released; // Freed while still loading. Cleaned up once the load finishes.
+} VitaTexture;
+
+// Attribute & uniform locations of a linked program.
+// These are looked up once at link time, so the repaint loop
+// never has to call glGet*Location.
+typedef struct _shader_locations
+{
+    int PositionAttrib;
+    int TexCoordAttrib;
+    int ColorAttrib;
+
+    int MVPUniform;
+    int RotUniform;
+    int ScaleUniform;
+    int UseTextureUniform;
+    int OffsetUniform;
+    int PaletteUniform;
+    int IndexWidthUniform;
+} __attribute__ ((packed)) ShaderLocations;
+
+// Number of shader permutations a pass can have.
+// One for every combination of the VGL_SHADER_* feature bits.
+#define VGL_SHADER_VARIANT_COUNT 64
+
+// One permutation of a pass's shaders, compiled with
+// the #defines of a given set of VGL_SHADER_* features.
+typedef struct _shader_variant
+{
+    unsigned int ProgramObjectID;
+    char Built; // Set once a build was attempted, even if it failed.
+    struct _shader_locations Locations;
+} __attribute__ ((packed)) ShaderVariant;
+
 typedef struct _shading_pass
 {
     unsigned int ProgramObjectID;
@@ -28,6 +101,18 @@ typedef struct _shading_pass
     unsigned int FragmentShaderID;
     float offset_x;
     float offset_y;
+
+    struct _shader_locations Locations;
+
+    // The source every variant of this pass is built from.
+    char *VertexSource;
+    char *FragmentSource;
+
+    // Variants are built lazily, the first time a batch needs them.
+    // ProgramObjectID & Locations above mirror the BaseFeatures variant,
+    // which is used whenever another variant fails to build.
+    unsigned int BaseFeatures;
+    struct _shader_variant Variants[VGL_SHADER_VARIANT_COUNT];
 } __attribute__ ((packed)) ShadingPass;
 
 typedef struct _DrawCall
@@ -0,0 +1,689 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include "vgl_texture_compress.h"
+
+// ETC1 luminance modifier tables: {small, large}.
+// A pixel index picks +small, +large, -small or -large.
+static const int _etc1Tables[8][2] =
+{
+    { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+    { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static inline int _Vita_Clamp255(int v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline int _Vita_BlockBytes(uint32_t format)
+{
+    switch(format)
+    {
+    case VGL_COMPRESSED_RGB_S3TC_DXT1:
+    case VGL_COMPRESSED_RGBA_S3TC_DXT1:
+    case VGL_ETC1_RGB8:
+        return 8;
+    case VGL_COMPRESSED_RGBA_S3TC_DXT5:
+        return 16;
+    }
+
+    return 0;
+}
+
+/**
+ * _Vita_FetchBlock():
+ *  Copies the 4x4 block at (bx, by) out of `rgba`.
+ *  Blocks hanging off the edge repeat the last row/column.
+ */
+static void _Vita_FetchBlock(const unsigned char *rgba, int width, int height, int bx, int by, unsigned char block[16][4])
+{
+    for(int y = 0; y < 4; y++)
+    {
+        int sy = by + y < height ? by + y : height - 1;
+        for(int x = 0; x < 4; x++)
+        {
+            int sx = bx + x < width ? bx + x : width - 1;
+            memcpy(block[(y * 4) + x], rgba + (((size_t)sy * width) + sx) * 4, 4);
+        }
+    }
+}
+
+static void _Vita_StoreBlock(unsigned char *rgba, int width, int height, int bx, int by, unsigned char block[16][4])
+{
+    for(int y = 0; y < 4 && by + y < height; y++)
+    {
+        for(int x = 0; x < 4 && bx + x < width; x++)
+            memcpy(rgba + (((size_t)(by + y) * width) + bx + x) * 4, block[(y * 4) + x], 4);
+    }
+}
+
+static inline void _Vita_Expand565(uint16_t c, unsigned char out[4])
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+static inline uint16_t _Vita_Pack565(const unsigned char *c)
+{
+    return ((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3);
+}
+
+static inline int _Vita_ColorDistance(const unsigned char *a, const unsigned char *b)
+{
+    int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+    return (dr * dr) + (dg * dg) + (db * db);
+}
+
+// ------------------------------------------   DXT
+
+static void _Vita_DecodeDXTColor(const unsigned char *src, unsigned char block[16][4], int four_color)
+{
+    uint16_t c0 = src[0] | (src[1] << 8);
+    uint16_t c1 = src[2] | (src[3] << 8);
+    uint32_t indices = src[4] | (src[5] << 8) | (src[6] << 16) | ((uint32_t)src[7] << 24);
+
+    unsigned char palette[4][4];
+    _Vita_Expand565(c0, palette[0]);
+    _Vita_Expand565(c1, palette[1]);
+
+    if(four_color || c0 > c1)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            palette[2][i] = ((2 * palette[0][i]) + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + (2 * palette[1][i])) / 3;
+        }
+        palette[2][3] = palette[3][3] = 255;
+    }
+    else
+    {
+        for(int i = 0; i < 3; i++)
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+        palette[2][3] = 255;
+        memset(palette[3], 0, 4); // Transparent black.
+    }
+
+    for(int i = 0; i < 16; i++)
+        memcpy(block[i], palette[(indices >> (i * 2)) & 3], 4);
+}
+
+static void _Vita_DecodeDXT5Alpha(const unsigned char *src, unsigned char block[16][4])
+{
+    int a[8];
+    a[0] = src[0];
+    a[1] = src[1];
+
+    if(a[0] > a[1])
+    {
+        for(int i = 1; i < 7; i++)
+            a[i + 1] = (((7 - i) * a[0]) + (i * a[1])) / 7;
+    }
+    else
+    {
+        for(int i = 1; i < 5; i++)
+            a[i + 1] = (((5 - i) * a[0]) + (i * a[1])) / 5;
+        a[6] = 0;
+        a[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for(int i = 0; i < 6; i++)
+        bits |= (uint64_t)src[2 + i] << (8 * i);
+
+    for(int i = 0; i < 16; i++)
+        block[i][3] = a[(bits >> (i * 3)) & 7];
+}
+
+/**
+ * _Vita_FitDXTEndpoints():
+ *  Snaps every pixel of `block` to the closest palette entry of (c0, c1).
+ *  Pixels with alpha < `alpha_cutoff` are skipped, or with `transparent`
+ *  use the transparent index.
+ *
+ *  returns the summed squared error of the fitted pixels.
+ */
+static int _Vita_FitDXTEndpoints(unsigned char block[16][4], uint16_t c0, uint16_t c1, int transparent, int alpha_cutoff, uint32_t *indices_out)
+{
+    unsigned char palette[4][4];
+    _Vita_Expand565(c0, palette[0]);
+    _Vita_Expand565(c1, palette[1]);
+    int colors = transparent ? 3 : 4;
+
+    if(transparent)
+    {
+        for(int i = 0; i < 3; i++)
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+    }
+    else
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            palette[2][i] = ((2 * palette[0][i]) + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + (2 * palette[1][i])) / 3;
+        }
+    }
+
+    uint32_t indices = 0;
+    int error = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        int best = 0;
+        if(block[i][3] < alpha_cutoff)
+            best = transparent ? 3 : 0;
+        else
+        {
+            int best_dist = 1 << 30;
+            for(int p = 0; p < colors; p++)
+            {
+                int dist = _Vita_ColorDistance(block[i], palette[p]);
+                if(dist < best_dist) { best_dist = dist; best = p; }
+            }
+            error += best_dist;
+        }
+
+        indices |= (uint32_t)best << (i * 2);
+    }
+
+    *indices_out = indices;
+    return error;
+}
+
+/**
+ * _Vita_EncodeDXTColor():
+ *  Starts from the two pixels furthest apart along the block's principal
+ *  color axis, then tries every other pair of pixel colors as endpoints
+ *  and keeps the pair with the least error. The search is what keeps
+ *  small pixel art sprites, whose blocks hold a few unrelated colors,
+ *  recognizable.
+ *
+ *  With `separate_alpha` (DXT5) fully transparent pixels don't count,
+ *  their color is never seen. With `allow_transparent` (DXT1A), blocks
+ *  with pixels of alpha < 128 use the 3 color + transparent mode.
+ */
+static void _Vita_EncodeDXTColor(unsigned char block[16][4], unsigned char *out, int allow_transparent, int separate_alpha)
+{
+    int transparent = 0;
+    if(allow_transparent)
+    {
+        for(int i = 0; i < 16; i++)
+            if(block[i][3] < 128) transparent = 1;
+    }
+
+    // Only fit the pixels that will be visible, unless none are.
+    int alpha_cutoff = transparent ? 128 : (separate_alpha ? 1 : 0);
+    int fitted = 0;
+    for(int i = 0; i < 16; i++)
+        if(block[i][3] >= alpha_cutoff) fitted++;
+
+    if(fitted == 0 && transparent)
+    {
+        // Nothing visible: both endpoints black, every index transparent.
+        memset(out, 0, 4);
+        memset(out + 4, 0xFF, 4);
+        return;
+    }
+    if(fitted == 0) alpha_cutoff = 0;
+
+    float mean[3] = { 0, 0, 0 };
+    int count = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] < alpha_cutoff) continue;
+        for(int c = 0; c < 3; c++) mean[c] += block[i][c];
+        count++;
+    }
+    for(int c = 0; c < 3; c++) mean[c] /= count;
+
+    // Covariance, then a few rounds of power iteration for its main axis.
+    float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] < alpha_cutoff) continue;
+
+        float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    float axis[3] = { 1.f, 1.f, 1.f };
+    for(int it = 0; it < 8; it++)
+    {
+        float x = (cov[0] * axis[0]) + (cov[1] * axis[1]) + (cov[2] * axis[2]);
+        float y = (cov[1] * axis[0]) + (cov[3] * axis[1]) + (cov[4] * axis[2]);
+        float z = (cov[2] * axis[0]) + (cov[4] * axis[1]) + (cov[5] * axis[2]);
+
+        float m = x < 0 ? -x : x;
+        if((y < 0 ? -y : y) > m) m = y < 0 ? -y : y;
+        if((z < 0 ? -z : z) > m) m = z < 0 ? -z : z;
+        if(m < 1e-6f) break; // Flat block, any axis works.
+
+        axis[0] = x / m;
+        axis[1] = y / m;
+        axis[2] = z / m;
+    }
+
+    float min_proj = 1e30f, max_proj = -1e30f;
+    int min_i = 0, max_i = 0;
+
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] < alpha_cutoff) continue;
+
+        float proj = (block[i][0] * axis[0]) + (block[i][1] * axis[1]) + (block[i][2] * axis[2]);
+        if(proj < min_proj) { min_proj = proj; min_i = i; }
+        if(proj > max_proj) { max_proj = proj; max_i = i; }
+    }
+
+    uint16_t best_c0 = _Vita_Pack565(block[max_i]);
+    uint16_t best_c1 = _Vita_Pack565(block[min_i]);
+    uint32_t best_indices = 0;
+    int best_error = 1 << 30;
+
+    // Candidate endpoints: the PCA pair first, then every pair of distinct visible colors.
+    uint16_t colors[16];
+    int color_count = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] < alpha_cutoff) continue;
+
+        uint16_t c = _Vita_Pack565(block[i]);
+        int seen = 0;
+        for(int j = 0; j < color_count; j++)
+            if(colors[j] == c) seen = 1;
+        if(!seen) colors[color_count++] = c;
+    }
+
+    for(int a = -1; a < color_count; a++)
+    {
+        for(int b = a + 1; b < color_count; b++)
+        {
+            uint16_t c0 = a < 0 ? best_c0 : colors[a];
+            uint16_t c1 = a < 0 ? best_c1 : colors[b];
+
+            // 4 color mode needs c0 > c1, 3 color mode c0 <= c1.
+            if((transparent && c0 > c1) || (!transparent && c0 < c1))
+            {
+                uint16_t tmp = c0;
+                c0 = c1;
+                c1 = tmp;
+            }
+
+            // c0 == c1 reads back as 3 color mode, only fine if that's what we want.
+            if(!transparent && c0 == c1 && c0 > 0) c1 = c0 - 1;
+
+            uint32_t indices;
+            int error = _Vita_FitDXTEndpoints(block, c0, c1, transparent, alpha_cutoff, &indices);
+            if(error < best_error)
+            {
+                best_error = error;
+                best_c0 = c0;
+                best_c1 = c1;
+                best_indices = indices;
+            }
+
+            if(a < 0) break; // The PCA pair is a single candidate.
+        }
+    }
+
+    out[0] = best_c0 & 0xFF;
+    out[1] = best_c0 >> 8;
+    out[2] = best_c1 & 0xFF;
+    out[3] = best_c1 >> 8;
+    out[4] = best_indices & 0xFF;
+    out[5] = (best_indices >> 8) & 0xFF;
+    out[6] = (best_indices >> 16) & 0xFF;
+    out[7] = best_indices >> 24;
+}
+
+static void _Vita_EncodeDXT5Alpha(unsigned char block[16][4], unsigned char *out)
+{
+    int a0 = 0, a1 = 255;
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] > a0) a0 = block[i][3];
+        if(block[i][3] < a1) a1 = block[i][3];
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+
+    uint64_t bits = 0;
+    if(a0 > a1)
+    {
+        int a[8];
+        a[0] = a0;
+        a[1] = a1;
+        for(int i = 1; i < 7; i++)
+            a[i + 1] = (((7 - i) * a0) + (i * a1)) / 7;
+
+        for(int i = 0; i < 16; i++)
+        {
+            int best = 0, best_dist = 1 << 30;
+            for(int p = 0; p < 8; p++)
+            {
+                int dist = block[i][3] - a[p];
+                dist *= dist;
+                if(dist < best_dist) { best_dist = dist; best = p; }
+            }
+
+            bits |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    for(int i = 0; i < 6; i++)
+        out[2 + i] = (bits >> (8 * i)) & 0xFF;
+}
+
+// ------------------------------------------   ETC1
+
+static void _Vita_DecodeETC1(const unsigned char *src, unsigned char block[16][4])
+{
+    uint32_t high = ((uint32_t)src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
+    uint32_t low = ((uint32_t)src[4] << 24) | (src[5] << 16) | (src[6] << 8) | src[7];
+
+    int flip = high & 1;
+    int diff = (high >> 1) & 1;
+    int table[2] = { (high >> 5) & 7, (high >> 2) & 7 };
+    int base[2][3];
+
+    for(int c = 0; c < 3; c++)
+    {
+        int shift = 24 - (c * 8);
+        if(diff)
+        {
+            int b1 = (high >> (shift + 3)) & 31;
+            int d = (high >> shift) & 7;
+            int b2 = b1 + ((d & 4) ? d - 8 : d);
+
+            base[0][c] = (b1 << 3) | (b1 >> 2);
+            base[1][c] = ((b2 & 31) << 3) | ((b2 & 31) >> 2);
+        }
+        else
+        {
+            int b1 = (high >> (shift + 4)) & 15;
+            int b2 = (high >> shift) & 15;
+
+            base[0][c] = (b1 << 4) | b1;
+            base[1][c] = (b2 << 4) | b2;
+        }
+    }
+
+    for(int y = 0; y < 4; y++)
+    {
+        for(int x = 0; x < 4; x++)
+        {
+            int sub = flip ? (y >= 2) : (x >= 2);
+            int p = (x * 4) + y;
+            int index = (((low >> (16 + p)) & 1) << 1) | ((low >> p) & 1);
+
+            int mod = _etc1Tables[table[sub]][index & 1];
+            if(index & 2) mod = -mod;
+
+            unsigned char *out = block[(y * 4) + x];
+            for(int c = 0; c < 3; c++)
+                out[c] = _Vita_Clamp255(base[sub][c] + mod);
+            out[3] = 255;
+        }
+    }
+}
+
+// Both index bits of every pixel in one half block.
+static uint32_t _Vita_ETC1SubMask(int flip, int sub)
+{
+    uint32_t mask = 0;
+    for(int y = 0; y < 4; y++)
+    {
+        for(int x = 0; x < 4; x++)
+        {
+            if((flip ? (y >= 2) : (x >= 2)) != sub) continue;
+
+            int p = (x * 4) + y;
+            mask |= (1u << (16 + p)) | (1u << p);
+        }
+    }
+
+    return mask;
+}
+
+/**
+ * _Vita_FitETC1Sub():
+ *  Finds the modifier table & per pixel indices that best fit the
+ *  pixels of one half block around `base`.
+ *  returns the squared error.
+ */
+static int _Vita_FitETC1Sub(unsigned char block[16][4], int flip, int sub, const int base[3], int *table_out, uint32_t *low)
+{
+    int best_error = 1 << 30;
+
+    for(int t = 0; t < 8; t++)
+    {
+        int error = 0;
+        uint32_t bits = 0;
+
+        for(int y = 0; y < 4; y++)
+        {
+            for(int x = 0; x < 4; x++)
+            {
+                if((flip ? (y >= 2) : (x >= 2)) != sub) continue;
+
+                const unsigned char *px = block[(y * 4) + x];
+                int best = 0, best_dist = 1 << 30;
+
+                for(int index = 0; index < 4; index++)
+                {
+                    int mod = _etc1Tables[t][index & 1];
+                    if(index & 2) mod = -mod;
+
+                    int dist = 0;
+                    for(int c = 0; c < 3; c++)
+                    {
+                        int d = px[c] - _Vita_Clamp255(base[c] + mod);
+                        dist += d * d;
+                    }
+
+                    if(dist < best_dist) { best_dist = dist; best = index; }
+                }
+
+                int p = (x * 4) + y;
+                bits |= ((uint32_t)(best >> 1) << (16 + p)) | ((uint32_t)(best & 1) << p);
+                error += best_dist;
+            }
+        }
+
+        if(error < best_error)
+        {
+            best_error = error;
+            *table_out = t;
+            *low = (*low & ~_Vita_ETC1SubMask(flip, sub)) | bits;
+        }
+    }
+
+    return best_error;
+}
+
+static void _Vita_EncodeETC1(unsigned char block[16][4], unsigned char *out)
+{
+    int best_error = 1 << 30;
+    uint32_t best_high = 0, best_low = 0;
+
+    for(int flip = 0; flip < 2; flip++)
+    {
+        int avg[2][3] = { { 0 } };
+        for(int y = 0; y < 4; y++)
+        {
+            for(int x = 0; x < 4; x++)
+            {
+                int sub = flip ? (y >= 2) : (x >= 2);
+                for(int c = 0; c < 3; c++)
+                    avg[sub][c] += block[(y * 4) + x][c];
+            }
+        }
+
+        int q5[2][3], q4[2][3];
+        int can_diff = 1;
+        for(int s = 0; s < 2; s++)
+        {
+            for(int c = 0; c < 3; c++)
+            {
+                avg[s][c] = (avg[s][c] + 4) / 8;
+                q5[s][c] = ((avg[s][c] * 31) + 127) / 255;
+                q4[s][c] = ((avg[s][c] * 15) + 127) / 255;
+            }
+        }
+        for(int c = 0; c < 3; c++)
+        {
+            int d = q5[1][c] - q5[0][c];
+            if(d < -4 || d > 3) can_diff = 0;
+        }
+
+        // Individual mode (444 + 444) always fits. Differential (555 + 333 delta)
+        // is more precise, but only when the two halves are close in color.
+        for(int diff = 0; diff <= can_diff; diff++)
+        {
+            int base[2][3];
+            uint32_t high = (diff << 1) | flip;
+
+            for(int c = 0; c < 3; c++)
+            {
+                int shift = 24 - (c * 8);
+                if(diff)
+                {
+                    base[0][c] = (q5[0][c] << 3) | (q5[0][c] >> 2);
+                    base[1][c] = (q5[1][c] << 3) | (q5[1][c] >> 2);
+                    high |= ((uint32_t)q5[0][c] << (shift + 3)) | ((uint32_t)((q5[1][c] - q5[0][c]) & 7) << shift);
+                }
+                else
+                {
+                    base[0][c] = (q4[0][c] << 4) | q4[0][c];
+                    base[1][c] = (q4[1][c] << 4) | q4[1][c];
+                    high |= ((uint32_t)q4[0][c] << (shift + 4)) | ((uint32_t)q4[1][c] << shift);
+                }
+            }
+
+            int t0 = 0, t1 = 0;
+            uint32_t low = 0;
+            int error = _Vita_FitETC1Sub(block, flip, 0, base[0], &t0, &low)
+                + _Vita_FitETC1Sub(block, flip, 1, base[1], &t1, &low);
+
+            high |= (t0 << 5) | (t1 << 2);
+
+            if(error < best_error)
+            {
+                best_error = error;
+                best_high = high;
+                best_low = low;
+            }
+        }
+    }
+
+    for(int i = 0; i < 4; i++)
+    {
+        out[i] = (best_high >> (24 - (i * 8))) & 0xFF;
+        out[4 + i] = (best_low >> (24 - (i * 8))) & 0xFF;
+    }
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_IsCompressedFormat(uint32_t format)
+{
+    return _Vita_BlockBytes(format) != 0;
+}
+
+size_t Vita_CompressedSize(uint32_t format, int width, int height)
+{
+    if(width <= 0 || height <= 0) return 0;
+
+    size_t blocks_x = ((size_t)width + 3) / 4, blocks_y = ((size_t)height + 3) / 4;
+    size_t block_bytes = _Vita_BlockBytes(format);
+    if(block_bytes == 0 || blocks_x > SIZE_MAX / block_bytes / blocks_y) return 0;
+
+    return blocks_x * blocks_y * block_bytes;
+}
+
+int Vita_DecodeCompressed(uint32_t format, const void *src, int width, int height, unsigned char *rgba_out)
+{
+    int block_bytes = _Vita_BlockBytes(format);
+    if(block_bytes == 0) return -1;
+
+    const unsigned char *in = (const unsigned char *)src;
+    unsigned char block[16][4];
+
+    for(int by = 0; by < height; by += 4)
+    {
+        for(int bx = 0; bx < width; bx += 4, in += block_bytes)
+        {
+            switch(format)
+            {
+            case VGL_COMPRESSED_RGB_S3TC_DXT1:
+                _Vita_DecodeDXTColor(in, block, 0);
+                // No alpha in the RGB variant, the transparent entry is just black.
+                for(int i = 0; i < 16; i++) block[i][3] = 255;
+                break;
+            case VGL_COMPRESSED_RGBA_S3TC_DXT1:
+                _Vita_DecodeDXTColor(in, block, 0);
+                break;
+            case VGL_COMPRESSED_RGBA_S3TC_DXT5:
+                _Vita_DecodeDXTColor(in + 8, block, 1);
+                _Vita_DecodeDXT5Alpha(in, block);
+                break;
+            case VGL_ETC1_RGB8:
+                _Vita_DecodeETC1(in, block);
+                break;
+            }
+
+            _Vita_StoreBlock(rgba_out, width, height, bx, by, block);
+        }
+    }
+
+    return 0;
+}
+
+int Vita_EncodeCompressed(uint32_t format, const unsigned char *rgba, int width, int height, void *out)
+{
+    int block_bytes = _Vita_BlockBytes(format);
+    if(block_bytes == 0) return -1;
+
+    unsigned char *dst = (unsigned char *)out;
+    unsigned char block[16][4];
+
+    for(int by = 0; by < height; by += 4)
+    {
+        for(int bx = 0; bx < width; bx += 4, dst += block_bytes)
+        {
+            _Vita_FetchBlock(rgba, width, height, bx, by, block);
+
+            switch(format)
+            {
+            case VGL_COMPRESSED_RGB_S3TC_DXT1:
+                _Vita_EncodeDXTColor(block, dst, 0, 0);
+                break;
+            case VGL_COMPRESSED_RGBA_S3TC_DXT1:
+                _Vita_EncodeDXTColor(block, dst, 1, 0);
+                break;
+            case VGL_COMPRESSED_RGBA_S3TC_DXT5:
+                _Vita_EncodeDXT5Alpha(block, dst);
+                _Vita_EncodeDXTColor(block, dst + 8, 0, 1);
+                break;
+            case VGL_ETC1_RGB8:
+                _Vita_EncodeETC1(block, dst);
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
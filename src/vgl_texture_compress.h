@@ -0,0 +1,74 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_TEXTURE_COMPRESS_H__
+#define __VGL_TEXTURE_COMPRESS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    CPU encoders & decoders for the block compressed formats the
+    texture loader accepts. Every format works on 4x4 pixel blocks:
+
+        DXT1 (S3TC BC1): 8 bytes per block. Two 565 colors + 2 bit indices.
+                         The RGBA variant can also mark pixels transparent.
+        DXT5 (S3TC BC3): 16 bytes per block. A DXT1 color block plus
+                         two 8 bit alphas with 3 bit indices.
+        ETC1:            8 bytes per block. Two half-block base colors,
+                         each with a luminance modifier table.
+
+    Decoding is used when the GPU can't sample a format. Encoding is used
+    by the texture converter (tools/vgl_texconv.c). Neither touches GL,
+    so both run anywhere.
+
+    Formats are identified by their GL internal format enums.
+*/
+
+#define VGL_COMPRESSED_RGB_S3TC_DXT1  0x83F0 // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define VGL_COMPRESSED_RGBA_S3TC_DXT1 0x83F1 // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define VGL_COMPRESSED_RGBA_S3TC_DXT5 0x83F3 // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define VGL_ETC1_RGB8                 0x8D64 // GL_ETC1_RGB8_OES
+
+/**
+ * Vita_IsCompressedFormat():
+ *  returns 1 if `format` is one of the formats above.
+ */
+int Vita_IsCompressedFormat(uint32_t format);
+
+/**
+ * Vita_CompressedSize():
+ *  returns the number of bytes a `width` x `height` image takes in `format`,
+ *  or 0 if the format isn't known, the size isn't positive or the bytes
+ *  don't fit in a size_t. Partial blocks are rounded up.
+ */
+size_t Vita_CompressedSize(uint32_t format, int width, int height);
+
+/**
+ * Vita_DecodeCompressed():
+ *  Decodes `src` into tightly packed RGBA8 pixels.
+ *  `rgba_out` must hold width * height * 4 bytes.
+ *
+ *  returns 0 on success, -1 if the format isn't known.
+ */
+int Vita_DecodeCompressed(uint32_t format, const void *src, int width, int height, unsigned char *rgba_out);
+
+/**
+ * Vita_EncodeCompressed():
+ *  Encodes tightly packed RGBA8 pixels into `out`,
+ *  which must hold Vita_CompressedSize(format, width, height) bytes.
+ *
+ *  DXT endpoints are searched per block, ETC1 tries both flips, both
+ *  modes and every modifier table. Small pixel art with many colors per
+ *  block still loses detail; `vgl_texconv --verify` reports how much.
+ *
+ *  returns 0 on success, -1 if the format isn't known.
+ */
+int Vita_EncodeCompressed(uint32_t format, const unsigned char *rgba, int width, int height, void *out);
+
+#endif // __VGL_TEXTURE_COMPRESS_H__
+
+#ifdef __cplusplus
+}
+#endif
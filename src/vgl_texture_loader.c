@@ -0,0 +1,1660 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "vgl_renderer.h"
+#include "vgl_texture_loader.h"
+
+#include <pthread.h>
+
+#if defined(__APPLE__) || defined(PC_BUILD)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VGL_LOADER_MMAP 1
+#endif
+
+#include "stb_image.h"
+#include "basic_hash_map.h"
+#include "vgl_pool.h"
+#include "vgl_ktx.h"
+#include "vgl_texture_compress.h"
+#include "vgl_pack.h"
+#include "vgl_mipmap.h"
+#include "vgl_pixel_format.h"
+
+// Loader pipeline:
+//  Vita_LoadTextureAsync  -> _pending (decode queue)
+//  worker thread          -> decodes -> _decoded (upload queue)
+//  Vita_PumpTextureUploads (GL thread) -> uploads within budget -> READY
+//
+// KTX files skip decoding: formats the GPU samples are uploaded as is
+// with glCompressedTexImage2D, the rest are decoded to RGBA8 on the worker.
+// RGBA8 KTX files (and their mip chains) are uploaded straight out of the
+// file, which is memory mapped on PC or found in the mounted asset pack.
+// With a 16 bit pixel format set, RGBA8 images (mips included) are
+// converted on the worker and uploaded with the matching packed GL type.
+// Indexed formats are palettized there instead, their palette uploaded
+// as its own 256x1 texture when the image is done.
+//
+// Residency: every GL texture the loader owns (not aliases) is kept in an
+// LRU list by when it was last drawn (Vita_TouchTexture). Past the budget,
+// the least recent ones have their storage swapped for a 1x1 transparent
+// level, keeping their GL name so copies of textureID stay valid. Touching
+// one again queues a reload job, which goes through the same pipeline with
+// the settings it was first queued with & uploads into that same name.
+
+#define MAX_LOADER_WORKERS 4
+
+// Most compressed formats we remember from GL_COMPRESSED_TEXTURE_FORMATS.
+#define MAX_COMPRESSED_FORMATS 64
+
+// Who owns TextureLoadJob.pixels.
+#define PIXELS_STB 0  // stbi_load, freed with stbi_image_free.
+#define PIXELS_HEAP 1 // CPU decoded KTX or converted texels, freed with free.
+#define PIXELS_FILE 2 // Points into file_data.
+
+// Where TextureLoadJob.file_data comes from.
+#define FILE_HEAP 0   // Read in, freed with free.
+#define FILE_MAPPED 1 // mmap'd, unmapped when done.
+#define FILE_PACKED 2 // Inside the mounted asset pack, never freed.
+
+// Initial capacity of each of the texture cache's lookup maps. They grow as needed.
+#define TEXTURE_CACHE_INITIAL_SIZE 256
+
+// TextureRecord.residency values.
+#define RESIDENCY_NONE 0      // Not a GL texture owner (loading, failed or an alias).
+#define RESIDENCY_RESIDENT 1  // On the GPU, in the LRU list.
+#define RESIDENCY_EVICTED 2   // Storage released. Reloaded when touched.
+#define RESIDENCY_RELOADING 3 // A reload job is in flight.
+#define RESIDENCY_LOST 4      // The reload failed. Stays transparent.
+
+// GPU bytes of a palette texture.
+#define PALETTE_BYTES (VGL_PALETTE_SIZE * 4)
+
+// Loader/cache bookkeeping behind every VitaTexture handle.
+// `texture` must stay the first member: handles are cast back to records.
+typedef struct _texture_record
+{
+    VitaTexture texture;
+
+    // The path it was loaded from, to reload it from. For cache entries,
+    // also the one copy of this path the cache keeps.
+    char *path;
+
+    // Cache entries only (refs > 0). Plain async loads leave these empty.
+    int refs;
+    uint64_t path_hash;
+    uint64_t content_hash;
+
+    // Set when the decoded pixels matched a texture already in the cache.
+    // The GL texture belongs to `alias_of`, this record holds a ref on it.
+    struct _texture_record *alias_of;
+
+    // Indexed textures: a CPU copy of the palette, for Vita_GetTexturePalette.
+    // Aliases keep their own, only the indices are shared.
+    unsigned char *palette;
+    int palette_colors;
+
+    // How it was queued, so a reload ends up the same.
+    char load_mipmap;
+    char load_pixel_format;
+    char load_dither;
+    char load_premultiply;
+
+    // Residency, GL texture owners only. See Vita_SetTextureBudget.
+    char residency; // RESIDENCY_*
+    size_t gpu_bytes; // Its storage while resident, palette excluded.
+    uint32_t last_used; // _residencyFrame it was last touched.
+    struct _texture_record *lru_prev, *lru_next; // Towards the most / least recently used.
+} TextureRecord;
+
+typedef struct _texture_load_job
+{
+    struct _texture_load_job *next;
+
+    // Only ever touched on the GL thread.
+    TextureRecord *record;
+
+    // Reloading an evicted texture into record's GL texture.
+    char reload;
+
+    // Filled in by the worker.
+    char *path;
+    const char *error;
+    unsigned char *pixels; // In pixel_format, NULL for compressed uploads.
+    char pixels_owner;
+    int width;
+    int height;
+    uint64_t content_hash;
+
+    // KTX files only: the whole file, which pixels & level_data point into.
+    unsigned char *file_data;
+    size_t file_size;
+    char file_source;
+
+    // Premultiply colors by alpha: VGL_SHADER_PREMULTIPLIED was on when queued.
+    char premultiply;
+    char premultiplied; // What the pixels ended up as.
+
+    // VGL_MIPMAP_* chain to build for RGBA8 images without one, into mip_data.
+    char mipmap;
+    unsigned char *mip_data;
+
+    // VGL_PIXEL_* to store RGBA8 images as (VGL_PIXEL_AUTO: let the worker
+    // pick), then what they ended up as. `dither` converts with ordered dithering.
+    char pixel_format;
+    char dither;
+
+    // Indexed formats: VGL_PALETTE_SIZE RGBA8 colors, handed to the record.
+    unsigned char *palette;
+    int palette_colors;
+    char palette_exact; // 0 if colors were merged to fit.
+
+    // Compressed (format != 0) or RGBA8 KTX uploads with a mip chain.
+    uint32_t format;
+    int levels;
+    const unsigned char *level_data[VGL_KTX_MAX_LEVELS];
+    uint32_t level_size[VGL_KTX_MAX_LEVELS];
+
+    // Upload progress, GL thread only.
+    GLuint textureID;
+    int rows_uploaded;
+    int levels_uploaded;
+} TextureLoadJob;
+
+static void (*_debugPrintf)(const char*, ...);
+
+static pthread_t _workers[MAX_LOADER_WORKERS];
+static int _workerCount = 0;
+static char _running = 0;
+
+static pthread_mutex_t _queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _queueSignal = PTHREAD_COND_INITIALIZER;
+
+// Jobs waiting for a worker (FIFO).
+static TextureLoadJob *_pendingHead, *_pendingTail;
+
+// Decoded jobs waiting for the GL thread (FIFO).
+static TextureLoadJob *_decodedHead, *_decodedTail;
+
+// Jobs handed out but not finished yet. GL thread only.
+static int _inFlight = 0;
+
+static size_t _uploadBudget = VGL_DEFAULT_UPLOAD_BUDGET;
+
+// Mip filter for textures queued from now on. GL thread only.
+static int _mipmapFilter = VGL_MIPMAP_NONE;
+
+// Set by Vita_SetTexturePixelFormat, picked up by jobs when they're queued.
+static int _pixelFormat = VGL_PIXEL_RGBA8888;
+static int _pixelDither = 0;
+
+// 1x1 transparent texture every loading handle points at.
+static GLuint _placeholderTexture = 0;
+
+// Compressed formats the GPU can sample. Written before the workers start, read only after.
+static GLint _compressedFormats[MAX_COMPRESSED_FORMATS];
+static int _compressedFormatCount = 0;
+
+// Records & jobs are small and churn with every load, so they come from pools. GL thread only.
+static VitaPool _recordPool;
+static VitaPool _jobPool;
+
+// Texture cache, path hash -> record & content hash -> record. GL thread only.
+static bm_map_t *_cacheByPath;
+static bm_map_t *_cacheByContent;
+
+// Residency, GL thread only. GL texture name -> owning record, for every
+// resident or evicted texture, and the resident ones most recently used first.
+static bm_map_t *_textureOwners;
+static TextureRecord *_lruHead, *_lruTail;
+static size_t _textureBudget = VGL_DEFAULT_TEXTURE_BUDGET;
+static size_t _residentBytes = 0;
+static int _residentCount = 0;
+static int _evictedCount = 0;
+static unsigned int _evictionCount = 0;
+static unsigned int _reloadCount = 0;
+static char _overBudgetWarned = 0;
+
+// Counts Vita_PumpTextureUploads calls, i.e. frames.
+static uint32_t _residencyFrame = 0;
+
+// Bytes the last Vita_PumpTextureUploads uploaded.
+static size_t _pumpUploadedBytes = 0;
+
+// ------------------------------------------   INTERNAL FUNCTIONS
+
+static inline void _Vita_JobPush(TextureLoadJob **head, TextureLoadJob **tail, TextureLoadJob *job)
+{
+    job->next = NULL;
+    if(*tail != NULL) (*tail)->next = job;
+    else *head = job;
+    *tail = job;
+}
+
+static inline TextureLoadJob *_Vita_JobPop(TextureLoadJob **head, TextureLoadJob **tail)
+{
+    TextureLoadJob *job = *head;
+    if(job == NULL) return NULL;
+
+    *head = job->next;
+    if(*head == NULL) *tail = NULL;
+    job->next = NULL;
+    return job;
+}
+
+static inline uint64_t _Vita_HashPath(const char *path)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(; *path != '\0'; path++)
+    {
+        hash ^= (unsigned char)*path;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * _Vita_HashPixels():
+ *  Hashes `size` bytes of image data (RGBA pixels or a compressed level)
+ *  8 bytes at a time. Runs on the worker, right after decoding.
+ */
+static uint64_t _Vita_HashPixels(const unsigned char *pixels, size_t size, int width, int height)
+{
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)width << 32) ^ (uint64_t)height;
+
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, pixels + i, sizeof(word));
+        hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 32;
+    }
+
+    for(; i < size; i++)
+        hash = (hash ^ pixels[i]) * 0x100000001b3ULL;
+
+    return hash;
+}
+
+static inline TextureRecord *_Vita_Record(VitaTexture *texture)
+{
+    return (TextureRecord *)texture;
+}
+
+/**
+ * _Vita_CacheUnlink():
+ *  Removes `id` from `map`, but only if it maps to `record`.
+ *  (A 64 bit hash collision leaves the second record out of the map.)
+ */
+static void _Vita_CacheUnlink(bm_map_t *map, uint64_t id, TextureRecord *record)
+{
+    bm_key_t *entry = get_by_id_basic_map(map, id);
+    if(entry != NULL && entry->obj_ptr == record)
+        remove_basic_map(map, id);
+}
+
+/**
+ * _Vita_CacheFindContent():
+ *  returns the ready, non-aliased cache entry holding
+ *  exactly these pixels, or NULL.
+ */
+static TextureRecord *_Vita_CacheFindContent(uint64_t content_hash, int width, int height)
+{
+    bm_key_t *entry = get_by_id_basic_map(_cacheByContent, content_hash);
+    if(entry == NULL) return NULL;
+
+    TextureRecord *it = (TextureRecord *)entry->obj_ptr;
+    if(it->texture.width != width || it->texture.height != height)
+        return NULL;
+
+    return it;
+}
+
+static void _Vita_ReleaseFile(TextureLoadJob *job)
+{
+#ifdef VGL_LOADER_MMAP
+    if(job->file_source == FILE_MAPPED) munmap(job->file_data, job->file_size);
+    else
+#endif
+    if(job->file_source == FILE_HEAP) free(job->file_data);
+
+    job->file_data = NULL;
+    job->file_source = FILE_HEAP;
+}
+
+static void _Vita_FreeJob(TextureLoadJob *job)
+{
+    if(job->pixels_owner == PIXELS_STB) stbi_image_free(job->pixels);
+    else if(job->pixels_owner == PIXELS_HEAP) free(job->pixels);
+
+    _Vita_ReleaseFile(job);
+    free(job->mip_data);
+    free(job->palette);
+    free(job->path);
+    Vita_PoolFree(&_jobPool, job);
+}
+
+/**
+ * _Vita_ReadFile():
+ *  Loads all of job->path into job->file_data. Worker thread.
+ *  Files in the mounted asset pack are used where they are. Otherwise,
+ *  on PC the file is memory mapped instead of read. Either way
+ *  uploading from it never copies the pixels.
+ *
+ *  returns 0 on success.
+ */
+static int _Vita_ReadFile(TextureLoadJob *job)
+{
+    size_t packed_size = 0;
+    const void *packed = Vita_FindPackedFile(job->path, &packed_size);
+    if(packed != NULL)
+    {
+        job->file_data = (unsigned char *)packed;
+        job->file_size = packed_size;
+        job->file_source = FILE_PACKED;
+        return 0;
+    }
+
+#ifdef VGL_LOADER_MMAP
+    int fd = open(job->path, O_RDONLY);
+    if(fd < 0) return -1;
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data != MAP_FAILED)
+    {
+        // Fault the pages in here rather than on the GL thread during upload.
+        madvise(data, info.st_size, MADV_WILLNEED);
+
+        job->file_data = (unsigned char *)data;
+        job->file_size = info.st_size;
+        job->file_source = FILE_MAPPED;
+        return 0;
+    }
+#endif
+
+    FILE *file = fopen(job->path, "rb");
+    if(file == NULL) return -1;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data_read = length > 0 ? (unsigned char *)VGL_MALLOC(length) : NULL;
+    if(data_read != NULL && fread(data_read, length, 1, file) != 1)
+    {
+        free(data_read);
+        data_read = NULL;
+    }
+
+    fclose(file);
+    if(data_read == NULL) return -1;
+
+    job->file_data = data_read;
+    job->file_size = length;
+    return 0;
+}
+
+static void _Vita_Premultiply(unsigned char *pixels, int width, int height)
+{
+    size_t count = (size_t)width * height;
+    for(size_t i = 0; i < count; i++)
+    {
+        unsigned char *p = pixels + (i * 4);
+        p[0] = (unsigned char)((p[0] * p[3] + 127) / 255);
+        p[1] = (unsigned char)((p[1] * p[3] + 127) / 255);
+        p[2] = (unsigned char)((p[2] * p[3] + 127) / 255);
+    }
+}
+
+/**
+ * _Vita_RGBASize():
+ *  returns the bytes a `width` x `height` RGBA8 image takes,
+ *  or 0 if that doesn't fit in a size_t.
+ */
+static size_t _Vita_RGBASize(int width, int height)
+{
+    if(width <= 0 || height <= 0 || (size_t)width > SIZE_MAX / 4 / (size_t)height)
+        return 0;
+
+    return (size_t)width * height * 4;
+}
+
+/**
+ * _Vita_KTXLevels():
+ *  returns how many of `image`'s levels, from the base level down,
+ *  are big enough for their size in `format` (0 for RGBA8).
+ */
+static int _Vita_KTXLevels(const KTXImage *image, uint32_t format)
+{
+    for(int level = 0; level < image->levels; level++)
+    {
+        int width = image->width >> level, height = image->height >> level;
+        if(width < 1) width = 1;
+        if(height < 1) height = 1;
+
+        size_t needed = format != 0 ? Vita_CompressedSize(format, width, height) : _Vita_RGBASize(width, height);
+        if(needed == 0 || image->level_size[level] < needed) return level;
+    }
+
+    return image->levels;
+}
+
+/**
+ * _Vita_LoadKTX():
+ *  Sets `job` up from the KTX file in job->file_data. Worker thread.
+ *
+ *  Formats in _compressedFormats keep their levels for glCompressedTexImage2D,
+ *  other compressed formats are decoded to RGBA8 here. RGBA8 files are
+ *  used in place, with no decoding or copying, unless they still need
+ *  premultiplying.
+ */
+static void _Vita_LoadKTX(TextureLoadJob *job)
+{
+    KTXImage image;
+    if(Vita_ParseKTX(job->file_data, job->file_size, &image) != 0)
+    {
+        job->error = "malformed KTX file";
+        return;
+    }
+
+    job->width = image.width;
+    job->height = image.height;
+    job->premultiplied = image.premultiplied;
+    size_t rgba_size = _Vita_RGBASize(image.width, image.height);
+
+    int rgba = image.internal_format == VGL_KTX_RGBA8;
+    if(!rgba && !Vita_IsCompressedFormat(image.internal_format))
+    {
+        job->error = "unsupported KTX format";
+        return;
+    }
+
+    int levels = _Vita_KTXLevels(&image, rgba ? 0 : image.internal_format);
+    if(levels == 0)
+    {
+        job->error = "KTX level 0 is truncated";
+        return;
+    }
+
+    int convert = job->premultiply && !image.premultiplied;
+
+    if(!rgba && Vita_CompressedFormatSupported(image.internal_format))
+    {
+        // Uploaded as is. Compressed blocks can't be premultiplied without
+        // re-encoding, so a mismatch is only warned about on the GL thread.
+        job->format = image.internal_format;
+        job->levels = levels;
+        memcpy(job->level_data, image.level_data, sizeof(job->level_data));
+        memcpy(job->level_size, image.level_size, sizeof(job->level_size));
+
+        // Mixing in the format keeps a compressed and an RGBA texture from ever sharing.
+        job->content_hash = _Vita_HashPixels(image.level_data[0], image.level_size[0], job->width, job->height) ^ job->format;
+        return;
+    }
+
+    if(rgba && !convert)
+    {
+        // Uploaded straight out of the file, mip chain included.
+        job->pixels = (unsigned char *)image.level_data[0];
+        job->pixels_owner = PIXELS_FILE;
+        job->levels = levels;
+        memcpy(job->level_data, image.level_data, sizeof(job->level_data));
+        memcpy(job->level_size, image.level_size, sizeof(job->level_size));
+
+        job->content_hash = _Vita_HashPixels(job->pixels, rgba_size, job->width, job->height);
+        return;
+    }
+
+    // Base level only from here on: decoded or premultiplied into a copy,
+    // after which the file isn't needed anymore.
+    job->pixels = (unsigned char *)VGL_MALLOC(rgba_size);
+    if(job->pixels == NULL)
+    {
+        job->error = "out of memory";
+        return;
+    }
+
+    job->pixels_owner = PIXELS_HEAP;
+    if(rgba)
+        memcpy(job->pixels, image.level_data[0], rgba_size);
+    else
+        Vita_DecodeCompressed(image.internal_format, image.level_data[0], job->width, job->height, job->pixels);
+
+    if(convert)
+    {
+        _Vita_Premultiply(job->pixels, job->width, job->height);
+        job->premultiplied = 1;
+    }
+
+    job->content_hash = _Vita_HashPixels(job->pixels, rgba_size, job->width, job->height);
+    _Vita_ReleaseFile(job);
+}
+
+/**
+ * _Vita_BuildMips():
+ *  Generates job->mipmap's chain below job->pixels. Worker thread.
+ *  The levels go through the same upload path as a KTX file's.
+ */
+static void _Vita_BuildMips(TextureLoadJob *job)
+{
+    int levels = Vita_MipLevelCount(job->width, job->height);
+    if(levels > VGL_KTX_MAX_LEVELS) levels = VGL_KTX_MAX_LEVELS;
+    if(levels <= 1) return;
+
+    job->mip_data = (unsigned char *)VGL_MALLOC(Vita_MipChainSize(job->width, job->height, levels));
+    if(job->mip_data == NULL) return; // Still loads, just without mips.
+
+    Vita_GenerateMipChain(job->mipmap, job->pixels, job->width, job->height, job->mip_data, levels);
+
+    job->levels = levels;
+    job->level_data[0] = job->pixels;
+    job->level_size[0] = (uint32_t)((size_t)job->width * job->height * 4);
+
+    const unsigned char *level_data = job->mip_data;
+    for(int level = 1; level < levels; level++)
+    {
+        int width, height;
+        Vita_MipLevelDimensions(job->width, job->height, level, &width, &height);
+
+        job->level_data[level] = level_data;
+        job->level_size[level] = (uint32_t)((size_t)width * height * 4);
+        level_data += job->level_size[level];
+    }
+}
+
+/**
+ * _Vita_ReplacePixels():
+ *  Swaps the job's RGBA8 pixels (and mips, and the file they may
+ *  point into) for `converted`, a heap buffer.
+ */
+static void _Vita_ReplacePixels(TextureLoadJob *job, unsigned char *converted)
+{
+    if(job->pixels_owner == PIXELS_STB) stbi_image_free(job->pixels);
+    else if(job->pixels_owner == PIXELS_HEAP) free(job->pixels);
+    free(job->mip_data);
+    job->mip_data = NULL;
+    _Vita_ReleaseFile(job);
+
+    job->pixels = converted;
+    job->pixels_owner = PIXELS_HEAP;
+}
+
+/**
+ * _Vita_PalettizeJob():
+ *  Turns the base level into indices & a palette. Mips are dropped,
+ *  averaging indices would mix unrelated colors.
+ */
+static void _Vita_PalettizeJob(TextureLoadJob *job)
+{
+    // The shader can only tell nibbles apart when texels hold whole pairs.
+    if(job->pixel_format == VGL_PIXEL_INDEX4 && (job->width & 1))
+        job->pixel_format = VGL_PIXEL_INDEX8;
+
+    size_t size = Vita_PixelRowBytes(job->pixel_format, job->width) * job->height;
+    unsigned char *indices = (unsigned char *)VGL_MALLOC(size);
+    job->palette = (unsigned char *)VGL_MALLOC(VGL_PALETTE_SIZE * 4);
+
+    int exact = 1;
+    int colors = -1;
+    if(indices != NULL && job->palette != NULL)
+        colors = Vita_PalettizePixels(job->pixel_format, job->pixels, job->width, job->height, job->palette, indices, &exact);
+
+    if(colors < 0)
+    {
+        free(indices);
+        free(job->palette);
+        job->palette = NULL;
+        job->pixel_format = VGL_PIXEL_RGBA8888; // Still loads, just bigger.
+        return;
+    }
+
+    _Vita_ReplacePixels(job, indices);
+    job->levels = 1;
+    job->palette_colors = colors;
+    job->palette_exact = (char)exact;
+
+    // Only the indices: recolored copies of an image share one texture.
+    job->content_hash = _Vita_HashPixels(indices, size, job->width, job->height)
+        ^ ((uint64_t)job->pixel_format * 0x9E3779B97F4A7C15ULL);
+}
+
+/**
+ * _Vita_ConvertPixelFormat():
+ *  Resolves job->pixel_format and converts the base level & any mips
+ *  of an RGBA8 job to it. Worker thread, after _Vita_BuildMips.
+ */
+static void _Vita_ConvertPixelFormat(TextureLoadJob *job)
+{
+    if(job->pixels == NULL || job->format != 0)
+    {
+        job->pixel_format = VGL_PIXEL_RGBA8888;
+        return;
+    }
+
+    if(job->pixel_format == VGL_PIXEL_AUTO)
+        job->pixel_format = (char)Vita_ChoosePixelFormat(job->pixels, job->width, job->height);
+    if(job->pixel_format == VGL_PIXEL_RGBA8888) return;
+
+    if(Vita_IsIndexedPixelFormat(job->pixel_format))
+    {
+        _Vita_PalettizeJob(job);
+        return;
+    }
+
+    int levels = job->levels > 1 ? job->levels : 1;
+    size_t texels = 0;
+    for(int level = 0; level < levels; level++)
+    {
+        int width, height;
+        Vita_MipLevelDimensions(job->width, job->height, level, &width, &height);
+        texels += (size_t)width * height;
+    }
+
+    uint16_t *converted = (uint16_t *)VGL_MALLOC(texels * sizeof(uint16_t));
+    if(converted == NULL)
+    {
+        job->pixel_format = VGL_PIXEL_RGBA8888; // Still loads, just bigger.
+        return;
+    }
+
+    uint16_t *out = converted;
+    for(int level = 0; level < levels; level++)
+    {
+        int width, height;
+        Vita_MipLevelDimensions(job->width, job->height, level, &width, &height);
+
+        Vita_ConvertPixels(job->pixel_format, levels > 1 ? job->level_data[level] : job->pixels, width, height, out, job->dither);
+        if(levels > 1)
+        {
+            job->level_data[level] = (const unsigned char *)out;
+            job->level_size[level] = (uint32_t)((size_t)width * height * sizeof(uint16_t));
+        }
+        out += (size_t)width * height;
+    }
+
+    _Vita_ReplacePixels(job, (unsigned char *)converted);
+
+    // The same image in another format must not share its texture.
+    job->content_hash ^= (uint64_t)job->pixel_format * 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * _Vita_PixelFormatGL():
+ *  The glTexImage2D internal format, format & type of `pixel_format`.
+ *  vitaGL picks its storage from format & type, desktop GL needs the
+ *  sized internal format to actually store 16 (or 8) bits.
+ *  Indices are single channel bytes, read back from the red channel.
+ */
+static void _Vita_PixelFormatGL(int pixel_format, GLint *internal_format, GLenum *format, GLenum *type)
+{
+    *format = pixel_format == VGL_PIXEL_RGB565 ? GL_RGB : GL_RGBA;
+    if(Vita_IsIndexedPixelFormat(pixel_format)) *format = GL_LUMINANCE;
+    *internal_format = *format;
+
+    switch(pixel_format)
+    {
+        case VGL_PIXEL_RGBA4444: *type = GL_UNSIGNED_SHORT_4_4_4_4; break;
+        case VGL_PIXEL_RGBA5551: *type = GL_UNSIGNED_SHORT_5_5_5_1; break;
+        case VGL_PIXEL_RGB565: *type = GL_UNSIGNED_SHORT_5_6_5; break;
+        default: *type = GL_UNSIGNED_BYTE; break;
+    }
+
+#ifndef VITA
+    switch(pixel_format)
+    {
+        case VGL_PIXEL_RGBA4444: *internal_format = GL_RGBA4; break;
+        case VGL_PIXEL_RGBA5551: *internal_format = GL_RGB5_A1; break;
+        case VGL_PIXEL_RGB565: *internal_format = GL_RGB565; break;
+        case VGL_PIXEL_INDEX8:
+        case VGL_PIXEL_INDEX4: *internal_format = GL_LUMINANCE8; break;
+    }
+#endif
+}
+
+/**
+ * _Vita_TexelWidth():
+ *  The GL texture's width for `width` texels: 4 bit indices come in pairs.
+ */
+static inline int _Vita_TexelWidth(int pixel_format, int width)
+{
+    return pixel_format == VGL_PIXEL_INDEX4 ? (width + 1) / 2 : width;
+}
+
+static void *_Vita_LoaderWorker(void *arg)
+{
+    char thread_name[32];
+    snprintf(thread_name, sizeof(thread_name), "loader %d", (int)(intptr_t)arg);
+    Vita_ProfilerNameThread(thread_name);
+
+    for(;;)
+    {
+        pthread_mutex_lock(&_queueLock);
+        while(_running && _pendingHead == NULL)
+            pthread_cond_wait(&_queueSignal, &_queueLock);
+
+        if(!_running)
+        {
+            pthread_mutex_unlock(&_queueLock);
+            return NULL;
+        }
+
+        TextureLoadJob *job = _Vita_JobPop(&_pendingHead, &_pendingTail);
+        pthread_mutex_unlock(&_queueLock);
+
+        VGL_PROFILE_BEGIN("decode");
+        if(_Vita_ReadFile(job) != 0)
+            job->error = "could not read file";
+        else if(Vita_IsKTX(job->file_data, job->file_size))
+            _Vita_LoadKTX(job);
+        else
+        {
+            int channels = 0;
+            job->pixels = stbi_load_from_memory(job->file_data, (int)job->file_size, &job->width, &job->height, &channels, STBI_rgb_alpha);
+            job->pixels_owner = PIXELS_STB;
+            _Vita_ReleaseFile(job);
+
+            if(job->pixels != NULL)
+            {
+                if(job->premultiply)
+                {
+                    _Vita_Premultiply(job->pixels, job->width, job->height);
+                    job->premultiplied = 1;
+                }
+
+                job->content_hash = _Vita_HashPixels(job->pixels, (size_t)job->width * job->height * 4, job->width, job->height);
+            }
+            // Not stbi_failure_reason(): it's one global for every worker, so
+            // two failing at once could report each other's reasons.
+            else job->error = "could not decode image";
+        }
+
+        if(job->pixels != NULL && job->format == 0 && job->levels <= 1 && job->mipmap != VGL_MIPMAP_NONE
+            && !Vita_IsIndexedPixelFormat(job->pixel_format))
+            _Vita_BuildMips(job);
+
+        _Vita_ConvertPixelFormat(job);
+        VGL_PROFILE_END();
+
+        pthread_mutex_lock(&_queueLock);
+        _Vita_JobPush(&_decodedHead, &_decodedTail, job);
+        pthread_mutex_unlock(&_queueLock);
+    }
+}
+
+/**
+ * _Vita_ApplyTextureFilter():
+ *  Sets the GL sampling state for texture->filter. Ready textures only,
+ *  the placeholder is shared by every loading handle.
+ */
+static void _Vita_ApplyTextureFilter(VitaTexture *texture)
+{
+    GLint min_filter = GL_NEAREST, mag_filter = GL_NEAREST;
+
+    // Filtering indices would blend unrelated palette entries.
+    if(Vita_IsIndexedPixelFormat(texture->pixel_format)) {}
+    else if(texture->filter == VGL_TEXTURE_FILTER_BILINEAR)
+        min_filter = mag_filter = GL_LINEAR;
+    else if(texture->filter == VGL_TEXTURE_FILTER_TRILINEAR)
+    {
+        min_filter = texture->levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+        mag_filter = GL_LINEAR;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture->textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static inline void _Vita_SetDefaultTextureParams()
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+}
+
+/**
+ * _Vita_TakePalette():
+ *  Moves an indexed job's palette to its record & uploads it.
+ */
+static void _Vita_TakePalette(TextureRecord *record, TextureLoadJob *job)
+{
+    record->palette = job->palette;
+    record->palette_colors = job->palette_colors;
+    job->palette = NULL;
+
+    record->texture.paletteID = Vita_CreatePalette(record->palette, record->palette_colors);
+    if(record->texture.paletteID != 0) _residentBytes += PALETTE_BYTES;
+}
+
+static inline void _Vita_LRUUnlink(TextureRecord *record)
+{
+    if(record->lru_prev != NULL) record->lru_prev->lru_next = record->lru_next;
+    else _lruHead = record->lru_next;
+
+    if(record->lru_next != NULL) record->lru_next->lru_prev = record->lru_prev;
+    else _lruTail = record->lru_prev;
+
+    record->lru_prev = record->lru_next = NULL;
+}
+
+static inline void _Vita_LRUPushFront(TextureRecord *record)
+{
+    record->lru_prev = NULL;
+    record->lru_next = _lruHead;
+
+    if(_lruHead != NULL) _lruHead->lru_prev = record;
+    else _lruTail = record;
+    _lruHead = record;
+}
+
+/**
+ * _Vita_JobGPUBytes():
+ *  returns the GPU storage of the levels `job` uploads.
+ */
+static size_t _Vita_JobGPUBytes(const TextureLoadJob *job)
+{
+    int levels = job->levels > 1 ? job->levels : 1;
+    size_t bytes = 0;
+
+    for(int level = 0; level < levels; level++)
+    {
+        if(job->format != 0)
+        {
+            bytes += job->level_size[level];
+            continue;
+        }
+
+        int width, height;
+        Vita_MipLevelDimensions(job->width, job->height, level, &width, &height);
+        bytes += Vita_PixelRowBytes(job->pixel_format, width) * height;
+    }
+
+    return bytes;
+}
+
+/**
+ * _Vita_ReleaseStorage():
+ *  Shrinks `texture` to a single transparent texel, keeping its GL name.
+ */
+static void _Vita_ReleaseStorage(VitaTexture *texture)
+{
+    const unsigned char clear_pixel[4] = {0, 0, 0, 0};
+
+    glBindTexture(GL_TEXTURE_2D, texture->textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear_pixel);
+#ifndef VITA
+    // Desktop GL keeps every mip level's storage on its own.
+    for(int level = 1; level < texture->levels; level++)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+#endif
+#ifdef GL_TEXTURE_MAX_LEVEL
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+#endif
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void _Vita_Evict(TextureRecord *record)
+{
+    _Vita_LRUUnlink(record);
+    _Vita_ReleaseStorage(&record->texture);
+
+    _residentBytes -= record->gpu_bytes;
+    _residentCount--;
+    _evictedCount++;
+    _evictionCount++;
+    record->residency = RESIDENCY_EVICTED;
+}
+
+/**
+ * _Vita_EnforceBudget():
+ *  Evicts the least recently used textures until the budget is met,
+ *  sparing those touched this frame or the last.
+ */
+static void _Vita_EnforceBudget()
+{
+    if(_textureBudget == VGL_TEXTURE_BUDGET_UNLIMITED) return;
+
+    while(_residentBytes > _textureBudget && _lruTail != NULL)
+    {
+        // Everything ahead of the tail was touched more recently.
+        if(_lruTail->last_used + 1 >= _residencyFrame) break;
+        _Vita_Evict(_lruTail);
+    }
+
+    if(_residentBytes <= _textureBudget) _overBudgetWarned = 0;
+    else if(!_overBudgetWarned)
+    {
+        _debugPrintf("[texture_residency] The last frames drew %zu bytes of textures, over the %zu byte budget.\n",
+            _residentBytes, _textureBudget);
+        _overBudgetWarned = 1;
+    }
+}
+
+/**
+ * _Vita_MakeResident():
+ *  Adds a texture owner whose `bytes` of storage were just uploaded
+ *  to the LRU list as the most recently used.
+ */
+static void _Vita_MakeResident(TextureRecord *record, size_t bytes)
+{
+    record->gpu_bytes = bytes;
+    record->residency = RESIDENCY_RESIDENT;
+    record->last_used = _residencyFrame;
+    _Vita_LRUPushFront(record);
+
+    _residentBytes += bytes;
+    _residentCount++;
+    _Vita_EnforceBudget();
+}
+
+/**
+ * _Vita_DropResidency():
+ *  Stops tracking a texture owner that's being freed.
+ */
+static void _Vita_DropResidency(TextureRecord *record)
+{
+    if(record->residency == RESIDENCY_NONE) return;
+
+    if(record->residency == RESIDENCY_RESIDENT)
+    {
+        _Vita_LRUUnlink(record);
+        _residentBytes -= record->gpu_bytes;
+        _residentCount--;
+    }
+    else _evictedCount--;
+
+    _Vita_CacheUnlink(_textureOwners, record->texture.textureID, record);
+    record->residency = RESIDENCY_NONE;
+}
+
+/**
+ * _Vita_FinishReload():
+ *  Makes a reloaded texture resident again, or gives up on it if the
+ *  reload failed or no longer matches what was first loaded.
+ */
+static void _Vita_FinishReload(TextureLoadJob *job, int state)
+{
+    TextureRecord *record = job->record;
+    VitaTexture *tex = &record->texture;
+
+    if(tex->released)
+    {
+        // Freed while reloading. Everything but the GL texture already went.
+        glDeleteTextures(1, &tex->textureID);
+        free(record->path);
+        Vita_PoolFree(&_recordPool, record);
+        return;
+    }
+
+    // The hash covers dimensions & pixel format too.
+    if(state == VGL_TEXTURE_READY && job->content_hash == record->content_hash)
+    {
+        tex->levels = job->levels > 1 ? job->levels : 1;
+        if(tex->filter != VGL_TEXTURE_FILTER_NEAREST)
+            _Vita_ApplyTextureFilter(tex);
+
+        _evictedCount--;
+        _reloadCount++;
+        _Vita_MakeResident(record, _Vita_JobGPUBytes(job));
+        return;
+    }
+
+    const char *error = job->error;
+    if(error == NULL) error = state == VGL_TEXTURE_READY ? "it changed since it was first loaded" : "cancelled";
+    _debugPrintf("[texture_residency] Failed to reload %s: %s\n", job->path, error);
+
+    // Anything uploaded so far goes, it keeps drawing transparent.
+    if(job->textureID != 0) _Vita_ReleaseStorage(tex);
+    record->residency = RESIDENCY_LOST;
+}
+
+/**
+ * _Vita_FinishJob():
+ *  Hands the uploaded (or failed) texture over to its handle
+ *  and frees the job.
+ */
+static void _Vita_FinishJob(TextureLoadJob *job, int state)
+{
+    TextureRecord *record = job->record;
+    VitaTexture *tex = &record->texture;
+
+    if(job->reload) _Vita_FinishReload(job, state);
+    else if(tex->released)
+    {
+        if(job->textureID != 0) glDeleteTextures(1, &job->textureID);
+        free(record->path);
+        Vita_PoolFree(&_recordPool, record);
+    }
+    else if(state == VGL_TEXTURE_READY)
+    {
+        tex->textureID = job->textureID;
+        tex->width = job->width;
+        tex->height = job->height;
+        tex->inv_width = 1.f / job->width;
+        tex->inv_height = 1.f / job->height;
+        tex->levels = job->levels > 1 ? job->levels : 1;
+        tex->pixel_format = job->pixel_format;
+        tex->state = VGL_TEXTURE_READY;
+
+        if(job->palette != NULL)
+        {
+            _Vita_TakePalette(record, job);
+            if(!job->palette_exact)
+                _debugPrintf("[texture_loader] %s has too many colors for its palette, reduced to %d.\n", job->path, record->palette_colors);
+        }
+
+        if(tex->filter != VGL_TEXTURE_FILTER_NEAREST)
+            _Vita_ApplyTextureFilter(tex);
+
+        if(job->premultiplied != job->premultiply)
+        {
+            _debugPrintf("[texture_loader] %s is %spremultiplied, but VGL_SHADER_PREMULTIPLIED is %s.\n", job->path,
+                job->premultiplied ? "" : "not ", job->premultiply ? "on" : "off");
+        }
+
+        // Cache entries become the canonical copy of their pixels.
+        record->content_hash = job->content_hash;
+        if(record->refs > 0 && get_by_id_basic_map(_cacheByContent, job->content_hash) == NULL)
+            insert_basic_map(_cacheByContent, job->content_hash, record);
+
+        // It owns its GL texture from here on, see Vita_SetTextureBudget.
+        insert_basic_map(_textureOwners, tex->textureID, record);
+        _Vita_MakeResident(record, _Vita_JobGPUBytes(job));
+    }
+    else
+    {
+        _debugPrintf("[texture_loader] Failed to load %s: %s\n", job->path, job->error != NULL ? job->error : "cancelled");
+        if(job->textureID != 0) glDeleteTextures(1, &job->textureID);
+        tex->state = VGL_TEXTURE_FAILED;
+    }
+
+    _inFlight--;
+    _Vita_FreeJob(job);
+}
+
+/**
+ * _Vita_AliasJob():
+ *  Finishes a cache entry's job by pointing it at `canonical`,
+ *  an entry already holding the same pixels. Nothing is uploaded.
+ */
+static void _Vita_AliasJob(TextureLoadJob *job, TextureRecord *canonical)
+{
+    TextureRecord *record = job->record;
+
+    record->alias_of = canonical;
+    record->content_hash = job->content_hash;
+    canonical->refs++;
+
+    record->texture.textureID = canonical->texture.textureID;
+    record->texture.width = canonical->texture.width;
+    record->texture.height = canonical->texture.height;
+    record->texture.inv_width = canonical->texture.inv_width;
+    record->texture.inv_height = canonical->texture.inv_height;
+    record->texture.levels = canonical->texture.levels;
+    record->texture.pixel_format = canonical->texture.pixel_format;
+    if(job->palette != NULL) _Vita_TakePalette(record, job);
+    record->texture.state = VGL_TEXTURE_READY;
+
+    _debugPrintf("[texture_cache] %s has the same pixels as %s. Sharing texture %u.\n", 
+        record->path, canonical->path, canonical->texture.textureID);
+
+    _inFlight--;
+    _Vita_FreeJob(job);
+}
+
+static void _Vita_SubmitJob(TextureLoadJob *job)
+{
+    pthread_mutex_lock(&_queueLock);
+    _Vita_JobPush(&_pendingHead, &_pendingTail, job);
+    pthread_cond_signal(&_queueSignal);
+    pthread_mutex_unlock(&_queueLock);
+
+    _inFlight++;
+}
+
+/**
+ * _Vita_QueueLoad():
+ *  Creates a loading record for `path` and queues it for the workers.
+ */
+static TextureRecord *_Vita_QueueLoad(const char *path)
+{
+    TextureRecord *record = (TextureRecord *)Vita_PoolCalloc(&_recordPool);
+    TextureLoadJob *job = (TextureLoadJob *)Vita_PoolCalloc(&_jobPool);
+    VitaTexture *tex = &record->texture;
+
+    tex->textureID = _placeholderTexture;
+    tex->width = 1;
+    tex->height = 1;
+    tex->inv_width = 1.f;
+    tex->inv_height = 1.f;
+    tex->levels = 1;
+    tex->state = VGL_TEXTURE_LOADING;
+
+    job->record = record;
+    job->mipmap = _mipmapFilter;
+    job->pixel_format = (char)_pixelFormat;
+    job->dither = (char)_pixelDither;
+    job->premultiply = (Vita_GetShaderFeatures() & VGL_SHADER_PREMULTIPLIED) != 0;
+    job->path = VGL_STRDUP(path);
+
+    record->path = VGL_STRDUP(path);
+    record->load_mipmap = job->mipmap;
+    record->load_pixel_format = job->pixel_format;
+    record->load_dither = job->dither;
+    record->load_premultiply = job->premultiply;
+
+    _Vita_SubmitJob(job);
+    return record;
+}
+
+/**
+ * _Vita_QueueReload():
+ *  Queues an evicted texture to be loaded again the way it first was,
+ *  into its own GL texture.
+ */
+static void _Vita_QueueReload(TextureRecord *record)
+{
+    TextureLoadJob *job = (TextureLoadJob *)Vita_PoolCalloc(&_jobPool);
+
+    job->record = record;
+    job->reload = 1;
+    job->mipmap = record->load_mipmap;
+    job->pixel_format = record->load_pixel_format;
+    job->dither = record->load_dither;
+    job->premultiply = record->load_premultiply;
+    job->path = VGL_STRDUP(record->path);
+
+    record->residency = RESIDENCY_RELOADING;
+    _Vita_SubmitJob(job);
+}
+
+static inline void _Vita_SpendBudget(size_t *budget, size_t bytes)
+{
+    *budget = bytes >= *budget ? 0 : *budget - bytes;
+}
+
+/**
+ * _Vita_UploadRows():
+ *  Uploads as many whole rows of job->pixels as the budget allows, but
+ *  always at least one so a single huge image can't stall forever.
+ *  The job's texture must be bound.
+ *
+ *  returns 1 once every row is uploaded and there are no mip levels left.
+ */
+static int _Vita_UploadRows(TextureLoadJob *job, size_t *budget)
+{
+    GLint internal_format;
+    GLenum format, type;
+    _Vita_PixelFormatGL(job->pixel_format, &internal_format, &format, &type);
+
+    size_t row_bytes = Vita_PixelRowBytes(job->pixel_format, job->width);
+    int rows = (int)(*budget / row_bytes);
+    if(rows < 1) rows = 1;
+    if(rows > job->height - job->rows_uploaded) rows = job->height - job->rows_uploaded;
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0,
+        0, job->rows_uploaded,
+        _Vita_TexelWidth(job->pixel_format, job->width), rows,
+        format, type,
+        job->pixels + (row_bytes * job->rows_uploaded));
+
+    job->rows_uploaded += rows;
+    _Vita_SpendBudget(budget, rows * row_bytes);
+    _pumpUploadedBytes += rows * row_bytes;
+
+    if(job->rows_uploaded < job->height) return 0;
+
+    // Base level done. Any mip levels go through _Vita_UploadLevel.
+    job->levels_uploaded = 1;
+    return job->levels_uploaded >= job->levels;
+}
+
+/**
+ * _Vita_UploadLevel():
+ *  Uploads the next mip level of a compressed job, or of an uncompressed
+ *  job past its base level. Levels aren't split into bands, so one may
+ *  overrun what's left of the budget; like _Vita_UploadRows it always
+ *  makes progress.
+ *  The job's texture must be bound.
+ *
+ *  returns 1 once every level is uploaded.
+ */
+static int _Vita_UploadLevel(TextureLoadJob *job, size_t *budget)
+{
+    int level = job->levels_uploaded;
+    int width = job->width >> level, height = job->height >> level;
+
+    if(width < 1) width = 1;
+    if(height < 1) height = 1;
+
+    if(job->format != 0)
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, job->format, width, height, 0,
+            job->level_size[level], job->level_data[level]);
+    else
+    {
+        GLint internal_format;
+        GLenum format, type;
+        _Vita_PixelFormatGL(job->pixel_format, &internal_format, &format, &type);
+        glTexImage2D(GL_TEXTURE_2D, level, internal_format, _Vita_TexelWidth(job->pixel_format, width), height, 0,
+            format, type, job->level_data[level]);
+    }
+
+    job->levels_uploaded++;
+    _Vita_SpendBudget(budget, job->level_size[level]);
+    _pumpUploadedBytes += job->level_size[level];
+
+    if(job->levels_uploaded < job->levels) return 0;
+
+#ifdef GL_TEXTURE_MAX_LEVEL
+    if(job->levels > 1)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job->levels - 1);
+#endif
+    return 1;
+}
+
+// ------------------------------------------   END INTERNAL FUNCTIONS
+
+int Vita_InitTextureLoader(int worker_count, void (*dbgPrintFn)(const char*, ...))
+{
+    if(dbgPrintFn == NULL || _running) return -1;
+    _debugPrintf = dbgPrintFn;
+
+    if(_recordPool.block_size == 0) Vita_PoolInit(&_recordPool, sizeof(TextureRecord), 0, VGL_POOL_DEFAULT_SLAB_BLOCKS);
+    if(_jobPool.block_size == 0) Vita_PoolInit(&_jobPool, sizeof(TextureLoadJob), 0, 16);
+
+    if(_cacheByPath == NULL) _cacheByPath = create_basic_map(TEXTURE_CACHE_INITIAL_SIZE);
+    if(_cacheByContent == NULL) _cacheByContent = create_basic_map(TEXTURE_CACHE_INITIAL_SIZE);
+    if(_textureOwners == NULL) _textureOwners = create_basic_map(TEXTURE_CACHE_INITIAL_SIZE);
+
+    if(worker_count < 1) worker_count = 1;
+    if(worker_count > MAX_LOADER_WORKERS) worker_count = MAX_LOADER_WORKERS;
+
+    // glGetIntegerv writes every format, so the list has to be sized by the real count first.
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &format_count);
+
+    _compressedFormatCount = 0;
+    GLint *formats = format_count > 0 ? (GLint *)VGL_MALLOC(sizeof(GLint) * format_count) : NULL;
+    if(formats != NULL)
+    {
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats);
+        for(int i = 0; i < format_count && _compressedFormatCount < MAX_COMPRESSED_FORMATS; i++)
+        {
+            if(Vita_IsCompressedFormat(formats[i]))
+                _compressedFormats[_compressedFormatCount++] = formats[i];
+        }
+        free(formats);
+    }
+
+    _debugPrintf("[texture_loader] GPU samples %d of our compressed formats.\n", _compressedFormatCount);
+
+    // Rows of 16 bit or indexed texels needn't be a multiple of 4 bytes.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    const unsigned char clear_pixel[4] = {0, 0, 0, 0};
+    glGenTextures(1, &_placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, _placeholderTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear_pixel);
+    _Vita_SetDefaultTextureParams();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _running = 1;
+    for(_workerCount = 0; _workerCount < worker_count; _workerCount++)
+    {
+        if(pthread_create(&_workers[_workerCount], NULL, _Vita_LoaderWorker, (void *)(intptr_t)_workerCount) != 0)
+        {
+            _debugPrintf("[texture_loader] Could only start %d of %d workers.\n", _workerCount, worker_count);
+            break;
+        }
+    }
+
+    if(_workerCount == 0)
+    {
+        _running = 0;
+        return -1;
+    }
+
+    _debugPrintf("[texture_loader] Started %d workers.\n", _workerCount);
+    return 0;
+}
+
+void Vita_ShutdownTextureLoader()
+{
+    if(!_running) return;
+
+    pthread_mutex_lock(&_queueLock);
+    _running = 0;
+    pthread_cond_broadcast(&_queueSignal);
+    pthread_mutex_unlock(&_queueLock);
+
+    for(int i = 0; i < _workerCount; i++)
+        pthread_join(_workers[i], NULL);
+    _workerCount = 0;
+
+    // Nobody else is touching the queues anymore.
+    TextureLoadJob *job;
+    while((job = _Vita_JobPop(&_pendingHead, &_pendingTail)) != NULL)
+        _Vita_FinishJob(job, VGL_TEXTURE_FAILED);
+    while((job = _Vita_JobPop(&_decodedHead, &_decodedTail)) != NULL)
+        _Vita_FinishJob(job, VGL_TEXTURE_FAILED);
+}
+
+VitaTexture *Vita_LoadTextureAsync(const char *path)
+{
+    if(!_running || path == NULL) return NULL;
+
+    return &_Vita_QueueLoad(path)->texture;
+}
+
+void Vita_FreeTexture(VitaTexture *texture)
+{
+    if(texture == NULL) return;
+
+    TextureRecord *record = _Vita_Record(texture);
+
+    if(texture->state == VGL_TEXTURE_LOADING)
+    {
+        // The job still points at it. _Vita_FinishJob frees it.
+        texture->released = 1;
+        return;
+    }
+
+    if(texture->paletteID != 0) _residentBytes -= PALETTE_BYTES;
+    Vita_DeletePalette(texture->paletteID);
+    free(record->palette);
+    record->palette = NULL;
+
+    if(record->residency == RESIDENCY_RELOADING)
+    {
+        // The reload job still points at it. _Vita_FinishReload frees it.
+        _Vita_DropResidency(record);
+        texture->released = 1;
+        return;
+    }
+
+    _Vita_DropResidency(record);
+
+    if(record->alias_of != NULL)
+        Vita_ReleaseTexture(&record->alias_of->texture);
+    else if(texture->state == VGL_TEXTURE_READY)
+        glDeleteTextures(1, &texture->textureID);
+
+    free(record->path);
+    Vita_PoolFree(&_recordPool, record);
+}
+
+VitaTexture *Vita_AcquireTexture(const char *path)
+{
+    if(path == NULL) return NULL;
+
+    uint64_t path_hash = _Vita_HashPath(path);
+    bm_key_t *entry = get_by_id_basic_map(_cacheByPath, path_hash);
+    TextureRecord *it = entry != NULL ? (TextureRecord *)entry->obj_ptr : NULL;
+
+    if(it != NULL && strcmp(it->path, path) == 0)
+    {
+        it->refs++;
+        return &it->texture;
+    }
+
+    if(!_running) return NULL;
+
+    TextureRecord *record = _Vita_QueueLoad(path);
+    record->refs = 1;
+    record->path_hash = path_hash;
+
+    // On a (very unlikely) hash collision the new texture still works,
+    // it just isn't shared with later acquires of the same path.
+    if(it == NULL)
+        insert_basic_map(_cacheByPath, path_hash, record);
+    else
+        _debugPrintf("[texture_cache] %s collides with %s, not caching it.\n", path, it->path);
+
+    return &record->texture;
+}
+
+void Vita_ReleaseTexture(VitaTexture *texture)
+{
+    if(texture == NULL) return;
+
+    TextureRecord *record = _Vita_Record(texture);
+    if(record->refs <= 0 || --record->refs > 0) return;
+
+    // Last reference: the entry leaves the cache and is unloaded.
+    if(record->path != NULL)
+        _Vita_CacheUnlink(_cacheByPath, record->path_hash, record);
+
+    if(record->alias_of == NULL && texture->state == VGL_TEXTURE_READY)
+        _Vita_CacheUnlink(_cacheByContent, record->content_hash, record);
+
+    Vita_FreeTexture(texture);
+}
+
+void Vita_SetTextureUploadBudget(size_t bytes_per_frame)
+{
+    _uploadBudget = bytes_per_frame;
+}
+
+int Vita_PumpTextureUploads()
+{
+    // Last frame's draws have all touched their textures by now.
+    _residencyFrame++;
+    _Vita_EnforceBudget();
+    _pumpUploadedBytes = 0;
+
+    if(_inFlight == 0) return 0;
+
+    int completed = 0;
+    size_t budget = _uploadBudget;
+
+    while(budget > 0)
+    {
+        // Peek, the head job stays queued until it's fully uploaded.
+        pthread_mutex_lock(&_queueLock);
+        TextureLoadJob *job = _decodedHead;
+        pthread_mutex_unlock(&_queueLock);
+
+        if(job == NULL) break;
+
+        if((job->pixels == NULL && job->format == 0) || job->record->texture.released)
+        {
+            pthread_mutex_lock(&_queueLock);
+            _Vita_JobPop(&_decodedHead, &_decodedTail);
+            pthread_mutex_unlock(&_queueLock);
+
+            _Vita_FinishJob(job, VGL_TEXTURE_FAILED);
+            continue;
+        }
+
+        if(job->textureID == 0)
+        {
+            // Cache entries whose pixels are already on the GPU share that texture.
+            TextureRecord *canonical = NULL;
+            if(job->record->refs > 0 && !job->reload)
+                canonical = _Vita_CacheFindContent(job->content_hash, job->width, job->height);
+
+            if(canonical != NULL)
+            {
+                pthread_mutex_lock(&_queueLock);
+                _Vita_JobPop(&_decodedHead, &_decodedTail);
+                pthread_mutex_unlock(&_queueLock);
+
+                _Vita_AliasJob(job, canonical);
+                completed++;
+                continue;
+            }
+
+            if(job->reload) job->textureID = job->record->texture.textureID;
+            else glGenTextures(1, &job->textureID);
+
+            glBindTexture(GL_TEXTURE_2D, job->textureID);
+            if(job->format == 0)
+            {
+                GLint internal_format;
+                GLenum format, type;
+                _Vita_PixelFormatGL(job->pixel_format, &internal_format, &format, &type);
+                glTexImage2D(GL_TEXTURE_2D, 0, internal_format, _Vita_TexelWidth(job->pixel_format, job->width), job->height, 0, format, type, NULL);
+            }
+            _Vita_SetDefaultTextureParams();
+        }
+        else glBindTexture(GL_TEXTURE_2D, job->textureID);
+
+        int done = (job->format != 0 || job->levels_uploaded > 0) ? _Vita_UploadLevel(job, &budget) : _Vita_UploadRows(job, &budget);
+
+        if(done)
+        {
+            pthread_mutex_lock(&_queueLock);
+            _Vita_JobPop(&_decodedHead, &_decodedTail);
+            pthread_mutex_unlock(&_queueLock);
+
+            _Vita_FinishJob(job, VGL_TEXTURE_READY);
+            completed++;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return completed;
+}
+
+void Vita_SetTextureMipmaps(int filter)
+{
+    _mipmapFilter = filter;
+}
+
+unsigned int Vita_CreatePalette(const unsigned char *colors, int count)
+{
+    unsigned char entries[VGL_PALETTE_SIZE * 4];
+    if(colors == NULL || count < 0 || count > VGL_PALETTE_SIZE) return 0;
+
+    memset(entries, 0, sizeof(entries));
+    memcpy(entries, colors, (size_t)count * 4);
+
+    GLuint palette = 0;
+    glGenTextures(1, &palette);
+    glBindTexture(GL_TEXTURE_2D, palette);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, VGL_PALETTE_SIZE, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, entries);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return palette;
+}
+
+void Vita_DeletePalette(unsigned int palette)
+{
+    if(palette != 0) glDeleteTextures(1, &palette);
+}
+
+int Vita_GetTexturePalette(const VitaTexture *texture, unsigned char *colors)
+{
+    if(texture == NULL || texture->state != VGL_TEXTURE_READY) return 0;
+
+    const TextureRecord *record = (const TextureRecord *)texture;
+    if(record->palette == NULL) return 0;
+
+    memcpy(colors, record->palette, VGL_PALETTE_SIZE * 4);
+    return record->palette_colors;
+}
+
+void Vita_SetTexturePixelFormat(int format, int dither)
+{
+    _pixelFormat = format;
+    _pixelDither = dither;
+}
+
+void Vita_SetTextureFilter(VitaTexture *texture, int filter)
+{
+    if(texture == NULL) return;
+
+    texture->filter = filter;
+
+    // Loading textures pick it up in _Vita_FinishJob.
+    if(texture->state == VGL_TEXTURE_READY)
+        _Vita_ApplyTextureFilter(texture);
+}
+
+void Vita_SetTextureBudget(size_t bytes)
+{
+    _textureBudget = bytes;
+    _overBudgetWarned = 0;
+    _Vita_EnforceBudget();
+}
+
+void Vita_TouchTexture(unsigned int textureID)
+{
+    if(textureID == 0 || _textureOwners == NULL) return;
+
+    bm_key_t *entry = get_by_id_basic_map(_textureOwners, textureID);
+    if(entry == NULL) return;
+
+    TextureRecord *record = (TextureRecord *)entry->obj_ptr;
+    record->last_used = _residencyFrame;
+
+    if(record->residency == RESIDENCY_RESIDENT)
+    {
+        _Vita_LRUUnlink(record);
+        _Vita_LRUPushFront(record);
+    }
+    else if(record->residency == RESIDENCY_EVICTED && _running)
+        _Vita_QueueReload(record);
+}
+
+int Vita_TextureResident(const VitaTexture *texture)
+{
+    if(texture == NULL || texture->state != VGL_TEXTURE_READY) return 0;
+
+    const TextureRecord *record = (const TextureRecord *)texture;
+    if(record->alias_of != NULL) record = record->alias_of;
+
+    return record->residency == RESIDENCY_RESIDENT;
+}
+
+size_t Vita_TextureUploadBytes()
+{
+    return _pumpUploadedBytes;
+}
+
+void Vita_GetTextureResidency(VitaTextureResidency *residency)
+{
+    if(residency == NULL) return;
+
+    residency->budget = _textureBudget;
+    residency->resident_bytes = _residentBytes;
+    residency->resident = _residentCount;
+    residency->evicted = _evictedCount;
+    residency->evictions = _evictionCount;
+    residency->reloads = _reloadCount;
+}
+
+int Vita_CompressedFormatSupported(uint32_t format)
+{
+    for(int i = 0; i < _compressedFormatCount; i++)
+    {
+        if((uint32_t)_compressedFormats[i] == format) return 1;
+    }
+
+    return 0;
+}
+
+int Vita_TexturesPending()
+{
+    return _inFlight;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __VGL_TEXTURE_LOADER_H__
+#define __VGL_TEXTURE_LOADER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vgl_renderer_types.h"
+
+// Default number of bytes uploaded to the GPU per frame.
+#define VGL_DEFAULT_UPLOAD_BUDGET (256 * 1024)
+
+// No limit on resident texture memory, see Vita_SetTextureBudget.
+#define VGL_TEXTURE_BUDGET_UNLIMITED 0
+
+// Default resident texture budget. initGL gives vitaGL 20 MB of pools,
+// which also hold vertex data & the GPU's own allocations.
+#ifdef VITA
+#define VGL_DEFAULT_TEXTURE_BUDGET (12 * 1024 * 1024)
+#else
+#define VGL_DEFAULT_TEXTURE_BUDGET VGL_TEXTURE_BUDGET_UNLIMITED
+#endif
+
+// Where the loader's texture memory stands. See Vita_GetTextureResidency.
+typedef struct _vita_texture_residency
+{
+    size_t budget; // VGL_TEXTURE_BUDGET_UNLIMITED or bytes.
+    size_t resident_bytes; // GPU bytes of resident textures & palettes.
+    int resident; // Textures on the GPU.
+    int evicted; // Textures evicted, reloading or lost (failed to reload).
+    unsigned int evictions; // Totals since the loader started.
+    unsigned int reloads;
+} VitaTextureResidency;
+
+/**
+ * Vita_InitTextureLoader():
+ *  Starts `worker_count` threads that decode images in the background.
+ *  Must be called after initGL, from the GL thread.
+ *
+ *  returns 0 on success.
+ */
+int Vita_InitTextureLoader(int worker_count, void (*dbgPrintFn)(const char*, ...));
+
+/**
+ * Vita_ShutdownTextureLoader():
+ *  Stops the worker threads and drops anything still in flight.
+ *  Textures that already finished loading are left alone.
+ */
+void Vita_ShutdownTextureLoader();
+
+/**
+ * Vita_LoadTextureAsync():
+ *  Queues the image at `path` to be decoded on a worker thread.
+ *  Besides anything stb_image reads, `path` may be a KTX file from
+ *  tools/vgl_texconv (the vgl_textures build target converts every PNG).
+ *  RGBA8 KTX files skip decoding entirely and bring their mip chain;
+ *  compressed ones are covered by Vita_CompressedFormatSupported.
+ *
+ *  `path` is looked up in the mounted asset pack (Vita_MountPack) before
+ *  the file system.
+ *
+ *  With VGL_SHADER_PREMULTIPLIED on, images are premultiplied on the
+ *  worker unless the file already is (vgl_texconv --premultiply).
+ *
+ *  The returned handle is valid right away and draws as a transparent
+ *  placeholder until the image has been uploaded by Vita_PumpTextureUploads.
+ *  returns NULL if the loader isn't running.
+ */
+VitaTexture *Vita_LoadTextureAsync(const char *path);
+
+/**
+ * Vita_FreeTexture():
+ *  Deletes the texture & handle. Safe to call while it's still loading.
+ *  For handles from Vita_LoadTextureAsync; cached ones use Vita_ReleaseTexture.
+ */
+void Vita_FreeTexture(VitaTexture *texture);
+
+/**
+ * Vita_AcquireTexture():
+ *  Returns the cached texture for `path`, loading it asynchronously
+ *  (see Vita_LoadTextureAsync) the first time it's asked for.
+ *  Every call adds a reference; pair each with Vita_ReleaseTexture.
+ *
+ *  Images whose decoded pixels match a texture already in the cache
+ *  share that GL texture instead of being uploaded again.
+ */
+VitaTexture *Vita_AcquireTexture(const char *path);
+
+/**
+ * Vita_ReleaseTexture():
+ *  Drops a reference from Vita_AcquireTexture.
+ *  The texture is unloaded when the last reference goes.
+ */
+void Vita_ReleaseTexture(VitaTexture *texture);
+
+/**
+ * Vita_SetTextureMipmaps():
+ *  Builds a mip chain with `filter` (VGL_MIPMAP_*, see vgl_mipmap.h) on the
+ *  worker for textures queued from now on. Default VGL_MIPMAP_NONE.
+ *  KTX files bring their own chain (vgl_texconv --mips) and are left alone.
+ */
+void Vita_SetTextureMipmaps(int filter);
+
+/**
+ * Vita_SetTexturePixelFormat():
+ *  Stores RGBA8 images queued from now on as `format` (VGL_PIXEL_*, see
+ *  vgl_pixel_format.h), converted on the worker after any mips are built.
+ *  VGL_PIXEL_AUTO picks per image with Vita_ChoosePixelFormat.
+ *  `dither` converts with ordered dithering, for smooth gradients.
+ *  Default VGL_PIXEL_RGBA8888. Compressed KTX files are left alone.
+ *
+ *  Indexed formats (VGL_PIXEL_INDEX8 / _INDEX4) get a palette texture in
+ *  texture->paletteID and no mips, and always sample nearest. Draw them
+ *  with Vita_SetExDataPalette. Odd width images fall back from 4 to 8 bit.
+ *
+ *  Set it around the loads it's meant for to choose per texture.
+ */
+void Vita_SetTexturePixelFormat(int format, int dither);
+
+/**
+ * Vita_CreatePalette():
+ *  Uploads `count` (up to VGL_PALETTE_SIZE) RGBA8 `colors` as a palette
+ *  texture, to draw indexed textures with (see Vita_SetExDataPalette).
+ *  Premultiply the colors if VGL_SHADER_PREMULTIPLIED is on.
+ *  GL thread only.
+ *
+ *  returns the palette, 0 if `count` is out of range.
+ */
+unsigned int Vita_CreatePalette(const unsigned char *colors, int count);
+void Vita_DeletePalette(unsigned int palette);
+
+/**
+ * Vita_GetTexturePalette():
+ *  Copies a ready indexed texture's palette (VGL_PALETTE_SIZE RGBA8 entries)
+ *  to `colors`, e.g. to recolor it into a new one with Vita_CreatePalette.
+ *
+ *  returns the number of colors used, 0 if `texture` isn't indexed or ready.
+ */
+int Vita_GetTexturePalette(const VitaTexture *texture, unsigned char *colors);
+
+/**
+ * Vita_SetTextureFilter():
+ *  Picks how `texture` is sampled: VGL_TEXTURE_FILTER_NEAREST (default),
+ *  _BILINEAR or _TRILINEAR. Trilinear needs mips (texture->levels > 1),
+ *  without them it samples bilinear. Can be set while still loading.
+ *
+ *  Cached textures sharing pixels share one GL texture, so they
+ *  share this setting too.
+ */
+void Vita_SetTextureFilter(VitaTexture *texture, int filter);
+
+/**
+ * Vita_SetTextureUploadBudget():
+ *  Sets how many bytes of decoded images may be uploaded per frame.
+ *  Large images are uploaded in bands of rows over several frames.
+ */
+void Vita_SetTextureUploadBudget(size_t bytes_per_frame);
+
+/**
+ * Vita_PumpTextureUploads():
+ *  Uploads decoded images within the per frame budget, and evicts
+ *  textures past the residency budget (see Vita_SetTextureBudget).
+ *  Called from Vita_Repaint, so games don't normally need to call it.
+ *
+ *  returns the number of textures that became ready.
+ */
+int Vita_PumpTextureUploads();
+
+/**
+ * Vita_TextureUploadBytes():
+ *  returns the bytes of texture data the last Vita_PumpTextureUploads uploaded.
+ */
+size_t Vita_TextureUploadBytes();
+
+/**
+ * Vita_SetTextureBudget():
+ *  Caps the GPU memory of loaded textures at `bytes`
+ *  (or VGL_TEXTURE_BUDGET_UNLIMITED). Default VGL_DEFAULT_TEXTURE_BUDGET.
+ *
+ *  Past it, the textures drawn least recently are evicted: their storage
+ *  is released but the handle & textureID stay valid, drawing transparent.
+ *  The next draw with an evicted texture reloads it from its file (or the
+ *  asset pack) the way it was first loaded, through the workers.
+ *  Textures drawn this frame or the last are never evicted, so a frame
+ *  needing more than the budget goes over it rather than thrashing.
+ *  Palettes count towards the budget but stay resident.
+ */
+void Vita_SetTextureBudget(size_t bytes);
+
+/**
+ * Vita_TouchTexture():
+ *  Marks the loaded texture whose GL name is `textureID` as drawn this
+ *  frame, queueing a reload if it was evicted. Vita_Repaint calls this for
+ *  every texture it binds; call it for textures drawn by other means.
+ *  Unknown names (palettes, dynamic textures, ...) are ignored.
+ */
+void Vita_TouchTexture(unsigned int textureID);
+
+/**
+ * Vita_TextureResident():
+ *  returns 1 if `texture` is ready & its storage is on the GPU.
+ */
+int Vita_TextureResident(const VitaTexture *texture);
+
+/**
+ * Vita_GetTextureResidency():
+ *  Fills `residency` in with the loader's current texture memory use.
+ */
+void Vita_GetTextureResidency(VitaTextureResidency *residency);
+
+/**
+ * Vita_CompressedFormatSupported():
+ *  returns 1 if the GPU samples `format` (a VGL_COMPRESSED_* / VGL_ETC1_RGB8
+ *  format, see vgl_texture_compress.h), so KTX files in it are uploaded as is.
+ *  Other compressed KTX files are decoded to RGBA8 on the CPU.
+ *  Valid after Vita_InitTextureLoader.
+ */
+int Vita_CompressedFormatSupported(uint32_t format);
+
+/**
+ * Vita_TexturesPending():
+ *  returns the number of textures queued, decoding or uploading.
+ */
+int Vita_TexturesPending();
+
+#endif // __VGL_TEXTURE_LOADER_H__
+
+#ifdef __cplusplus
+}
+#endif
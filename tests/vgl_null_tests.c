@@ -0,0 +1,390 @@
+// Headless regression tests, on the null GL backend (see src/vgl_null_gl.h).
+//
+//  Build:  cmake --build . --target vgl_null_tests
+//  Run:    ctest (runs it from the source directory, for the test PNGs)
+//
+// Covers what the null backend makes checkable without a GPU:
+//  residency   the texture budget evicts & a touch reloads, and the
+//              loader's accounting matches the GPU memory the GL was given.
+//  commands    the recorded command stream binds & draws what was queued,
+//              batched and sorted as asked.
+//  dynamic     dynamic texture updates go through the unpack buffer ring,
+//              which moves on while the last update's fence is unsignaled.
+//
+// vgl_texconv's --verify round trip is registered next to it in CMakeLists.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vgl_renderer.h"
+#include "vgl_texture_loader.h"
+#include "vgl_ex_data.h"
+#include "vgl_dynamic_texture.h"
+
+#define TEST_TEXTURES 3
+
+// Frames to wait on the loader before giving up, a millisecond apart:
+// null backend frames take next to no time, decoding doesn't.
+#define LOAD_FRAMES 5000
+
+// What the loader leaves an evicted texture holding: one RGBA8 texel.
+#define EVICTED_BYTES 4
+
+static const char *_texturePaths[TEST_TEXTURES] =
+{
+    "bobomb_red.png",
+    "bobomb_black.png",
+    "block-4.png",
+};
+
+static VitaTexture *_textures[TEST_TEXTURES];
+static size_t _baseTextureBytes; // Held by the renderer itself, before any test texture.
+
+static int _failures = 0;
+
+#define CHECK(condition) \
+    do { if(!(condition)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); _failures++; } } while(0)
+
+static void _quiet(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+static void _frame()
+{
+    Vita_Clear();
+    Vita_Repaint();
+}
+
+static void _waitFrame()
+{
+    usleep(1000);
+    _frame();
+}
+
+static size_t _nullTextureBytes()
+{
+    VitaNullGLStats stats;
+    Vita_NullGLGetStats(&stats);
+    return stats.texture_bytes;
+}
+
+/**
+ * _checkAccounting():
+ *  The loader's residency has to add up to what the null GL holds:
+ *  resident textures in full, evicted ones down to their single texel.
+ */
+static void _checkAccounting(const VitaTextureResidency *residency)
+{
+    size_t expected = _baseTextureBytes + residency->resident_bytes + (size_t)residency->evicted * EVICTED_BYTES;
+    if(_nullTextureBytes() != expected)
+        fprintf(stderr, "  null GL holds %zu texture bytes, the loader accounts for %zu.\n", _nullTextureBytes(), expected);
+    CHECK(_nullTextureBytes() == expected);
+}
+
+// ------------------------------------------   RESIDENCY
+
+static void test_residency()
+{
+    VitaTextureResidency residency;
+
+    for(int i = 0; i < TEST_TEXTURES; i++)
+        _textures[i] = Vita_LoadTextureAsync(_texturePaths[i]);
+
+    for(int frame = 0; frame < LOAD_FRAMES && Vita_TexturesPending() > 0; frame++)
+        _waitFrame();
+
+    for(int i = 0; i < TEST_TEXTURES; i++)
+    {
+        CHECK(_textures[i] != NULL);
+        if(_textures[i] == NULL) return;
+        CHECK(_textures[i]->state == VGL_TEXTURE_READY);
+        CHECK(Vita_TextureResident(_textures[i]));
+    }
+
+    Vita_GetTextureResidency(&residency);
+    CHECK(residency.resident == TEST_TEXTURES);
+    CHECK(residency.evicted == 0);
+    _checkAccounting(&residency);
+
+    // Less than it all: the least recently used go once they're two frames old.
+    size_t budget = residency.resident_bytes * 3 / 4;
+    Vita_SetTextureBudget(budget);
+    for(int frame = 0; frame < 3; frame++)
+        _frame();
+
+    Vita_GetTextureResidency(&residency);
+    CHECK(residency.resident_bytes <= budget);
+    CHECK(residency.resident >= 1);
+    CHECK(residency.evicted >= 1);
+    CHECK(residency.evictions >= 1);
+    CHECK(residency.resident + residency.evicted == TEST_TEXTURES);
+    _checkAccounting(&residency);
+
+    VitaTexture *evicted = NULL;
+    for(int i = 0; i < TEST_TEXTURES && evicted == NULL; i++)
+    {
+        if(!Vita_TextureResident(_textures[i])) evicted = _textures[i];
+    }
+    CHECK(evicted != NULL);
+    if(evicted == NULL) return;
+
+    // Drawing it (or touching it, the same thing) brings it back, and keeps it.
+    unsigned int reloads = residency.reloads;
+    for(int frame = 0; frame < LOAD_FRAMES && !Vita_TextureResident(evicted); frame++)
+    {
+        Vita_TouchTexture(evicted->textureID);
+        _waitFrame();
+    }
+
+    Vita_GetTextureResidency(&residency);
+    CHECK(Vita_TextureResident(evicted));
+    CHECK(residency.reloads == reloads + 1);
+    CHECK(evicted->state == VGL_TEXTURE_READY);
+    _checkAccounting(&residency);
+
+    // Everything back for the command stream test.
+    Vita_SetTextureBudget(VGL_TEXTURE_BUDGET_UNLIMITED);
+    for(int frame = 0; frame < LOAD_FRAMES; frame++)
+    {
+        int resident = 0;
+        for(int i = 0; i < TEST_TEXTURES; i++)
+        {
+            Vita_TouchTexture(_textures[i]->textureID);
+            resident += Vita_TextureResident(_textures[i]);
+        }
+        if(resident == TEST_TEXTURES) break;
+        _waitFrame();
+    }
+
+    Vita_GetTextureResidency(&residency);
+    CHECK(residency.resident == TEST_TEXTURES);
+    _checkAccounting(&residency);
+}
+
+// ------------------------------------------   COMMAND STREAM
+
+#define STREAM_SPRITES 8
+
+/**
+ * _recordFrame():
+ *  Records a frame of STREAM_SPRITES sprites, alternating between the first
+ *  two test textures, with an untextured rect after each of the first `rects`,
+ *  & checks the draws in it add up to what was queued.
+ *  `binds` receives the test textures bound, in order (up to STREAM_SPRITES).
+ *
+ *  returns the glDrawElements calls made.
+ */
+static int _recordFrame(VitaExDataHandle *ex_data, int rects, unsigned int *binds, int *bind_count)
+{
+    Vita_NullGLClearCommands();
+    Vita_NullGLSetRecording(1);
+
+    Vita_Clear();
+    for(int i = 0; i < STREAM_SPRITES; i++)
+    {
+        VitaTexture *texture = _textures[i % 2];
+        Vita_GetExData(ex_data[i])->textureID = texture->textureID;
+        Vita_DrawTextureAnimColorExData(-.9f + i * .2f, .5f, .1f, -.1f,
+            texture->textureID, texture->width, texture->height, 0.f, 0.f, texture->width, texture->height,
+            1.f, 1.f, 1.f, 1.f, ex_data[i]);
+        if(i < rects)
+            Vita_DrawRectColor(-.9f + i * .2f, -.5f, .1f, -.1f, 1.f, 0.f, 0.f, 1.f);
+    }
+    Vita_Repaint();
+
+    Vita_NullGLSetRecording(0);
+
+    size_t count;
+    const VitaNullGLCommand *commands = Vita_NullGLCommands(&count);
+    int draws = 0;
+    uint64_t indices = 0;
+    *bind_count = 0;
+
+    for(size_t c = 0; c < count; c++)
+    {
+        if(commands[c].call == VGL_NULL_GL_DrawElements)
+        {
+            CHECK(commands[c].args[0] == GL_TRIANGLES);
+            draws++;
+            indices += commands[c].args[1];
+        }
+        else if(commands[c].call == VGL_NULL_GL_BindTexture && commands[c].args[0] == GL_TEXTURE_2D
+            && (commands[c].args[1] == _textures[0]->textureID || commands[c].args[1] == _textures[1]->textureID)
+            && *bind_count < STREAM_SPRITES)
+            binds[(*bind_count)++] = commands[c].args[1];
+    }
+
+    VitaFrameStats stats;
+    CHECK(Vita_GetFrameStats(&stats));
+    CHECK(stats.sprites_submitted == (uint32_t)(STREAM_SPRITES + rects));
+    CHECK((uint32_t)draws == stats.draw_calls);
+    CHECK(indices == (uint64_t)(STREAM_SPRITES + rects) * 6);
+
+    return draws;
+}
+
+static void test_command_stream()
+{
+    if(_textures[0] == NULL || _textures[1] == NULL) return;
+
+    VitaExDataHandle ex_data[STREAM_SPRITES];
+    for(int i = 0; i < STREAM_SPRITES; i++)
+        ex_data[i] = Vita_CreateExData();
+
+    unsigned int binds[STREAM_SPRITES];
+    int bind_count;
+
+    // Unsorted, the textures alternate: every sprite is its own draw.
+    Vita_SetSorting(0);
+    CHECK(_recordFrame(ex_data, 0, binds, &bind_count) == STREAM_SPRITES);
+    CHECK(bind_count == STREAM_SPRITES);
+    for(int i = 0; i < bind_count; i++)
+        CHECK(binds[i] == _textures[i % 2]->textureID);
+
+    // Sorted by texture: one draw each.
+    Vita_SetSorting(1);
+    CHECK(_recordFrame(ex_data, 0, binds, &bind_count) == 2);
+    CHECK(bind_count == 2);
+    CHECK(bind_count == 2 && binds[0] != binds[1]);
+
+    // Untextured rects in between sort as texture 0: one more draw, not one each.
+    CHECK(_recordFrame(ex_data, STREAM_SPRITES, binds, &bind_count) <= 3);
+    CHECK(bind_count == 2);
+
+    // Unbatched: a draw per sprite, even sorted.
+    Vita_SetBatching(0);
+    CHECK(_recordFrame(ex_data, 0, binds, &bind_count) == STREAM_SPRITES);
+
+    Vita_SetBatching(1);
+    Vita_SetSorting(0);
+    Vita_NullGLClearCommands();
+
+    for(int i = 0; i < STREAM_SPRITES; i++)
+        Vita_DestroyExData(ex_data[i]);
+}
+
+// ------------------------------------------   DYNAMIC TEXTURES
+
+#define DYNAMIC_SIZE 16
+
+/**
+ * _recordUpdate():
+ *  Records a Vita_UpdateDynamicTexture of the `width` x `height` rect at (x, y)
+ *  & checks it came down to a single glTexSubImage2D of it.
+ *
+ *  returns the unpack buffer bound for that glTexSubImage2D, 0 if none.
+ */
+static unsigned int _recordUpdate(VitaDynamicTexture *texture, int x, int y, int width, int height)
+{
+    static unsigned char pixels[DYNAMIC_SIZE * DYNAMIC_SIZE * 4];
+
+    Vita_NullGLClearCommands();
+    Vita_NullGLSetRecording(1);
+    CHECK(Vita_UpdateDynamicTexture(texture, x, y, width, height, pixels, DYNAMIC_SIZE * 4) == 0);
+    Vita_NullGLSetRecording(0);
+
+    size_t count;
+    const VitaNullGLCommand *commands = Vita_NullGLCommands(&count);
+    unsigned int unpack = 0, source = 0;
+    int uploads = 0;
+
+    for(size_t c = 0; c < count; c++)
+    {
+        if(commands[c].call == VGL_NULL_GL_BindBuffer && commands[c].args[0] == GL_PIXEL_UNPACK_BUFFER)
+            unpack = commands[c].args[1];
+        else if(commands[c].call == VGL_NULL_GL_TexSubImage2D)
+        {
+            CHECK(commands[c].args[0] == 0);
+            CHECK(commands[c].args[1] == (uint32_t)y);
+            CHECK(commands[c].args[2] == (uint32_t)width);
+            CHECK(commands[c].args[3] == (uint32_t)height);
+            CHECK(commands[c].bytes == (uint32_t)(width * height * 4));
+            source = unpack;
+            uploads++;
+        }
+    }
+
+    CHECK(uploads == 1);
+    CHECK(unpack == 0); // Unbound after, or it'd be read by the next upload.
+    return source;
+}
+
+static void test_dynamic_texture()
+{
+    VitaDynamicTexture *texture = Vita_CreateDynamicTexture(DYNAMIC_SIZE, DYNAMIC_SIZE);
+    CHECK(texture != NULL);
+    if(texture == NULL) return;
+
+    // The null backend claims every extension: updates go through the buffers.
+    CHECK(texture->buffers[0] != 0 && texture->buffers[1] != 0);
+    CHECK(texture->staging == NULL);
+
+    // With the GPU "still reading" the first buffer, the next update uses the other.
+    Vita_NullGLHoldFences(1);
+    CHECK(!Vita_DynamicTextureBusy(texture));
+    CHECK(_recordUpdate(texture, 0, 0, 8, 4) == texture->buffers[0]);
+    int busy = Vita_DynamicTextureBusy(texture);
+    CHECK(!busy);
+    if(busy) Vita_NullGLHoldFences(0); // Or the next update would spin on it.
+    CHECK(_recordUpdate(texture, 4, 8, 12, 8) == texture->buffers[1]);
+
+    // Back to the first, whose fence hasn't signaled: beginning one now would wait.
+    CHECK(Vita_DynamicTextureBusy(texture));
+    Vita_NullGLHoldFences(0);
+    CHECK(!Vita_DynamicTextureBusy(texture));
+    CHECK(_recordUpdate(texture, 0, 0, DYNAMIC_SIZE, DYNAMIC_SIZE) == texture->buffers[0]);
+
+    // Out of bounds rects are refused, without touching GL.
+    Vita_NullGLClearCommands();
+    Vita_NullGLSetRecording(1);
+    CHECK(Vita_BeginTextureUpdate(texture, 8, 8, 9, 4) == NULL);
+    CHECK(Vita_BeginTextureUpdate(texture, -1, 0, 4, 4) == NULL);
+    CHECK(Vita_BeginTextureUpdate(texture, 0, 0, 0, 4) == NULL);
+    Vita_NullGLSetRecording(0);
+
+    size_t count;
+    Vita_NullGLCommands(&count);
+    CHECK(count == 0);
+    CHECK(!texture->updating);
+
+    Vita_DestroyDynamicTexture(texture);
+}
+
+// ------------------------------------------   END TESTS
+
+int main()
+{
+    if(initGL(_quiet) != 0 || initGLShading() != 0)
+    {
+        fprintf(stderr, "Could not start the renderer.\n");
+        return 1;
+    }
+    initGLAdv();
+    Vita_InitTextureLoader(1, _quiet);
+    Vita_SetCulling(1);
+
+    _frame();
+    _baseTextureBytes = _nullTextureBytes();
+
+    test_residency();
+    test_command_stream();
+    test_dynamic_texture();
+
+    for(int i = 0; i < TEST_TEXTURES; i++)
+        Vita_FreeTexture(_textures[i]);
+    Vita_ShutdownTextureLoader();
+    deInitGL();
+
+    if(_failures > 0)
+    {
+        fprintf(stderr, "%d check(s) failed.\n", _failures);
+        return 1;
+    }
+
+    printf("All null backend tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Packs loose asset files into the .vpak the renderer mounts (see src/vgl_pack.h).
+//
+//  Build:  cmake --build . --target vgl_pack
+//  Usage:  vgl_pack -o <output.vpak> [--root <dir>] <file | name=file>...
+//
+//  Every file is stored under its name in the pack: `name` when given
+//  as name=file, otherwise the file's path with `--root` stripped off.
+//  Names always use '/'.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vgl_pack.h"
+
+typedef struct _pack_input
+{
+    char *name;
+    const char *path;
+    uint64_t hash;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t name_offset;
+} PackInput;
+
+static void usage()
+{
+    fprintf(stderr, "usage: vgl_pack -o <output.vpak> [--root <dir>] <file | name=file>...\n");
+}
+
+static int compare_inputs(const void *a, const void *b)
+{
+    const PackInput *ia = (const PackInput *)a, *ib = (const PackInput *)b;
+    if(ia->hash != ib->hash) return ia->hash < ib->hash ? -1 : 1;
+    return strcmp(ia->name, ib->name);
+}
+
+/**
+ * make_name():
+ *  The pack name for the first `length` chars of `path`: `root` and any
+ *  leading "./" stripped, backslashes turned into '/'.
+ */
+static char *make_name(const char *path, size_t length, const char *root)
+{
+    const char *end = path + length;
+    size_t root_length = root != NULL ? strlen(root) : 0;
+    if(root_length > 0 && strncmp(path, root, root_length) == 0)
+    {
+        path += root_length;
+        while(*path == '/' || *path == '\\') path++;
+    }
+    while(path[0] == '.' && (path[1] == '/' || path[1] == '\\')) path += 2;
+
+    char *name = (char *)malloc((end - path) + 1);
+    memcpy(name, path, end - path);
+    name[end - path] = '\0';
+
+    for(char *c = name; *c != '\0'; c++)
+        if(*c == '\\') *c = '/';
+    return name;
+}
+
+static int write_padding(FILE *out, long *position, uint32_t alignment)
+{
+    static const unsigned char zeros[VGL_PACK_ALIGNMENT] = { 0 };
+    long pad = (alignment - (*position % alignment)) % alignment;
+    if(pad > 0 && fwrite(zeros, pad, 1, out) != 1) return -1;
+
+    *position += pad;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *out_path = NULL, *root = NULL;
+    PackInput *inputs = (PackInput *)calloc(argc, sizeof(PackInput));
+    uint32_t count = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if(strcmp(argv[i], "--root") == 0 && i + 1 < argc) root = argv[++i];
+        else
+        {
+            const char *equals = strchr(argv[i], '=');
+            if(equals != NULL)
+            {
+                inputs[count].name = make_name(argv[i], equals - argv[i], NULL);
+                inputs[count].path = equals + 1;
+            }
+            else
+            {
+                inputs[count].name = make_name(argv[i], strlen(argv[i]), root);
+                inputs[count].path = argv[i];
+            }
+
+            inputs[count].hash = Vita_PackHashPath(inputs[count].name);
+            count++;
+        }
+    }
+
+    if(out_path == NULL || count == 0)
+    {
+        usage();
+        return 1;
+    }
+
+    qsort(inputs, count, sizeof(PackInput), compare_inputs);
+
+    for(uint32_t i = 1; i < count; i++)
+    {
+        if(strcmp(inputs[i - 1].name, inputs[i].name) == 0)
+        {
+            fprintf(stderr, "`%s` is in the pack twice (%s and %s).\n", inputs[i].name, inputs[i - 1].path, inputs[i].path);
+            return 1;
+        }
+    }
+
+    FILE *out = fopen(out_path, "wb");
+    if(out == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", out_path);
+        return 1;
+    }
+
+    // Header goes in last, once the offsets are known.
+    VitaPackHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, sizeof(header), 1, out);
+    long position = sizeof(header);
+    int ok = 1;
+
+    for(uint32_t i = 0; i < count && ok; i++)
+    {
+        FILE *file = fopen(inputs[i].path, "rb");
+        if(file == NULL)
+        {
+            fprintf(stderr, "Could not open %s\n", inputs[i].path);
+            ok = 0;
+            break;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        unsigned char *data = (unsigned char *)malloc(size + 1);
+        if(size > 0 && fread(data, size, 1, file) != 1) ok = 0;
+        data[size] = '\0';
+        fclose(file);
+
+        ok = ok && write_padding(out, &position, VGL_PACK_ALIGNMENT) == 0;
+        inputs[i].offset = (uint32_t)position;
+        inputs[i].size = (uint32_t)size;
+
+        // Plus the zero that lets text be read in place.
+        ok = ok && fwrite(data, size + 1, 1, out) == 1;
+        position += size + 1;
+        free(data);
+    }
+
+    uint32_t names_size = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        inputs[i].name_offset = names_size;
+        names_size += strlen(inputs[i].name) + 1;
+    }
+
+    ok = ok && write_padding(out, &position, sizeof(uint64_t)) == 0;
+    header.index_offset = (uint32_t)position;
+
+    for(uint32_t i = 0; i < count && ok; i++)
+    {
+        VitaPackEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.path_hash = inputs[i].hash;
+        entry.offset = inputs[i].offset;
+        entry.size = inputs[i].size;
+        entry.name_offset = inputs[i].name_offset;
+
+        ok = fwrite(&entry, sizeof(entry), 1, out) == 1;
+        position += sizeof(entry);
+    }
+
+    header.names_offset = (uint32_t)position;
+    header.names_size = names_size;
+    for(uint32_t i = 0; i < count && ok; i++)
+        ok = fwrite(inputs[i].name, strlen(inputs[i].name) + 1, 1, out) == 1;
+
+    header.magic = VGL_PACK_MAGIC;
+    header.version = VGL_PACK_VERSION;
+    header.entry_count = count;
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+    fclose(out);
+
+    if(!ok)
+    {
+        fprintf(stderr, "Could not write %s\n", out_path);
+        remove(out_path);
+        return 1;
+    }
+
+    printf("%s: %u files, %ld bytes\n", out_path, count, position + names_size);
+
+    for(uint32_t i = 0; i < count; i++)
+        free(inputs[i].name);
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,323 @@
+// Converts images into the KTX textures the texture loader reads.
+//
+//  Build:  cmake --build . --target vgl_texconv
+//  Usage:  vgl_texconv [options] <input image> <output.ktx>
+//
+//  Options:
+//    -f, --format <fmt>  rgba (default), dxt1, dxt1a, dxt5 or etc1.
+//    --mips              Also write the full mip chain, down to 1x1.
+//    --premultiply       Premultiply colors by alpha and flag the file,
+//                        for renderers using VGL_SHADER_PREMULTIPLIED.
+//    --verify            Read the written file back, decode it on the CPU and
+//                        compare it to the source. Fails if the PSNR is below
+//                        --min-psnr.
+//    --min-psnr <dB>     Threshold for --verify. Default 30.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stb_image.h"
+#include "vgl_ktx.h"
+#include "vgl_texture_compress.h"
+
+typedef struct _texconv_format
+{
+    const char *name;
+    uint32_t internal_format;
+    int has_alpha; // Whether alpha survives the round trip, for --verify.
+} TexconvFormat;
+
+static const TexconvFormat _formats[] =
+{
+    { "rgba", VGL_KTX_RGBA8, 1 },
+    { "dxt1", VGL_COMPRESSED_RGB_S3TC_DXT1, 0 },
+    { "dxt1a", VGL_COMPRESSED_RGBA_S3TC_DXT1, 1 },
+    { "dxt5", VGL_COMPRESSED_RGBA_S3TC_DXT5, 1 },
+    { "etc1", VGL_ETC1_RGB8, 0 },
+};
+
+#define FORMAT_COUNT (sizeof(_formats) / sizeof(_formats[0]))
+
+static void usage()
+{
+    fprintf(stderr, "usage: vgl_texconv [-f rgba|dxt1|dxt1a|dxt5|etc1] [--mips] [--premultiply] [--verify] [--min-psnr dB] <input> <output.ktx>\n");
+}
+
+static unsigned char *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = (unsigned char *)malloc(*size);
+    if(data != NULL && fread(data, *size, 1, file) != 1)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(file);
+    return data;
+}
+
+static void premultiply(unsigned char *pixels, int width, int height)
+{
+    size_t count = (size_t)width * height;
+    for(size_t i = 0; i < count; i++)
+    {
+        unsigned char *p = pixels + (i * 4);
+        for(int c = 0; c < 3; c++)
+            p[c] = (unsigned char)((p[c] * p[3] + 127) / 255);
+    }
+}
+
+/**
+ * downsample():
+ *  Box filters `src` to half its size (at least 1x1) into a new buffer.
+ *  Odd edges repeat their last row/column.
+ */
+static unsigned char *downsample(const unsigned char *src, int width, int height, int *out_width, int *out_height)
+{
+    int w = width > 1 ? width / 2 : 1;
+    int h = height > 1 ? height / 2 : 1;
+    unsigned char *dst = (unsigned char *)malloc((size_t)w * h * 4);
+
+    for(int y = 0; y < h; y++)
+    {
+        int y0 = y * 2 < height ? y * 2 : height - 1;
+        int y1 = y0 + 1 < height ? y0 + 1 : y0;
+
+        for(int x = 0; x < w; x++)
+        {
+            int x0 = x * 2 < width ? x * 2 : width - 1;
+            int x1 = x0 + 1 < width ? x0 + 1 : x0;
+
+            for(int c = 0; c < 4; c++)
+            {
+                int sum = src[(((size_t)y0 * width) + x0) * 4 + c] + src[(((size_t)y0 * width) + x1) * 4 + c]
+                        + src[(((size_t)y1 * width) + x0) * 4 + c] + src[(((size_t)y1 * width) + x1) * 4 + c];
+                dst[(((size_t)y * w) + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+
+    *out_width = w;
+    *out_height = h;
+    return dst;
+}
+
+/**
+ * psnr():
+ *  Peak signal to noise ratio between two RGBA8 images, in dB.
+ *  Only the first `channels` channels are compared. Identical images give INFINITY.
+ *
+ *  With `weigh_alpha`, colors are compared premultiplied by their alpha:
+ *  the color of a fully transparent pixel doesn't matter, and formats
+ *  like DXT1 throw it away.
+ */
+static double psnr(const unsigned char *a, const unsigned char *b, int width, int height, int channels, int weigh_alpha)
+{
+    double error = 0;
+    size_t pixels = (size_t)width * height;
+
+    for(size_t i = 0; i < pixels; i++)
+    {
+        for(int c = 0; c < channels; c++)
+        {
+            double va = a[(i * 4) + c], vb = b[(i * 4) + c];
+            if(weigh_alpha && c < 3)
+            {
+                va *= a[(i * 4) + 3] / 255.0;
+                vb *= b[(i * 4) + 3] / 255.0;
+            }
+
+            double d = va - vb;
+            error += d * d;
+        }
+    }
+
+    if(error == 0) return INFINITY;
+
+    double mse = error / ((double)pixels * channels);
+    return 10.0 * log10((255.0 * 255.0) / mse);
+}
+
+/**
+ * verify():
+ *  Parses `path` back, decodes its base level and compares it against `source`.
+ *  returns 0 if it matches within `min_psnr`.
+ */
+static int verify(const char *path, const unsigned char *source, int width, int height, const TexconvFormat *format, int expect_premultiplied, double min_psnr)
+{
+    size_t size = 0;
+    unsigned char *data = read_file(path, &size);
+    KTXImage image;
+
+    if(data == NULL || Vita_ParseKTX(data, size, &image) != 0)
+    {
+        fprintf(stderr, "verify: %s is not a valid KTX file.\n", path);
+        free(data);
+        return -1;
+    }
+
+    if(image.width != width || image.height != height || image.internal_format != format->internal_format
+        || image.premultiplied != expect_premultiplied)
+    {
+        fprintf(stderr, "verify: %s header doesn't match what was written.\n", path);
+        free(data);
+        return -1;
+    }
+
+    unsigned char *decoded = (unsigned char *)malloc((size_t)width * height * 4);
+    if(format->internal_format == VGL_KTX_RGBA8)
+        memcpy(decoded, image.level_data[0], (size_t)width * height * 4);
+    else
+        Vita_DecodeCompressed(format->internal_format, image.level_data[0], width, height, decoded);
+
+    double rgb = psnr(source, decoded, width, height, 3, 0);
+    double rgba = rgb;
+
+    // Alpha formats are judged on what ends up on screen: premultiplied color & alpha.
+    if(format->has_alpha)
+    {
+        rgb = psnr(source, decoded, width, height, 3, 1);
+        rgba = psnr(source, decoded, width, height, 4, 1);
+    }
+
+    free(decoded);
+    free(data);
+
+    printf("  PSNR rgb %.2f dB, rgba %.2f dB (min %.2f)\n", rgb, rgba, min_psnr);
+
+    if(rgb < min_psnr || rgba < min_psnr)
+    {
+        fprintf(stderr, "verify: %s is below the PSNR threshold.\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const TexconvFormat *format = &_formats[0];
+    const char *in_path = NULL, *out_path = NULL;
+    int do_verify = 0, do_mips = 0, do_premultiply = 0;
+    double min_psnr = 30.0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--format") == 0) && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            format = NULL;
+            for(size_t f = 0; f < FORMAT_COUNT; f++)
+            {
+                if(strcmp(_formats[f].name, name) == 0) format = &_formats[f];
+            }
+
+            if(format == NULL)
+            {
+                fprintf(stderr, "Unknown format `%s`.\n", name);
+                usage();
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--verify") == 0) do_verify = 1;
+        else if(strcmp(argv[i], "--mips") == 0) do_mips = 1;
+        else if(strcmp(argv[i], "--premultiply") == 0) do_premultiply = 1;
+        else if(strcmp(argv[i], "--min-psnr") == 0 && i + 1 < argc) min_psnr = atof(argv[++i]);
+        else if(in_path == NULL) in_path = argv[i];
+        else if(out_path == NULL) out_path = argv[i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if(in_path == NULL || out_path == NULL)
+    {
+        usage();
+        return 1;
+    }
+
+    int width, height, channels;
+    unsigned char *pixels = stbi_load(in_path, &width, &height, &channels, STBI_rgb_alpha);
+    if(pixels == NULL)
+    {
+        fprintf(stderr, "Could not load %s: %s\n", in_path, stbi_failure_reason());
+        return 1;
+    }
+
+    if(do_premultiply) premultiply(pixels, width, height);
+
+    KTXImage image;
+    memset(&image, 0, sizeof(image));
+    image.internal_format = format->internal_format;
+    image.width = width;
+    image.height = height;
+    image.premultiplied = do_premultiply;
+
+    // Every level is kept in its own buffer: level 0 is `pixels` (or its encoding).
+    unsigned char *level_pixels = pixels;
+    unsigned char *level_buffers[VGL_KTX_MAX_LEVELS * 2];
+    int buffer_count = 0;
+    int level_width = width, level_height = height;
+
+    for(;;)
+    {
+        int level = image.levels++;
+
+        if(format->internal_format == VGL_KTX_RGBA8)
+        {
+            image.level_data[level] = level_pixels;
+            image.level_size[level] = (uint32_t)((size_t)level_width * level_height * 4);
+        }
+        else
+        {
+            size_t size = Vita_CompressedSize(format->internal_format, level_width, level_height);
+            unsigned char *encoded = (unsigned char *)malloc(size);
+            Vita_EncodeCompressed(format->internal_format, level_pixels, level_width, level_height, encoded);
+            level_buffers[buffer_count++] = encoded;
+
+            image.level_data[level] = encoded;
+            image.level_size[level] = (uint32_t)size;
+        }
+
+        if(!do_mips || (level_width == 1 && level_height == 1) || image.levels == VGL_KTX_MAX_LEVELS)
+            break;
+
+        level_pixels = downsample(level_pixels, level_width, level_height, &level_width, &level_height);
+        level_buffers[buffer_count++] = level_pixels;
+    }
+
+    FILE *out = fopen(out_path, "wb");
+    int ok = out != NULL && Vita_WriteKTX(out, &image) == 0;
+    if(out != NULL) fclose(out);
+
+    int result = 0;
+    if(!ok)
+    {
+        fprintf(stderr, "Could not write %s\n", out_path);
+        result = 1;
+    }
+    else
+    {
+        printf("%s -> %s (%s%s, %dx%d, %d levels, %u bytes in level 0)\n", in_path, out_path, format->name,
+            do_premultiply ? " premultiplied" : "", width, height, image.levels, image.level_size[0]);
+
+        if(do_verify && verify(out_path, pixels, width, height, format, do_premultiply, min_psnr) != 0)
+            result = 2;
+    }
+
+    for(int i = 0; i < buffer_count; i++)
+        free(level_buffers[i]);
+    stbi_image_free(pixels);
+    return result;
+}
@@ -7,10 +7,12 @@ varying vec2 texCoord;
 uniform mat4 mvp;
 uniform mat4 _rot;
 uniform mat4 _scale;
+uniform vec2 _offset;
 
 void main()
 {
     gl_Position = mvp * _rot * _scale * vec4(vPosition.xyz, 1);
+    gl_Position.xy += _offset;
     fragColor = vColor;
     texCoord = vTexCoord;
 }
\ No newline at end of file